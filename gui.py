@@ -13,12 +13,15 @@ from pathlib import Path
 import psutil
 import os
 import sys
+import argparse
 
 # Import our vehicle detector
-from vehicle_detector import VehicleDetector
+from vehicle_detector import create_detector
 
 class VehicleGUI:
-    def __init__(self):
+    def __init__(self, backend: str = "ultralytics"):
+        self.backend = backend
+
         # Create root window
         self.root = tk.Tk()
         self.root.title("Vehicle Detection System")
@@ -31,8 +34,8 @@ class VehicleGUI:
         
         # Performance settings
         self.performance_settings = {
-            'threads': tk.IntVar(value=1),
-            'downsample': tk.BooleanVar(value=True),
+            'threads': tk.IntVar(value=1 if backend == "ultralytics" else os.cpu_count() or 1),
+            'downsample': tk.BooleanVar(value=backend == "ultralytics"),
             'downsample_factor': tk.DoubleVar(value=0.5),
             'gpu_acceleration': tk.BooleanVar(value=False)
         }
@@ -63,8 +66,10 @@ class VehicleGUI:
         self.fps = 30
         self.processing_times = []
         
-        # Set OpenCV threading to single thread for stability
-        cv2.setNumThreads(1)
+        # The ultralytics path runs OpenCV on one thread for stability; the
+        # native backend releases the GIL and manages its own threads
+        if self.backend == "ultralytics":
+            cv2.setNumThreads(1)
         
         self.setup_ui()
         self.initialize_detector()
@@ -167,10 +172,11 @@ class VehicleGUI:
         thread_frame = ttk.Frame(perf_frame)
         thread_frame.pack(fill=tk.X, pady=2)
         ttk.Label(thread_frame, text="Threads:").pack(side=tk.LEFT)
-        self.thread_label = ttk.Label(thread_frame, text="1")
+        self.thread_label = ttk.Label(thread_frame, text=str(self.performance_settings['threads'].get()))
         self.thread_label.pack(side=tk.RIGHT)
         
-        thread_scale = ttk.Scale(perf_frame, from_=1, to=2,
+        max_threads = 2 if self.backend == "ultralytics" else (os.cpu_count() or 2)
+        thread_scale = ttk.Scale(perf_frame, from_=1, to=max_threads,
                                 variable=self.performance_settings['threads'],
                                 orient=tk.HORIZONTAL, length=200)
         thread_scale.pack(fill=tk.X, pady=2)
@@ -232,11 +238,13 @@ class VehicleGUI:
     def initialize_detector(self):
         """Initialize the vehicle detector with current settings"""
         try:
-            self.detector = VehicleDetector(
+            self.detector = create_detector(
+                self.backend,
                 model_size=self.detection_settings['model'].get(),
-                conf_threshold=self.detection_settings['confidence'].get()
+                conf_threshold=self.detection_settings['confidence'].get(),
+                threads=self.performance_settings['threads'].get()
             )
-            self.log_status("Detector initialized successfully")
+            self.log_status(f"Detector initialized successfully ({self.backend} backend)")
         except Exception as e:
             self.log_status(f"Error initializing detector: {e}")
     
@@ -429,7 +437,10 @@ class VehicleGUI:
         conf = self.detection_settings['confidence'].get()
         self.conf_label.config(text=f"{conf:.2f}")
         if self.detector:
-            self.detector.conf_threshold = conf
+            if hasattr(self.detector, 'set_conf_threshold'):
+                self.detector.set_conf_threshold(conf)
+            else:
+                self.detector.conf_threshold = conf
     
     def on_iou_change(self, event):
         """Handle IOU threshold change"""
@@ -440,6 +451,10 @@ class VehicleGUI:
         """Handle thread count change"""
         threads = self.performance_settings['threads'].get()
         self.thread_label.config(text=str(threads))
+        # Only the native tracker has a thread pool to resize; the Ultralytics
+        # detector's tracker is a plain sv.ByteTrack
+        if self.detector and self.backend == "cpp":
+            self.detector.tracker.set_thread_count(threads)
     
     def on_ds_change(self, event):
         """Handle downsampling factor change"""
@@ -462,7 +477,13 @@ class VehicleGUI:
             sys.exit(1)
 
 def main():
-    app = VehicleGUI()
+    parser = argparse.ArgumentParser(description="Vehicle Detection GUI")
+    parser.add_argument("--backend", type=str, default="ultralytics",
+                        choices=["ultralytics", "cpp"],
+                        help="Inference backend (cpp = native fsd_core module)")
+    args = parser.parse_args()
+
+    app = VehicleGUI(backend=args.backend)
     app.run()
 
 if __name__ == "__main__":
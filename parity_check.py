@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+Parity check between the native C++ detector and the Python Ultralytics reference
+
+Runs VehicleDetector.detect (the validated Python path) and the fsd_core
+DetectionTracker on the same frames, matches their boxes and reports per-frame
+box, class and score differences plus overall agreement. Exits non-zero when
+agreement drops below --min-agreement, so it can guard C++ changes.
+
+The two pipelines are expected to differ somewhat: Ultralytics letterboxes
+(and VehicleDetector first downsamples to 480p), the C++ path stretches the
+frame to the network input. The report quantifies that baseline so changes
+on top of it show up.
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+from vehicle_detector import TRACKED_CLASSES, VehicleDetector, fsd_core
+
+
+def box_iou(a: np.ndarray, b: np.ndarray) -> np.ndarray:
+    """IoU matrix between xyxy boxes a (N, 4) and b (M, 4)"""
+    if len(a) == 0 or len(b) == 0:
+        return np.zeros((len(a), len(b)), dtype=np.float32)
+    x1 = np.maximum(a[:, None, 0], b[None, :, 0])
+    y1 = np.maximum(a[:, None, 1], b[None, :, 1])
+    x2 = np.minimum(a[:, None, 2], b[None, :, 2])
+    y2 = np.minimum(a[:, None, 3], b[None, :, 3])
+    intersection = np.clip(x2 - x1, 0, None) * np.clip(y2 - y1, 0, None)
+    area_a = (a[:, 2] - a[:, 0]) * (a[:, 3] - a[:, 1])
+    area_b = (b[:, 2] - b[:, 0]) * (b[:, 3] - b[:, 1])
+    union = area_a[:, None] + area_b[None, :] - intersection
+    return np.where(union > 0, intersection / np.maximum(union, 1e-9), 0.0)
+
+
+def match_boxes(iou: np.ndarray, min_iou: float):
+    """Greedy class-agnostic matching, best overlap first; returns (ref, cpp) index pairs"""
+    pairs = []
+    if iou.size == 0:
+        return pairs
+    order = np.dstack(np.unravel_index(np.argsort(-iou, axis=None), iou.shape))[0]
+    used_ref, used_cpp = set(), set()
+    for r, c in order:
+        if iou[r, c] < min_iou:
+            break
+        if r in used_ref or c in used_cpp:
+            continue
+        used_ref.add(r)
+        used_cpp.add(c)
+        pairs.append((int(r), int(c)))
+    return pairs
+
+
+def read_frames(source: str, max_frames: int, stride: int):
+    """Frames from a video, an image pattern (img1/%06d.jpg) or a directory of images"""
+    path = Path(source)
+    if path.is_dir():
+        images = sorted(p for p in path.iterdir() if p.suffix.lower() in (".jpg", ".jpeg", ".png", ".bmp"))
+        for index, image in enumerate(images[::stride][:max_frames]):
+            frame = cv2.imread(str(image))
+            if frame is not None:
+                yield index * stride, frame
+        return
+
+    cap = cv2.VideoCapture(int(source) if source.isdigit() else source)
+    index = 0
+    produced = 0
+    while produced < max_frames:
+        ret, frame = cap.read()
+        if not ret:
+            break
+        if index % stride == 0:
+            yield index, frame
+            produced += 1
+        index += 1
+    cap.release()
+
+
+def compare_frame(ref, cpp: np.ndarray, min_iou: float, score_tolerance: float) -> dict:
+    """Match one frame's reference detections (sv.Detections) with C++ rows (fsd_core.track_dtype)"""
+    ref_xyxy = ref.xyxy.astype(np.float32) if len(ref) else np.zeros((0, 4), np.float32)
+    cpp_xyxy = np.stack([cpp["x"], cpp["y"], cpp["x"] + cpp["w"], cpp["y"] + cpp["h"]], axis=1) \
+        if len(cpp) else np.zeros((0, 4), np.float32)
+    pairs = match_boxes(box_iou(ref_xyxy, cpp_xyxy), min_iou)
+
+    ious, score_diffs, class_mismatches = [], [], []
+    for r, c in pairs:
+        ious.append(float(box_iou(ref_xyxy[r:r + 1], cpp_xyxy[c:c + 1])[0, 0]))
+        score_diffs.append(float(cpp["confidence"][c]) - float(ref.confidence[r]))
+        if int(ref.class_id[r]) != int(cpp["class_id"][c]):
+            class_mismatches.append((int(ref.class_id[r]), int(cpp["class_id"][c])))
+
+    agreed = len(pairs) - len(class_mismatches)
+    return {
+        "reference": len(ref_xyxy),
+        "cpp": len(cpp_xyxy),
+        "matched": len(pairs),
+        "agreed": agreed,
+        "missing": len(ref_xyxy) - len(pairs),   # reference boxes the C++ path did not find
+        "extra": len(cpp_xyxy) - len(pairs),     # C++ boxes with no reference counterpart
+        "class_mismatches": class_mismatches,
+        "mean_iou": float(np.mean(ious)) if ious else None,
+        "max_score_diff": float(np.max(np.abs(score_diffs))) if score_diffs else None,
+        "score_outliers": int(np.sum(np.abs(score_diffs) > score_tolerance)) if score_diffs else 0,
+        "ious": ious,
+        "score_diffs": score_diffs,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the C++ detector with the Python Ultralytics reference")
+    parser.add_argument("--source", type=str, required=True,
+                        help="Video file, camera index, image pattern or image directory")
+    parser.add_argument("--model", type=str, default="n", choices=["n", "s", "m", "l", "x"],
+                        help="YOLOv8 size; the reference loads yolov8<size>.pt")
+    parser.add_argument("--onnx", type=str, default=None,
+                        help="ONNX export of the same weights (default models/yolov8<size>.onnx)")
+    parser.add_argument("--classes", type=str, default="models/coco.names", help="Class names for the C++ path")
+    parser.add_argument("--conf", type=float, default=0.25, help="Confidence threshold for both paths")
+    parser.add_argument("--nms", type=float, default=0.7, help="NMS IoU threshold for both paths")
+    parser.add_argument("--frames", type=int, default=100, help="Number of frames to compare")
+    parser.add_argument("--stride", type=int, default=1, help="Compare every Nth frame")
+    parser.add_argument("--match-iou", type=float, default=0.5, help="IoU for two boxes to count as the same object")
+    parser.add_argument("--score-tolerance", type=float, default=0.05,
+                        help="Score difference reported as an outlier")
+    parser.add_argument("--min-agreement", type=float, default=0.0,
+                        help="Exit with status 1 when overall agreement is below this (0-1)")
+    parser.add_argument("--json", type=str, default=None, help="Write the per-frame report to this file")
+    parser.add_argument("--verbose", action="store_true", help="Print every frame, not only disagreeing ones")
+    args = parser.parse_args()
+
+    if fsd_core is None:
+        print("❌ fsd_core is not built; configure qt_gui with -DBUILD_PYTHON_MODULE=ON")
+        sys.exit(2)
+
+    reference = VehicleDetector(model_size=args.model, conf_threshold=args.conf)
+    onnx_path = args.onnx or f"models/yolov8{args.model}.onnx"
+    native = fsd_core.DetectionTracker(onnx_path, args.classes, args.conf, args.nms)
+    native.set_class_filter(list(TRACKED_CLASSES))
+    class_names = list(native.class_names)
+
+    def name(class_id: int) -> str:
+        return class_names[class_id] if 0 <= class_id < len(class_names) else f"class_{class_id}"
+
+    print(f"Reference: yolov8{args.model}.pt via Ultralytics (480p downsample, letterbox)")
+    print(f"Native:    {onnx_path} via fsd_core (stretch to network input)")
+    print(f"conf {args.conf}, NMS IoU {args.nms}, match IoU {args.match_iou}\n")
+
+    frames = []
+    for index, frame in read_frames(args.source, args.frames, max(1, args.stride)):
+        ref = reference.detect(frame, conf=args.conf, iou=args.nms)
+        cpp = native.detect(np.ascontiguousarray(frame))
+        result = compare_frame(ref, cpp, args.match_iou, args.score_tolerance)
+        result["frame"] = index
+        frames.append(result)
+
+        disagrees = result["missing"] or result["extra"] or result["class_mismatches"] or result["score_outliers"]
+        if args.verbose or disagrees:
+            mismatches = ", ".join(f"{name(r)}->{name(c)}" for r, c in result["class_mismatches"])
+            mean_iou = f"{result['mean_iou']:.3f}" if result["mean_iou"] is not None else "-"
+            max_diff = f"{result['max_score_diff']:.3f}" if result["max_score_diff"] is not None else "-"
+            print(f"frame {index:6d}: ref {result['reference']:3d}  cpp {result['cpp']:3d}  "
+                  f"matched {result['matched']:3d}  missing {result['missing']:2d}  extra {result['extra']:2d}  "
+                  f"IoU {mean_iou}  max |Δscore| {max_diff}"
+                  + (f"  classes: {mismatches}" if mismatches else ""))
+
+    if not frames:
+        print(f"❌ No frames read from {args.source}")
+        sys.exit(2)
+
+    total_ref = sum(f["reference"] for f in frames)
+    total_cpp = sum(f["cpp"] for f in frames)
+    total_matched = sum(f["matched"] for f in frames)
+    total_agreed = sum(f["agreed"] for f in frames)
+    ious = [v for f in frames for v in f["ious"]]
+    score_diffs = [v for f in frames for v in f["score_diffs"]]
+
+    # Same object and same class on both sides, relative to all boxes produced
+    agreement = 2.0 * total_agreed / (total_ref + total_cpp) if total_ref + total_cpp > 0 else 1.0
+    identical_frames = sum(1 for f in frames if not (f["missing"] or f["extra"] or f["class_mismatches"]))
+
+    summary = {
+        "frames": len(frames),
+        "identical_frames": identical_frames,
+        "reference_boxes": total_ref,
+        "cpp_boxes": total_cpp,
+        "matched": total_matched,
+        "class_agreement": total_agreed / total_matched if total_matched else 1.0,
+        "agreement": agreement,
+        "recall_vs_reference": total_matched / total_ref if total_ref else 1.0,
+        "precision_vs_reference": total_matched / total_cpp if total_cpp else 1.0,
+        "mean_iou": float(np.mean(ious)) if ious else None,
+        "mean_score_diff": float(np.mean(score_diffs)) if score_diffs else None,
+        "mean_abs_score_diff": float(np.mean(np.abs(score_diffs))) if score_diffs else None,
+    }
+
+    print(f"\n📊 Parity Summary ({len(frames)} frames):")
+    print(f"   Boxes: reference {total_ref}, C++ {total_cpp}, matched {total_matched}")
+    print(f"   Frames with identical box sets: {identical_frames}/{len(frames)}")
+    print(f"   Recall vs reference: {summary['recall_vs_reference']:.3f}")
+    print(f"   Precision vs reference: {summary['precision_vs_reference']:.3f}")
+    print(f"   Class agreement on matches: {summary['class_agreement']:.3f}")
+    if ious:
+        print(f"   Box IoU on matches: mean {summary['mean_iou']:.3f}, min {min(ious):.3f}")
+        print(f"   Score difference (C++ - ref): mean {summary['mean_score_diff']:+.3f}, "
+              f"mean |Δ| {summary['mean_abs_score_diff']:.3f}")
+    print(f"   Overall agreement: {agreement:.3f}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"summary": summary,
+                       "frames": [{k: v for k, v in f.items() if k not in ("ious", "score_diffs")} for f in frames]},
+                      f, indent=2)
+        print(f"💾 Report written to {args.json}")
+
+    if agreement < args.min_agreement:
+        print(f"❌ Agreement {agreement:.3f} is below {args.min_agreement:.3f}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,377 @@
+#include "arrow_exporter.h"
+#include "MetricsRegistry.hpp"
+#include "ResourceSampler.hpp"
+#include "TraceRecorder.hpp"
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef HAVE_ARROW
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
+#include <parquet/arrow/writer.h>
+
+namespace {
+
+// Append-only string dictionary shared by all batches: each batch's
+// dictionary extends the previous one, which IPC streams send as a delta
+// and Parquet readers see as one consistent set of values
+class StringDictionary {
+public:
+    int16_t indexOf(const std::string& value) {
+        auto it = index_.find(value);
+        if (it != index_.end()) {
+            return it->second;
+        }
+        int16_t index = static_cast<int16_t>(values_.size());
+        index_.emplace(value, index);
+        values_.push_back(value);
+        return index;
+    }
+
+    arrow::Result<std::shared_ptr<arrow::Array>> array() const {
+        arrow::StringBuilder builder;
+        ARROW_RETURN_NOT_OK(builder.AppendValues(values_));
+        return builder.Finish();
+    }
+
+private:
+    std::unordered_map<std::string, int16_t> index_;
+    std::vector<std::string> values_;
+};
+
+std::shared_ptr<arrow::DataType> dictionaryType() {
+    return arrow::dictionary(arrow::int16(), arrow::utf8());
+}
+
+}  // namespace
+
+struct ArrowExporter::Impl {
+    Format format;
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<arrow::io::FileOutputStream> sink;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> ipc_writer;
+    std::unique_ptr<parquet::arrow::FileWriter> parquet_writer;
+
+    StringDictionary classes;
+    StringDictionary colors;
+    StringDictionary types;
+
+    // Columns of the batch being filled
+    arrow::Int32Builder frame;
+    arrow::DoubleBuilder timestamp;
+    arrow::Int32Builder track_id;
+    arrow::Int32Builder class_id;
+    arrow::Int16Builder class_index;
+    arrow::FloatBuilder x, y, w, h;
+    arrow::FloatBuilder confidence;
+    arrow::Int32Builder age;
+    arrow::Int32Builder hits;
+    arrow::Int16Builder color_index;
+    arrow::Int16Builder type_index;
+    arrow::FloatBuilder attribute_confidence;
+    int frames_pending = 0;
+
+    Impl() {
+        schema = arrow::schema({
+            arrow::field("frame", arrow::int32(), false),
+            arrow::field("timestamp_ms", arrow::float64(), false),
+            arrow::field("track_id", arrow::int32(), false),
+            arrow::field("class_id", arrow::int32(), false),
+            arrow::field("class", dictionaryType(), false),
+            arrow::field("x", arrow::float32(), false),
+            arrow::field("y", arrow::float32(), false),
+            arrow::field("w", arrow::float32(), false),
+            arrow::field("h", arrow::float32(), false),
+            arrow::field("confidence", arrow::float32(), false),
+            arrow::field("age", arrow::int32(), false),
+            arrow::field("hits", arrow::int32(), false),
+            arrow::field("color", dictionaryType()),
+            arrow::field("vehicle_type", dictionaryType()),
+            arrow::field("attribute_confidence", arrow::float32()),
+        });
+    }
+
+    arrow::Status open(const std::string& path) {
+        ARROW_ASSIGN_OR_RAISE(sink, arrow::io::FileOutputStream::Open(path));
+        if (format == Format::Parquet) {
+            auto compression = arrow::util::Codec::IsAvailable(arrow::Compression::ZSTD) ?
+                               parquet::Compression::ZSTD : parquet::Compression::SNAPPY;
+            auto properties = parquet::WriterProperties::Builder().compression(compression)->build();
+            // Keep the Arrow schema in the file so dictionaries come back as categoricals
+            auto arrow_properties = parquet::ArrowWriterProperties::Builder().store_schema()->build();
+            ARROW_ASSIGN_OR_RAISE(parquet_writer, parquet::arrow::FileWriter::Open(
+                *schema, arrow::default_memory_pool(), sink, properties, arrow_properties));
+        } else {
+            auto options = arrow::ipc::IpcWriteOptions::Defaults();
+            options.emit_dictionary_deltas = true;
+            if (arrow::util::Codec::IsAvailable(arrow::Compression::ZSTD)) {
+                ARROW_ASSIGN_OR_RAISE(options.codec, arrow::util::Codec::Create(arrow::Compression::ZSTD));
+            }
+            ARROW_ASSIGN_OR_RAISE(ipc_writer, arrow::ipc::MakeStreamWriter(sink, schema, options));
+        }
+        return arrow::Status::OK();
+    }
+
+    arrow::Status append(const FrameRecord& record) {
+        for (const auto& obj : record.objects) {
+            ARROW_RETURN_NOT_OK(frame.Append(record.frame_index));
+            ARROW_RETURN_NOT_OK(timestamp.Append(record.timestamp_ms));
+            ARROW_RETURN_NOT_OK(track_id.Append(obj.track_id));
+            ARROW_RETURN_NOT_OK(class_id.Append(obj.class_id));
+            ARROW_RETURN_NOT_OK(class_index.Append(classes.indexOf(obj.class_name)));
+            ARROW_RETURN_NOT_OK(x.Append(static_cast<float>(obj.bbox.x)));
+            ARROW_RETURN_NOT_OK(y.Append(static_cast<float>(obj.bbox.y)));
+            ARROW_RETURN_NOT_OK(w.Append(static_cast<float>(obj.bbox.width)));
+            ARROW_RETURN_NOT_OK(h.Append(static_cast<float>(obj.bbox.height)));
+            ARROW_RETURN_NOT_OK(confidence.Append(obj.confidence));
+            ARROW_RETURN_NOT_OK(age.Append(obj.age));
+            ARROW_RETURN_NOT_OK(hits.Append(obj.total_hits));
+            // Attributes are only known for classified tracks
+            if (obj.color.empty()) {
+                ARROW_RETURN_NOT_OK(color_index.AppendNull());
+                ARROW_RETURN_NOT_OK(type_index.AppendNull());
+                ARROW_RETURN_NOT_OK(attribute_confidence.AppendNull());
+            } else {
+                ARROW_RETURN_NOT_OK(color_index.Append(colors.indexOf(obj.color)));
+                ARROW_RETURN_NOT_OK(type_index.Append(types.indexOf(obj.vehicle_type)));
+                ARROW_RETURN_NOT_OK(attribute_confidence.Append(obj.attribute_confidence));
+            }
+        }
+        frames_pending++;
+        return arrow::Status::OK();
+    }
+
+    arrow::Result<std::shared_ptr<arrow::Array>> finishDictionary(arrow::Int16Builder& indices,
+                                                                  const StringDictionary& dictionary) {
+        ARROW_ASSIGN_OR_RAISE(auto index_array, indices.Finish());
+        ARROW_ASSIGN_OR_RAISE(auto values, dictionary.array());
+        return arrow::DictionaryArray::FromArrays(dictionaryType(), index_array, values);
+    }
+
+    // Write the pending rows as one record batch (Parquet row group)
+    arrow::Status flush(int64_t& rows) {
+        rows = frame.length();
+        frames_pending = 0;
+        if (rows == 0) {
+            return arrow::Status::OK();
+        }
+        std::vector<std::shared_ptr<arrow::Array>> columns;
+        for (arrow::ArrayBuilder* builder : std::initializer_list<arrow::ArrayBuilder*>{
+                 &frame, &timestamp, &track_id, &class_id}) {
+            ARROW_ASSIGN_OR_RAISE(auto column, builder->Finish());
+            columns.push_back(column);
+        }
+        ARROW_ASSIGN_OR_RAISE(auto class_column, finishDictionary(class_index, classes));
+        columns.push_back(class_column);
+        for (arrow::ArrayBuilder* builder : std::initializer_list<arrow::ArrayBuilder*>{
+                 &x, &y, &w, &h, &confidence, &age, &hits}) {
+            ARROW_ASSIGN_OR_RAISE(auto column, builder->Finish());
+            columns.push_back(column);
+        }
+        ARROW_ASSIGN_OR_RAISE(auto color_column, finishDictionary(color_index, colors));
+        columns.push_back(color_column);
+        ARROW_ASSIGN_OR_RAISE(auto type_column, finishDictionary(type_index, types));
+        columns.push_back(type_column);
+        ARROW_ASSIGN_OR_RAISE(auto attribute_column, attribute_confidence.Finish());
+        columns.push_back(attribute_column);
+
+        auto batch = arrow::RecordBatch::Make(schema, rows, columns);
+        if (parquet_writer) {
+            ARROW_ASSIGN_OR_RAISE(auto table, arrow::Table::FromRecordBatches(schema, {batch}));
+            return parquet_writer->WriteTable(*table, rows);
+        }
+        return ipc_writer->WriteRecordBatch(*batch);
+    }
+
+    // Footer (Parquet) or end-of-stream marker (IPC), then the file
+    arrow::Status finish(long& total_bytes) {
+        if (parquet_writer) {
+            ARROW_RETURN_NOT_OK(parquet_writer->Close());
+        } else if (ipc_writer) {
+            ARROW_RETURN_NOT_OK(ipc_writer->Close());
+        }
+        total_bytes = bytes();
+        return sink->Close();
+    }
+
+    long bytes() const {
+        if (!sink) {
+            return 0;
+        }
+        auto position = sink->Tell();
+        return position.ok() ? static_cast<long>(*position) : 0;
+    }
+};
+
+bool ArrowExporter::isSupported() {
+    return true;
+}
+
+#else
+
+struct ArrowExporter::Impl {};
+
+bool ArrowExporter::isSupported() {
+    return false;
+}
+
+#endif
+
+ArrowExporter::ArrowExporter()
+    : stop_requested_(false), batch_frames_(64), queue_capacity_(256),
+      frames_written_(0), rows_written_(0), batches_written_(0), dropped_frames_(0), bytes_written_(0),
+      write_ms_(0.0) {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    rows_metric_ = &registry.counter("export_rows_total", "Tracked-object rows written by the columnar exporter");
+    dropped_metric_ = &registry.counter("export_dropped_frames_total", "Frames not exported because the queue was full");
+    bytes_metric_ = &registry.gauge("export_bytes", "Size of the current export file");
+    queue_metric_ = &registry.gauge("export_queue_frames", "Frames waiting for the export writer");
+    batch_write_ms_ = &registry.histogram("export_batch_write_ms", "Time to build and write one record batch");
+}
+
+ArrowExporter::~ArrowExporter() {
+    close();
+}
+
+ArrowExporter::Format ArrowExporter::formatForPath(const std::string& path) {
+    const std::string suffix = ".parquet";
+    bool parquet = path.size() >= suffix.size() &&
+                   path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    return parquet ? Format::Parquet : Format::ArrowIpc;
+}
+
+bool ArrowExporter::open(const std::string& path, Format format) {
+    close();
+#ifdef HAVE_ARROW
+    auto impl = std::make_unique<Impl>();
+    impl->format = format;
+    arrow::Status status = impl->open(path);
+    if (!status.ok()) {
+        std::cerr << "ArrowExporter: cannot open " << path << ": " << status.ToString() << std::endl;
+        return false;
+    }
+    impl_ = std::move(impl);
+    queue_ = std::make_unique<SpscQueue<FrameRecord>>(queue_capacity_);
+    path_ = path;
+    stop_requested_ = false;
+    frames_written_ = 0;
+    rows_written_ = 0;
+    batches_written_ = 0;
+    dropped_frames_ = 0;
+    bytes_written_ = 0;
+    write_ms_ = 0.0;
+    writer_thread_ = std::thread(&ArrowExporter::writerLoop, this);
+    return true;
+#else
+    std::cerr << "ArrowExporter: built without Apache Arrow, cannot export " << path << std::endl;
+    return false;
+#endif
+}
+
+bool ArrowExporter::push(int frame_index, double timestamp_ms, const std::vector<TrackedObject>& objects, bool wait) {
+    if (!queue_ || !writer_thread_.joinable()) {
+        return false;
+    }
+    FrameRecord record{frame_index, timestamp_ms, objects};
+    while (!queue_->tryPush(std::move(record))) {
+        if (!wait) {
+            dropped_frames_++;
+            dropped_metric_->add();
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void ArrowExporter::close() {
+    if (!writer_thread_.joinable()) {
+        return;
+    }
+    stop_requested_ = true;
+    writer_thread_.join();
+    queue_.reset();
+    impl_.reset();
+
+    ExportStats s = stats();
+    std::cout << "ArrowExporter: " << path_ << ": " << s.rows_written << " rows from " << s.frames_written
+              << " frames in " << s.batches_written << " batches, " << s.bytes_written << " bytes, "
+              << s.rowsPerSecond() << " rows/s, " << s.megabytesPerSecond() << " MB/s"
+              << (s.dropped_frames > 0 ? ", " + std::to_string(s.dropped_frames) + " frames dropped" : "")
+              << std::endl;
+}
+
+ExportStats ArrowExporter::stats() const {
+    return ExportStats{frames_written_.load(), rows_written_.load(), batches_written_.load(),
+                       dropped_frames_.load(), bytes_written_.load(), write_ms_.load()};
+}
+
+void ArrowExporter::writerLoop() {
+#ifdef HAVE_ARROW
+    setCurrentThreadName("arrow-export");
+
+    auto flushBatch = [this]() {
+        if (impl_->frames_pending == 0) {
+            return;
+        }
+        TraceSpan span("export-batch");
+        auto start = std::chrono::steady_clock::now();
+        int64_t rows = 0;
+        arrow::Status status = impl_->flush(rows);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (!status.ok()) {
+            std::cerr << "ArrowExporter: batch write failed: " << status.ToString() << std::endl;
+            return;
+        }
+        write_ms_ = write_ms_.load() + ms;
+        batch_write_ms_->observe(ms);
+        batches_written_++;
+        bytes_written_ = impl_->bytes();
+        bytes_metric_->set(static_cast<double>(bytes_written_.load()));
+    };
+
+    FrameRecord record;
+    while (true) {
+        if (queue_->tryPop(record)) {
+            auto start = std::chrono::steady_clock::now();
+            arrow::Status status = impl_->append(record);
+            write_ms_ = write_ms_.load() +
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!status.ok()) {
+                std::cerr << "ArrowExporter: frame " << record.frame_index << " skipped: " << status.ToString() << std::endl;
+                continue;
+            }
+            frames_written_++;
+            rows_written_ += static_cast<long>(record.objects.size());
+            rows_metric_->add(record.objects.size());
+            queue_metric_->set(static_cast<double>(queue_->size()));
+            if (impl_->frames_pending >= batch_frames_) {
+                flushBatch();
+            }
+            continue;
+        }
+        if (stop_requested_) {
+            // The producer has stopped; anything pushed before close() is in the queue
+            if (queue_->empty()) {
+                break;
+            }
+            continue;
+        }
+        // Nothing to do; results arrive at frame rate, so polling is cheap
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    flushBatch();
+    long total_bytes = impl_->bytes();
+    arrow::Status status = impl_->finish(total_bytes);
+    if (!status.ok()) {
+        std::cerr << "ArrowExporter: closing " << path_ << " failed: " << status.ToString() << std::endl;
+    }
+    bytes_written_ = total_bytes;
+    bytes_metric_->set(static_cast<double>(bytes_written_.load()));
+    queue_metric_->set(0.0);
+#endif
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "detection_tracker.h"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Counter;
+class Gauge;
+class Histogram;
+
+struct ExportStats {
+    long frames_written;
+    long rows_written;
+    long batches_written;
+    long dropped_frames;   // queue full when pushed
+    long bytes_written;
+    double write_ms;       // time spent building and writing batches
+    double rowsPerSecond() const { return write_ms > 0.0 ? rows_written * 1000.0 / write_ms : 0.0; }
+    double megabytesPerSecond() const { return write_ms > 0.0 ? bytes_written / 1048.576 / write_ms : 0.0; }
+};
+
+// Streams per-frame tracking results to a columnar file for pandas/DuckDB:
+// Arrow IPC stream (.arrow/.arrows) or Parquet (.parquet). Rows are
+// frame-major, one per tracked object, with compact columns (int32 ids,
+// float32 boxes, dictionary-encoded class/color/type strings). Frames are
+// handed to a writer thread through a lock-free queue, so push() never waits
+// on disk; a record batch (Parquet row group) is written every N frames.
+class ArrowExporter {
+public:
+    enum class Format { ArrowIpc, Parquet };
+
+    ArrowExporter();
+    ~ArrowExporter();
+
+    // False when built without Apache Arrow
+    static bool isSupported();
+    static Format formatForPath(const std::string& path);
+
+    // Take effect on the next open()
+    void setBatchFrames(int frames) { batch_frames_ = std::max(1, frames); }
+    void setQueueCapacity(size_t frames) { queue_capacity_ = std::max<size_t>(1, frames); }
+
+    bool open(const std::string& path, Format format);
+    bool open(const std::string& path) { return open(path, formatForPath(path)); }
+
+    // Producer side (one thread). Without wait a full queue drops the frame
+    // and counts it; with wait it yields until there is room (offline export).
+    bool push(int frame_index, double timestamp_ms, const std::vector<TrackedObject>& objects, bool wait = false);
+
+    // Drain the queue, write the last batch and the footer
+    void close();
+    bool isOpen() const { return writer_thread_.joinable(); }
+    const std::string& path() const { return path_; }
+
+    // Safe to call while open; exact after close()
+    ExportStats stats() const;
+
+private:
+    struct FrameRecord {
+        int frame_index = -1;
+        double timestamp_ms = 0.0;
+        std::vector<TrackedObject> objects;
+    };
+
+    struct Impl;
+
+    void writerLoop();
+
+    std::unique_ptr<Impl> impl_;
+    std::unique_ptr<SpscQueue<FrameRecord>> queue_;
+    std::thread writer_thread_;
+    std::atomic<bool> stop_requested_;
+    std::string path_;
+    int batch_frames_;
+    size_t queue_capacity_;
+
+    std::atomic<long> frames_written_;
+    std::atomic<long> rows_written_;
+    std::atomic<long> batches_written_;
+    std::atomic<long> dropped_frames_;
+    std::atomic<long> bytes_written_;
+    std::atomic<double> write_ms_;
+
+    Counter* rows_metric_;
+    Counter* dropped_metric_;
+    Gauge* bytes_metric_;
+    Gauge* queue_metric_;
+    Histogram* batch_write_ms_;
+};
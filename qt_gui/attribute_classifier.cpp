@@ -0,0 +1,162 @@
+#include "attribute_classifier.h"
+#include "detection_tracker.h"
+#include <iostream>
+
+AttributeClassifier::AttributeClassifier()
+    : input_size_(72, 72), min_crop_size_(24), recheck_interval_(150), max_batch_(16),
+      target_classes_({2, 3, 5, 7}),  // car, motorcycle, bus, truck
+      color_labels_({"white", "gray", "yellow", "red", "green", "blue", "black"}),
+      type_labels_({"car", "bus", "truck", "van"}),
+      calls_(0), classified_crops_(0), cache_hits_(0), skipped_small_(0) {
+}
+
+bool AttributeClassifier::initialize(const std::string& model_path) {
+    try {
+        net_ = cv::dnn::readNetFromONNX(model_path);
+        if (net_.empty()) {
+            std::cerr << "Failed to load attribute model from: " << model_path << std::endl;
+            return false;
+        }
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        clear();
+        std::cout << "Attribute classifier loaded: " << model_path << std::endl;
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error loading attribute model: " << e.what() << std::endl;
+        net_ = cv::dnn::Net();
+        return false;
+    }
+}
+
+void AttributeClassifier::clear() {
+    cache_.clear();
+    last_seen_.clear();
+}
+
+void AttributeClassifier::forgetFrom(int first_track_id) {
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        it = it->first >= first_track_id ? cache_.erase(it) : ++it;
+    }
+    for (auto it = last_seen_.begin(); it != last_seen_.end();) {
+        it = it->first >= first_track_id ? last_seen_.erase(it) : ++it;
+    }
+}
+
+bool AttributeClassifier::isTargetClass(int class_id) const {
+    return target_classes_.empty() ||
+           std::find(target_classes_.begin(), target_classes_.end(), class_id) != target_classes_.end();
+}
+
+void AttributeClassifier::annotate(const cv::Mat& frame, std::vector<TrackedObject>& objects) {
+    calls_++;
+
+    std::vector<cv::Mat> crops;
+    std::vector<int> track_ids;
+    cv::Rect bounds(0, 0, frame.cols, frame.rows);
+
+    for (const auto& obj : objects) {
+        if (obj.track_id < 0 || !isTargetClass(obj.class_id)) {
+            continue;
+        }
+        last_seen_[obj.track_id] = calls_;
+
+        auto it = cache_.find(obj.track_id);
+        bool due = it == cache_.end() || calls_ - it->second.classified_at >= recheck_interval_;
+        if (!due || !isLoaded() || static_cast<int>(crops.size()) >= max_batch_) {
+            // Over-budget tracks are picked up on a later frame
+            if (it != cache_.end()) {
+                cache_hits_++;
+            }
+            continue;
+        }
+
+        cv::Rect roi = obj.bbox & bounds;
+        if (std::min(roi.width, roi.height) < min_crop_size_) {
+            skipped_small_++;
+            continue;
+        }
+        crops.push_back(frame(roi));
+        track_ids.push_back(obj.track_id);
+    }
+
+    if (!crops.empty()) {
+        classifyBatch(crops, track_ids);
+    }
+
+    for (auto& obj : objects) {
+        auto it = cache_.find(obj.track_id);
+        if (obj.track_id < 0 || it == cache_.end()) {
+            continue;
+        }
+        obj.color = it->second.color;
+        obj.vehicle_type = it->second.vehicle_type;
+        obj.attribute_confidence = std::min(it->second.color_confidence, it->second.type_confidence);
+    }
+
+    // Forget tracks that have been gone for a while
+    if (calls_ % 100 == 0) {
+        for (auto it = last_seen_.begin(); it != last_seen_.end();) {
+            if (calls_ - it->second > 300) {
+                cache_.erase(it->first);
+                it = last_seen_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+int AttributeClassifier::argmax(const float* scores, int count, float& best) {
+    int best_index = 0;
+    best = scores[0];
+    for (int i = 1; i < count; ++i) {
+        if (scores[i] > best) {
+            best = scores[i];
+            best_index = i;
+        }
+    }
+    return best_index;
+}
+
+void AttributeClassifier::classifyBatch(const std::vector<cv::Mat>& crops, const std::vector<int>& track_ids) {
+    std::vector<cv::Mat> outputs;
+    try {
+        cv::Mat blob = cv::dnn::blobFromImages(crops, 1.0, input_size_, cv::Scalar(), false, false);
+        net_.setInput(blob);
+        net_.forward(outputs, net_.getUnconnectedOutLayersNames());
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error in attribute classification: " << e.what() << std::endl;
+        outputs.clear();
+    }
+
+    // Heads are told apart by their width, which must match the label lists
+    const int batch = static_cast<int>(crops.size());
+    const cv::Mat* color_output = nullptr;
+    const cv::Mat* type_output = nullptr;
+    for (const auto& output : outputs) {
+        int per_crop = static_cast<int>(output.total()) / batch;
+        if (per_crop == static_cast<int>(color_labels_.size()) && !color_output) {
+            color_output = &output;
+        } else if (per_crop == static_cast<int>(type_labels_.size()) && !type_output) {
+            type_output = &output;
+        }
+    }
+
+    for (int i = 0; i < batch; ++i) {
+        // Failed crops still get a timestamp so they are retried at the next re-check, not every frame
+        VehicleAttributes attributes{"", "", 0.0f, 0.0f, calls_};
+        if (color_output) {
+            const float* scores = color_output->ptr<float>() + i * color_labels_.size();
+            attributes.color = color_labels_[argmax(scores, static_cast<int>(color_labels_.size()),
+                                                    attributes.color_confidence)];
+        }
+        if (type_output) {
+            const float* scores = type_output->ptr<float>() + i * type_labels_.size();
+            attributes.vehicle_type = type_labels_[argmax(scores, static_cast<int>(type_labels_.size()),
+                                                          attributes.type_confidence)];
+        }
+        cache_[track_ids[i]] = attributes;
+    }
+    classified_crops_ += batch;
+}
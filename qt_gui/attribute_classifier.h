@@ -0,0 +1,82 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TrackedObject;
+
+// Color/type attributes of one track, as last classified
+struct VehicleAttributes {
+    std::string color;
+    std::string vehicle_type;
+    float color_confidence;
+    float type_confidence;
+    long classified_at;  // classifier call count when this was produced
+};
+
+// Secondary classifier for vehicle color and type, run per track rather than
+// per detection: crops of newly confirmed tracks are batched through the
+// network once, re-checked every N frames, and the result is cached by track
+// id. Cost scales with track births, not detections x frames.
+//
+// The default labels match two-headed attribute nets such as OpenVINO's
+// vehicle-attributes-recognition-barrier (72x72 input, color and type outputs).
+class AttributeClassifier {
+public:
+    AttributeClassifier();
+
+    bool initialize(const std::string& model_path);
+    bool isLoaded() const { return !net_.empty(); }
+
+    // Fill color/vehicle_type on objects from the cache, classifying the ones
+    // that are new or due for a re-check
+    void annotate(const cv::Mat& frame, std::vector<TrackedObject>& objects);
+
+    // Drop cached attributes (e.g. when track ids are reused after a reset)
+    void clear();
+
+    // Drop cached attributes of ids from first_track_id on, which the tracker
+    // will hand out again after rewinding to a checkpoint
+    void forgetFrom(int first_track_id);
+
+    // Settings
+    void setInputSize(const cv::Size& size) { input_size_ = size; }
+    void setMinCropSize(int pixels) { min_crop_size_ = pixels; }
+    void setRecheckInterval(int frames) { recheck_interval_ = frames; }
+    void setMaxBatch(int crops) { max_batch_ = std::max(1, crops); }
+    void setTargetClasses(const std::vector<int>& class_ids) { target_classes_ = class_ids; }
+    void setColorLabels(const std::vector<std::string>& labels) { color_labels_ = labels; }
+    void setTypeLabels(const std::vector<std::string>& labels) { type_labels_ = labels; }
+
+    // Metrics
+    long getClassifiedCrops() const { return classified_crops_; }
+    long getCacheHits() const { return cache_hits_; }
+    long getSkippedSmall() const { return skipped_small_; }
+    size_t getCachedTracks() const { return cache_.size(); }
+
+private:
+    bool isTargetClass(int class_id) const;
+    void classifyBatch(const std::vector<cv::Mat>& crops, const std::vector<int>& track_ids);
+    static int argmax(const float* scores, int count, float& best);
+
+    cv::dnn::Net net_;
+    cv::Size input_size_;
+    int min_crop_size_;
+    int recheck_interval_;
+    int max_batch_;
+    std::vector<int> target_classes_;
+    std::vector<std::string> color_labels_;
+    std::vector<std::string> type_labels_;
+
+    std::unordered_map<int, VehicleAttributes> cache_;
+    std::unordered_map<int, long> last_seen_;
+    long calls_;
+
+    long classified_crops_;
+    long cache_hits_;
+    long skipped_small_;
+};
@@ -0,0 +1,214 @@
+#include "auto_tuner.h"
+#include "detection_tracker.h"
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+std::string backendName(int backend, int target) {
+    std::string name;
+    switch (backend) {
+        case cv::dnn::DNN_BACKEND_OPENCV: name = "OpenCV"; break;
+        case cv::dnn::DNN_BACKEND_INFERENCE_ENGINE: name = "OpenVINO"; break;
+        case cv::dnn::DNN_BACKEND_CUDA: name = "CUDA"; break;
+        default: name = "backend " + std::to_string(backend); break;
+    }
+    switch (target) {
+        case cv::dnn::DNN_TARGET_CPU: return name + "/CPU";
+        case cv::dnn::DNN_TARGET_OPENCL: return name + "/OpenCL";
+        case cv::dnn::DNN_TARGET_OPENCL_FP16: return name + "/OpenCL FP16";
+        case cv::dnn::DNN_TARGET_CUDA: return name + "/GPU";
+        case cv::dnn::DNN_TARGET_CUDA_FP16: return name + "/GPU FP16";
+        default: return name + "/target " + std::to_string(target);
+    }
+}
+
+}  // namespace
+
+std::string TuningConfig::describe() const {
+    std::ostringstream out;
+    out << backendName(backend, target) << ", " << threads << " threads, "
+        << input_size.width << "x" << input_size.height << " input, pipeline depth " << pipeline_depth;
+    return out.str();
+}
+
+AutoTuner::AutoTuner()
+    : target_fps_(25.0), timed_frames_(8), warmup_frames_(2) {
+}
+
+std::vector<std::pair<int, int>> AutoTuner::candidateBackends() {
+    std::vector<std::pair<int, int>> candidates = {{cv::dnn::DNN_BACKEND_OPENCV, cv::dnn::DNN_TARGET_CPU}};
+    for (const auto& available : cv::dnn::getAvailableBackends()) {
+        std::pair<int, int> candidate(available.first, available.second);
+        bool useful = (candidate.first == cv::dnn::DNN_BACKEND_CUDA) ||
+                      (candidate.first == cv::dnn::DNN_BACKEND_INFERENCE_ENGINE &&
+                       candidate.second == cv::dnn::DNN_TARGET_CPU) ||
+                      (candidate.first == cv::dnn::DNN_BACKEND_OPENCV &&
+                       (candidate.second == cv::dnn::DNN_TARGET_OPENCL ||
+                        candidate.second == cv::dnn::DNN_TARGET_OPENCL_FP16));
+        if (useful && std::find(candidates.begin(), candidates.end(), candidate) == candidates.end()) {
+            candidates.push_back(candidate);
+        }
+    }
+    return candidates;
+}
+
+TuningConfig AutoTuner::current(const DetectionTracker& tracker) {
+    return TuningConfig{tracker.getBackend(), tracker.getTarget(), tracker.getThreadCount(),
+                        tracker.getInputSize(), tracker.getPipelineDepth()};
+}
+
+void AutoTuner::apply(DetectionTracker& tracker, const TuningConfig& config) {
+    tracker.setBackend(config.backend, config.target);
+    tracker.setThreadCount(config.threads);
+    tracker.setInputSize(config.input_size);
+    tracker.setPipelineDepth(config.pipeline_depth);
+}
+
+bool AutoTuner::better(const TuningTrial& a, const TuningTrial& b) const {
+    if (a.ok != b.ok) {
+        return a.ok;
+    }
+    bool a_meets = a.fps >= target_fps_;
+    bool b_meets = b.fps >= target_fps_;
+    if (a_meets != b_meets) {
+        return a_meets;
+    }
+    return a_meets ? a.latency_ms < b.latency_ms : a.fps > b.fps;
+}
+
+TuningTrial AutoTuner::runTrial(DetectionTracker& tracker, const std::vector<cv::Mat>& frames,
+                                const TuningConfig& config) {
+    TuningTrial trial{config, false, 0.0, 0.0};
+    apply(tracker, config);
+    tracker.resetTracks();
+    long dropped_before = tracker.getDroppedFrames();
+
+    try {
+        // First frames pay for backend compilation and allocator warm-up
+        for (int i = 0; i < warmup_frames_; ++i) {
+            tracker.processFrame(frames[i % frames.size()]);
+        }
+
+        double latency_sum = 0.0;
+        int results = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < timed_frames_; ++i) {
+            PipelineResult result;
+            if (tracker.processFramePipelined(frames[i % frames.size()], -1, result)) {
+                latency_sum += result.latency_ms;
+                results++;
+            }
+        }
+        std::vector<PipelineResult> pending;
+        tracker.flushPipeline(pending);
+        for (const auto& result : pending) {
+            latency_sum += result.latency_ms;
+            results++;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Errors are swallowed per frame; a fast trial that produced nothing is a failed one
+        trial.ok = results > 0 && tracker.getDroppedFrames() == dropped_before;
+        trial.fps = elapsed > 0.0 ? results / elapsed : 0.0;
+        trial.latency_ms = results > 0 ? latency_sum / results : 0.0;
+    } catch (const cv::Exception& e) {
+        std::cerr << "AutoTuner: " << config.describe() << " failed: " << e.what() << std::endl;
+    }
+
+    std::cout << "AutoTuner: " << config.describe() << " -> "
+              << (trial.ok ? "" : "FAILED ") << trial.fps << " FPS, " << trial.latency_ms << " ms" << std::endl;
+    trials_.push_back(trial);
+    return trial;
+}
+
+bool AutoTuner::tune(DetectionTracker& tracker, const std::vector<cv::Mat>& frames, TuningTrial& best) {
+    trials_.clear();
+    if (frames.empty() || !tracker.hasModel()) {
+        return false;
+    }
+
+    // Trials must run the network on every frame to be comparable
+    int saved_interval = tracker.getDetectionInterval();
+    bool saved_gating = tracker.isMotionGatingEnabled();
+    TuningConfig initial = current(tracker);
+    tracker.setDetectionInterval(1);
+    tracker.enableMotionGating(false);
+
+    // Candidate values per dimension
+    std::vector<std::pair<int, int>> backends = candidateBackends();
+
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threads = {cores, std::max(1, cores / 2), std::max(1, cores / 4), 1};
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+    // Native size first, then smaller multiples of 32
+    cv::Size native = tracker.modelDescriptor().input_size;
+    std::vector<cv::Size> sizes = {native};
+    for (int side : {512, 416, 320}) {
+        if (side < std::min(native.width, native.height)) {
+            sizes.push_back(cv::Size(side, side));
+        }
+    }
+
+    std::vector<int> depths = {1, 2, 3};
+
+    int planned = static_cast<int>(backends.size() + threads.size() + sizes.size() + depths.size());
+    TuningConfig config{cv::dnn::DNN_BACKEND_OPENCV, cv::dnn::DNN_TARGET_CPU, cores, native, 1};
+    TuningTrial best_trial{config, false, 0.0, 0.0};
+    bool cancelled = false;
+
+    auto step = [&](const TuningConfig& candidate) {
+        if (cancelled) {
+            return;
+        }
+        if (progress_ && !progress_(static_cast<int>(trials_.size()), planned, candidate.describe())) {
+            cancelled = true;
+            return;
+        }
+        TuningTrial trial = runTrial(tracker, frames, candidate);
+        if (better(trial, best_trial)) {
+            best_trial = trial;
+        }
+    };
+
+    for (const auto& backend : backends) {
+        TuningConfig candidate = best_trial.ok ? best_trial.config : config;
+        candidate.backend = backend.first;
+        candidate.target = backend.second;
+        step(candidate);
+    }
+    for (int count : threads) {
+        TuningConfig candidate = best_trial.config;
+        candidate.threads = count;
+        step(candidate);
+    }
+    for (const auto& size : sizes) {
+        TuningConfig candidate = best_trial.config;
+        candidate.input_size = size;
+        step(candidate);
+    }
+    for (int depth : depths) {
+        TuningConfig candidate = best_trial.config;
+        candidate.pipeline_depth = depth;
+        step(candidate);
+    }
+
+    tracker.setDetectionInterval(saved_interval);
+    tracker.enableMotionGating(saved_gating);
+    tracker.resetTracks();
+
+    if (cancelled || !best_trial.ok) {
+        apply(tracker, initial);
+        return false;
+    }
+    apply(tracker, best_trial.config);
+    best = best_trial;
+    std::cout << "AutoTuner: chose " << best.config.describe() << " (" << best.fps << " FPS, "
+              << best.latency_ms << " ms)" << std::endl;
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class DetectionTracker;
+
+// One point in the search space
+struct TuningConfig {
+    int backend;
+    int target;
+    int threads;
+    cv::Size input_size;
+    int pipeline_depth;
+
+    std::string describe() const;
+};
+
+struct TuningTrial {
+    TuningConfig config;
+    bool ok;            // ran without errors
+    double fps;         // frames per second over the timed frames
+    double latency_ms;  // mean submit-to-result time per frame
+};
+
+// Benchmarks detector configurations on a handful of representative frames
+// and picks the one that reaches the target FPS with the lowest latency
+// (or the highest FPS if none does). The search runs one dimension at a
+// time (backend, threads, input size, pipeline depth), keeping the best
+// value of each before moving on, so it costs a dozen or so short trials
+// rather than the full product.
+class AutoTuner {
+public:
+    AutoTuner();
+
+    void setTargetFPS(double fps) { target_fps_ = fps; }
+    void setTimedFrames(int frames) { timed_frames_ = frames; }
+    void setWarmupFrames(int frames) { warmup_frames_ = frames; }
+
+    // Called before each trial with (trials done, trials planned, status);
+    // return false to cancel
+    using ProgressCallback = std::function<bool(int, int, const std::string&)>;
+    void setProgressCallback(ProgressCallback callback) { progress_ = std::move(callback); }
+
+    // Runs the search on tracker and leaves it configured with the result.
+    // Detection interval and motion gating are held off during trials and
+    // restored afterwards. False if cancelled or nothing ran successfully.
+    bool tune(DetectionTracker& tracker, const std::vector<cv::Mat>& frames, TuningTrial& best);
+
+    const std::vector<TuningTrial>& trials() const { return trials_; }
+
+    static void apply(DetectionTracker& tracker, const TuningConfig& config);
+    static TuningConfig current(const DetectionTracker& tracker);
+
+    // (backend, target) pairs cv::dnn can run here, CPU first
+    static std::vector<std::pair<int, int>> candidateBackends();
+
+private:
+    TuningTrial runTrial(DetectionTracker& tracker, const std::vector<cv::Mat>& frames, const TuningConfig& config);
+    bool better(const TuningTrial& a, const TuningTrial& b) const;
+
+    double target_fps_;
+    int timed_frames_;
+    int warmup_frames_;
+    ProgressCallback progress_;
+    std::vector<TuningTrial> trials_;
+};
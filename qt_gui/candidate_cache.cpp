@@ -0,0 +1,106 @@
+#include "candidate_cache.h"
+#include "detection_tracker.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+int16_t clampToInt16(int value) {
+    return static_cast<int16_t>(std::max<int>(std::numeric_limits<int16_t>::min(),
+                                              std::min<int>(std::numeric_limits<int16_t>::max(), value)));
+}
+
+} // namespace
+
+CandidateCache::CandidateCache(size_t max_frames, size_t max_candidates_per_frame)
+    : max_frames_(max_frames), max_candidates_per_frame_(max_candidates_per_frame),
+      candidate_count_(0), score_floor_(0.05f) {
+}
+
+void CandidateCache::store(int frame_index, const std::vector<DetectionResult>& candidates) {
+    if (frame_index < 0) {
+        return;
+    }
+
+    std::vector<CachedCandidate> packed;
+    packed.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        if (candidate.confidence < score_floor_) {
+            continue;
+        }
+        CachedCandidate c;
+        c.x = clampToInt16(candidate.box.x);
+        c.y = clampToInt16(candidate.box.y);
+        c.w = clampToInt16(candidate.box.width);
+        c.h = clampToInt16(candidate.box.height);
+        c.score = candidate.confidence;
+        c.class_id = static_cast<uint16_t>(std::max(0, candidate.class_id));
+        packed.push_back(c);
+    }
+
+    // Keep only the strongest candidates; the rest can never survive a sane threshold
+    if (packed.size() > max_candidates_per_frame_) {
+        std::partial_sort(packed.begin(), packed.begin() + max_candidates_per_frame_, packed.end(),
+                          [](const CachedCandidate& a, const CachedCandidate& b) {
+                              return a.score > b.score;
+                          });
+        packed.resize(max_candidates_per_frame_);
+    }
+    packed.shrink_to_fit();
+
+    auto it = frames_.find(frame_index);
+    if (it != frames_.end()) {
+        candidate_count_ -= it->second.size();
+        candidate_count_ += packed.size();
+        it->second = std::move(packed);
+        return;
+    }
+
+    // Evict the oldest frames once the store is full
+    while (frames_.size() >= max_frames_ && !insertion_order_.empty()) {
+        auto oldest = frames_.find(insertion_order_.front());
+        if (oldest != frames_.end()) {
+            candidate_count_ -= oldest->second.size();
+            frames_.erase(oldest);
+        }
+        insertion_order_.pop_front();
+    }
+
+    candidate_count_ += packed.size();
+    frames_.emplace(frame_index, std::move(packed));
+    insertion_order_.push_back(frame_index);
+}
+
+bool CandidateCache::lookup(int frame_index, std::vector<DetectionResult>& candidates) const {
+    auto it = frames_.find(frame_index);
+    if (it == frames_.end()) {
+        return false;
+    }
+
+    candidates.clear();
+    candidates.reserve(it->second.size());
+    for (const auto& c : it->second) {
+        DetectionResult result;
+        result.box = cv::Rect(c.x, c.y, c.w, c.h);
+        result.confidence = c.score;
+        result.class_id = c.class_id;
+        candidates.push_back(result);
+    }
+    return true;
+}
+
+std::vector<int> CandidateCache::cachedFrames() const {
+    std::vector<int> indices;
+    indices.reserve(frames_.size());
+    for (const auto& entry : frames_) {
+        indices.push_back(entry.first);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+void CandidateCache::clear() {
+    frames_.clear();
+    insertion_order_.clear();
+    candidate_count_ = 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+struct DetectionResult;
+
+// Compact pre-NMS candidate (16 bytes) kept per frame so that confidence,
+// NMS and class filters can be re-applied without running the network again
+struct CachedCandidate {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    float score;
+    uint16_t class_id;
+};
+
+// Per-frame store of all candidates above a low score floor
+class CandidateCache {
+public:
+    explicit CandidateCache(size_t max_frames = 20000, size_t max_candidates_per_frame = 300);
+
+    // Store candidates for a frame, keeping the highest scoring ones
+    void store(int frame_index, const std::vector<DetectionResult>& candidates);
+
+    // Fetch the cached candidates for a frame; false if the frame is not cached
+    bool lookup(int frame_index, std::vector<DetectionResult>& candidates) const;
+
+    bool contains(int frame_index) const { return frames_.count(frame_index) > 0; }
+    std::vector<int> cachedFrames() const;
+    void clear();
+
+    // Candidates below the floor are not worth keeping for later re-thresholding
+    void setScoreFloor(float floor) { score_floor_ = floor; }
+    float getScoreFloor() const { return score_floor_; }
+
+    size_t frameCount() const { return frames_.size(); }
+    size_t memoryBytes() const { return candidate_count_ * sizeof(CachedCandidate); }
+
+private:
+    std::unordered_map<int, std::vector<CachedCandidate>> frames_;
+    std::deque<int> insertion_order_;
+    size_t max_frames_;
+    size_t max_candidates_per_frame_;
+    size_t candidate_count_;
+    float score_floor_;
+};
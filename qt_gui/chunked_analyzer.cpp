@@ -0,0 +1,337 @@
+#include "chunked_analyzer.h"
+#include "ResourceSampler.hpp"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <tuple>
+
+ChunkedVideoAnalyzer::ChunkedVideoAnalyzer(const ChunkedAnalysisConfig& config)
+    : config_(config), frames_done_(0), frames_total_(0), cancelled_(false) {
+}
+
+double ChunkedVideoAnalyzer::getProgress() const {
+    int total = frames_total_.load();
+    return total > 0 ? static_cast<double>(frames_done_.load()) / total : 0.0;
+}
+
+bool ChunkedVideoAnalyzer::analyze(const std::string& video_path, ChunkedAnalysisResult& result) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    cv::VideoCapture probe(video_path);
+    if (!probe.isOpened()) {
+        std::cerr << "ChunkedVideoAnalyzer: could not open video: " << video_path << std::endl;
+        return false;
+    }
+    int total_frames = static_cast<int>(probe.get(cv::CAP_PROP_FRAME_COUNT));
+    probe.release();
+    if (total_frames <= 0) {
+        std::cerr << "ChunkedVideoAnalyzer: video reports no frames" << std::endl;
+        return false;
+    }
+
+    std::vector<Chunk> chunks = planChunks(total_frames);
+
+    frames_done_ = 0;
+    int work = 0;
+    for (const auto& chunk : chunks) {
+        work += chunk.end - chunk.warmup_begin;
+    }
+    frames_total_ = work;
+
+    std::cout << "ChunkedVideoAnalyzer: " << total_frames << " frames in " << chunks.size()
+              << " chunks (" << config_.overlap_frames << " frame overlap)" << std::endl;
+
+    // One worker per chunk. OpenCV's thread count is process-wide and shared
+    // with the live player, so it is left alone; with the default pthreads
+    // backend a parallel region started while the pool is busy runs on the
+    // calling thread, which keeps K workers from oversubscribing
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        workers.emplace_back(&ChunkedVideoAnalyzer::processChunk, this, std::cref(video_path), std::ref(chunk));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (cancelled_.load()) {
+        std::cout << "ChunkedVideoAnalyzer: cancelled" << std::endl;
+        return false;
+    }
+    for (const auto& chunk : chunks) {
+        if (!chunk.ok) {
+            std::cerr << "ChunkedVideoAnalyzer: chunk [" << chunk.begin << ", " << chunk.end
+                      << ") failed" << std::endl;
+            return false;
+        }
+    }
+
+    result = ChunkedAnalysisResult();
+    result.total_frames = total_frames;
+    result.chunks = static_cast<int>(chunks.size());
+    result.class_names = class_names_;
+    result.model_descriptor = model_descriptor_;
+    stitchChunks(chunks, result);
+    for (auto& chunk : chunks) {
+        result.chunk_candidates.push_back({chunk.begin, chunk.end, chunk.warmup_begin, std::move(chunk.candidates)});
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+    std::cout << "ChunkedVideoAnalyzer: done in " << result.elapsed_ms << " ms, "
+              << result.total_tracks << " tracks (" << result.stitched_tracks
+              << " stitched across chunks)" << std::endl;
+    return true;
+}
+
+std::vector<ChunkedVideoAnalyzer::Chunk> ChunkedVideoAnalyzer::planChunks(int total_frames) const {
+    int k = config_.num_chunks > 0 ? config_.num_chunks
+                                   : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int min_frames = std::max(config_.min_chunk_frames, config_.overlap_frames + 1);
+    k = std::max(1, std::min(k, total_frames / std::max(1, min_frames)));
+
+    // OpenCV does not expose the keyframe index, so boundaries are spaced
+    // evenly; each worker seeks (the backend decodes forward from the
+    // preceding keyframe) and the overlap hides the tracker warm-up
+    std::vector<Chunk> chunks;
+    for (int i = 0; i < k; ++i) {
+        Chunk chunk;
+        chunk.begin = static_cast<int>(static_cast<long long>(total_frames) * i / k);
+        chunk.end = static_cast<int>(static_cast<long long>(total_frames) * (i + 1) / k);
+        chunk.warmup_begin = std::max(0, chunk.begin - (i > 0 ? config_.overlap_frames : 0));
+        chunk.ok = false;
+        chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+void ChunkedVideoAnalyzer::processChunk(const std::string& video_path, Chunk& chunk) {
+    setCurrentThreadName("chunk-worker");
+    try {
+        cv::VideoCapture capture(video_path);
+        if (!capture.isOpened()) {
+            return;
+        }
+        if (chunk.warmup_begin > 0) {
+            capture.set(cv::CAP_PROP_POS_FRAMES, chunk.warmup_begin);
+        }
+
+        DetectionTracker tracker;
+        if (!tracker.initialize(config_.model_path, "", config_.classes_path,
+                                config_.conf_threshold, config_.nms_threshold)) {
+            std::cerr << "ChunkedVideoAnalyzer: could not load model for chunk" << std::endl;
+            return;
+        }
+        configureTracker(tracker);
+        // Room for every frame of the chunk, kept for rethreshold()
+        tracker.candidateCache() = CandidateCache(chunk.end - chunk.warmup_begin);
+
+        chunk.frames.reserve(chunk.end - chunk.warmup_begin);
+        cv::Mat frame;
+        for (int index = chunk.warmup_begin; index < chunk.end; ++index) {
+            if (cancelled_.load()) {
+                return;
+            }
+            if (!capture.read(frame) || frame.empty()) {
+                break;
+            }
+            chunk.frames.push_back(tracker.processFrame(frame, index));
+            frames_done_++;
+        }
+
+        // Pad frames the decoder could not deliver so indices stay aligned
+        chunk.frames.resize(chunk.end - chunk.warmup_begin);
+        chunk.candidates = std::move(tracker.candidateCache());
+        if (chunk.begin == 0) {
+            // Read by analyze() after the join
+            class_names_ = tracker.getClassNames();
+            model_descriptor_ = tracker.modelDescriptor();
+        }
+        chunk.ok = true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error in chunk worker: " << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error in chunk worker: " << e.what() << std::endl;
+    }
+}
+
+bool ChunkedVideoAnalyzer::rethreshold(ChunkedAnalysisResult& result) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (result.chunk_candidates.empty()) {
+        return false;
+    }
+
+    std::vector<Chunk> chunks;
+    int work = 0;
+    for (auto& cached : result.chunk_candidates) {
+        Chunk chunk;
+        chunk.begin = cached.begin;
+        chunk.end = cached.end;
+        chunk.warmup_begin = cached.warmup_begin;
+        chunk.candidates = std::move(cached.cache);
+        chunk.ok = false;
+        work += chunk.end - chunk.warmup_begin;
+        chunks.push_back(std::move(chunk));
+    }
+    result.chunk_candidates.clear();
+    frames_done_ = 0;
+    frames_total_ = work;
+
+    // No inference here, only NMS and association: one thread per chunk
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        workers.emplace_back(&ChunkedVideoAnalyzer::retrackChunk, this, std::ref(chunk), std::cref(result));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The candidates go back into the result even when cancelled, so a later
+    // rethreshold still has them
+    bool ok = !cancelled_.load() &&
+              std::all_of(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.ok; });
+    if (ok) {
+        result.stitched_tracks = 0;
+        stitchChunks(chunks, result);
+    }
+    for (auto& chunk : chunks) {
+        result.chunk_candidates.push_back({chunk.begin, chunk.end, chunk.warmup_begin, std::move(chunk.candidates)});
+    }
+    if (!ok) {
+        return false;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    std::cout << "ChunkedVideoAnalyzer: re-thresholded in " << result.elapsed_ms << " ms, "
+              << result.total_tracks << " tracks" << std::endl;
+    return true;
+}
+
+void ChunkedVideoAnalyzer::configureTracker(DetectionTracker& tracker) const {
+    tracker.setMetricsScope("analysis");  // keep chunk workers out of the live view's numbers
+    tracker.setConfidenceThreshold(config_.conf_threshold);
+    tracker.setNMSThreshold(config_.nms_threshold);
+    if (!config_.class_filter.empty()) {
+        tracker.setClassFilter(config_.class_filter);
+    }
+}
+
+void ChunkedVideoAnalyzer::retrackChunk(Chunk& chunk, const ChunkedAnalysisResult& result) {
+    setCurrentThreadName("chunk-worker");
+    try {
+        // A fresh tracker replays the chunk from its own cache, exactly as the
+        // worker that analysed it would have with these settings
+        DetectionTracker tracker;
+        tracker.setModelDescriptor(result.model_descriptor);
+        configureTracker(tracker);
+        std::swap(tracker.candidateCache(), chunk.candidates);
+
+        chunk.frames.assign(chunk.end - chunk.warmup_begin, std::vector<TrackedObject>());
+        for (int index = chunk.warmup_begin; index < chunk.end; ++index) {
+            if (cancelled_.load()) {
+                break;
+            }
+            // Frames the decoder never delivered have no candidates and stay empty
+            tracker.trackCachedFrame(index, &chunk.frames[index - chunk.warmup_begin]);
+            frames_done_++;
+        }
+        std::swap(tracker.candidateCache(), chunk.candidates);
+
+        // Without a model the tracker has no class names of its own
+        const auto& class_names = result.class_names;
+        for (auto& objects : chunk.frames) {
+            for (auto& obj : objects) {
+                if (obj.class_id >= 0 && obj.class_id < static_cast<int>(class_names.size())) {
+                    obj.class_name = class_names[obj.class_id];
+                }
+            }
+        }
+        chunk.ok = !cancelled_.load();
+    } catch (const std::exception& e) {
+        std::cerr << "Error in chunk re-threshold: " << e.what() << std::endl;
+    }
+}
+
+void ChunkedVideoAnalyzer::stitchChunks(std::vector<Chunk>& chunks, ChunkedAnalysisResult& result) {
+    int next_global_id = 0;
+    result.frames.assign(result.total_frames, std::vector<TrackedObject>());
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        Chunk& chunk = chunks[c];
+        std::map<int, int> local_to_global;
+
+        if (c > 0) {
+            // Score every (previous global id, local id) pair over the overlap window
+            const Chunk& prev = chunks[c - 1];
+            std::map<std::pair<int, int>, std::pair<float, int>> overlap_scores;
+            for (int f = chunk.warmup_begin; f < chunk.begin; ++f) {
+                const auto& prev_objects = prev.frames[f - prev.warmup_begin];
+                const auto& cur_objects = chunk.frames[f - chunk.warmup_begin];
+                for (const auto& a : prev_objects) {
+                    for (const auto& b : cur_objects) {
+                        if (a.class_id != b.class_id) {
+                            continue;
+                        }
+                        float iou = calculateIOU(a.bbox, b.bbox);
+                        if (iou > 0.0f) {
+                            auto& score = overlap_scores[{a.track_id, b.track_id}];
+                            score.first += iou;
+                            score.second++;
+                        }
+                    }
+                }
+            }
+
+            // Greedy assignment, most consistent pairs first
+            std::vector<std::tuple<float, int, int>> candidates;
+            for (const auto& entry : overlap_scores) {
+                float mean_iou = entry.second.first / entry.second.second;
+                if (entry.second.second >= config_.stitch_min_frames &&
+                    mean_iou >= config_.stitch_iou_threshold) {
+                    candidates.push_back({mean_iou, entry.first.first, entry.first.second});
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(),
+                      [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+
+            std::map<int, bool> global_taken;
+            for (const auto& candidate : candidates) {
+                int global_id = std::get<1>(candidate);
+                int local_id = std::get<2>(candidate);
+                if (global_taken[global_id] || local_to_global.count(local_id)) {
+                    continue;
+                }
+                global_taken[global_id] = true;
+                local_to_global[local_id] = global_id;
+                result.stitched_tracks++;
+            }
+        }
+
+        // Rewrite local ids in place so the next chunk matches against global ids
+        for (auto& objects : chunk.frames) {
+            for (auto& obj : objects) {
+                auto it = local_to_global.find(obj.track_id);
+                if (it == local_to_global.end()) {
+                    it = local_to_global.emplace(obj.track_id, next_global_id++).first;
+                }
+                obj.track_id = it->second;
+            }
+        }
+
+        for (int f = chunk.begin; f < chunk.end; ++f) {
+            result.frames[f] = chunk.frames[f - chunk.warmup_begin];
+        }
+    }
+
+    result.total_tracks = next_global_id;
+}
+
+float ChunkedVideoAnalyzer::calculateIOU(const cv::Rect& rect1, const cv::Rect& rect2) const {
+    int intersection = (rect1 & rect2).area();
+    int union_area = rect1.area() + rect2.area() - intersection;
+    return union_area > 0 ? static_cast<float>(intersection) / union_area : 0.0f;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "detection_tracker.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+struct ChunkedAnalysisConfig {
+    std::string model_path = "models/yolov8n.onnx";
+    std::string classes_path = "models/coco.names";
+    float conf_threshold = 0.3f;
+    float nms_threshold = 0.4f;
+    std::vector<int> class_filter;   // empty = the tracker's default
+    int num_chunks = 0;              // 0 = one chunk per hardware thread
+    int overlap_frames = 30;         // frames processed by both neighbouring chunks
+    int min_chunk_frames = 300;      // don't split shorter than this
+    float stitch_iou_threshold = 0.5f;
+    int stitch_min_frames = 3;       // co-visible frames required to link two tracks
+};
+
+// Pre-NMS candidates of one chunk, kept so the whole analysis can be
+// re-thresholded without running the network again
+struct ChunkCandidates {
+    int begin;
+    int end;
+    int warmup_begin;
+    CandidateCache cache;
+};
+
+struct ChunkedAnalysisResult {
+    std::vector<std::vector<TrackedObject>> frames;  // tracked objects per video frame
+    std::vector<ChunkCandidates> chunk_candidates;
+    std::vector<std::string> class_names;
+    ModelOutputDescriptor model_descriptor;  // how the cached candidates were decoded
+    int total_frames = 0;
+    int chunks = 0;
+    int stitched_tracks = 0;
+    int total_tracks = 0;
+    double elapsed_ms = 0.0;
+};
+
+// Offline analysis of one long video split into K overlapping chunks, each
+// processed by its own decoder + detector + tracker on a separate core.
+// Track ids are reconciled across chunk boundaries from the overlap windows.
+class ChunkedVideoAnalyzer {
+public:
+    explicit ChunkedVideoAnalyzer(const ChunkedAnalysisConfig& config);
+
+    bool analyze(const std::string& video_path, ChunkedAnalysisResult& result);
+
+    // Re-derive result.frames from its cached candidates under this
+    // analyzer's thresholds and class filter, re-tracking every chunk and
+    // stitching again
+    bool rethreshold(ChunkedAnalysisResult& result);
+
+    // Progress in [0, 1]; safe to poll from another thread
+    double getProgress() const;
+    void cancel() { cancelled_ = true; }
+    bool isCancelled() const { return cancelled_.load(); }
+
+private:
+    struct Chunk {
+        int begin;        // first frame owned by this chunk
+        int end;          // one past the last owned frame
+        int warmup_begin; // first decoded frame (begin - overlap)
+        std::vector<std::vector<TrackedObject>> frames;  // indexed from warmup_begin
+        CandidateCache candidates;
+        bool ok;
+    };
+
+    std::vector<Chunk> planChunks(int total_frames) const;
+    void processChunk(const std::string& video_path, Chunk& chunk);
+    void retrackChunk(Chunk& chunk, const ChunkedAnalysisResult& result);
+    void configureTracker(DetectionTracker& tracker) const;
+    void stitchChunks(std::vector<Chunk>& chunks, ChunkedAnalysisResult& result);
+    float calculateIOU(const cv::Rect& rect1, const cv::Rect& rect2) const;
+
+    ChunkedAnalysisConfig config_;
+    // Model details from the first chunk's tracker
+    std::vector<std::string> class_names_;
+    ModelOutputDescriptor model_descriptor_;
+    std::atomic<int> frames_done_;
+    std::atomic<int> frames_total_;
+    std::atomic<bool> cancelled_;
+};
@@ -1,4 +1,6 @@
 #include "detection_tracker.h"
+#include "ResourceSampler.hpp"
+#include "TraceRecorder.hpp"
 #include <fstream>
 #include <algorithm>
 #include <iostream>
@@ -14,6 +16,26 @@ Track::Track(const cv::Rect& bbox, int track_id, int class_id, float confidence,
     velocity_ = cv::Point2f(0, 0);
 }
 
+Track::Track(const TrackState& state, const std::string& class_name)
+    : track_id_(state.track_id), class_id_(state.class_id), confidence_(state.confidence),
+      class_name_(class_name), bbox_(state.bbox), age_(state.age), total_hits_(state.total_hits),
+      time_since_update_(state.time_since_update), velocity_(state.velocity), position_(state.position) {
+}
+
+TrackState Track::getState() const {
+    TrackState state;
+    state.track_id = track_id_;
+    state.class_id = class_id_;
+    state.confidence = confidence_;
+    state.bbox = bbox_;
+    state.age = age_;
+    state.total_hits = total_hits_;
+    state.time_since_update = time_since_update_;
+    state.position = position_;
+    state.velocity = velocity_;
+    return state;
+}
+
 void Track::predict() {
     age_++;
     time_since_update_++;
@@ -41,6 +63,19 @@ void Track::update(const cv::Rect& bbox, float confidence) {
     time_since_update_ = 0;
 }
 
+void Track::shift(const cv::Point2f& displacement) {
+    age_++;
+    time_since_update_++;
+    
+    // Observed motion replaces the constant-velocity guess
+    velocity_.x = 0.7f * velocity_.x + 0.3f * displacement.x;
+    velocity_.y = 0.7f * velocity_.y + 0.3f * displacement.y;
+    position_ += displacement;
+    
+    bbox_.x = static_cast<int>(position_.x - bbox_.width/2.0f);
+    bbox_.y = static_cast<int>(position_.y - bbox_.height/2.0f);
+}
+
 cv::Rect Track::getBBox() const {
     return bbox_;
 }
@@ -51,11 +86,23 @@ cv::Point2f Track::getCenter() const {
 
 // DetectionTracker implementation
 DetectionTracker::DetectionTracker()
-    : conf_threshold_(0.5), nms_threshold_(0.4), next_track_id_(0), 
+    : conf_threshold_(0.5), nms_threshold_(0.4), current_frame_index_(-1), motion_gating_(false),
+      tiled_inference_(false), tile_cols_(3), tile_rows_(2), tile_change_threshold_(4.0f),
+      full_frame_interval_(30), tile_batch_size_(4), frames_since_full_(0),
+      tiles_inferred_(0), tiles_considered_(0),
+      detection_interval_(1), frames_since_detection_(0),
+      propagated_frames_(0), propagated_boxes_(0), mv_propagated_boxes_(0), attributes_enabled_(false),
+      secondary_suspended_(false),
+      cascade_enabled_(false), refine_input_size_(320), cascade_max_crops_(8), cascade_max_ms_(40.0),
+      cascade_batch_size_(4), cascade_low_conf_(0.15f), cascade_crops_per_frame_(0.0), cascade_time_ms_(0.0),
+      last_frame_index_(-1), next_track_id_(0), 
       max_disappeared_(30), min_hits_(3), iou_threshold_(0.3),
       current_fps_(0.0), detection_time_ms_(0.0), tracking_time_ms_(0.0), 
-      active_tracks_(0), num_threads_(std::thread::hardware_concurrency()),
-      use_optimizations_(true) {
+      active_tracks_(0), dropped_frames_(0), num_threads_(std::thread::hardware_concurrency()),
+      backend_(cv::dnn::DNN_BACKEND_OPENCV), target_(cv::dnn::DNN_TARGET_CPU),
+      use_optimizations_(true), pipeline_depth_(1), pipeline_stop_(false), pipeline_in_flight_(0),
+      pipeline_latency_ms_(0.0), pipeline_added_latency_ms_(0.0),
+      swap_loading_(false), swap_ready_(false), model_swaps_(0) {
     
     // Pre-allocate buffers for better performance
     frame_buffer_ = cv::Mat(640, 640, CV_8UC3);
@@ -63,15 +110,25 @@ DetectionTracker::DetectionTracker()
     blob_buffer_.reserve(10);
     detection_buffer_.reserve(100);
     tracked_objects_buffer_.reserve(100);
+    
+    // Relevant classes (vehicles and people): person, bicycle, car, motorcycle, bus, truck, boat
+    setClassFilter({0, 1, 2, 3, 5, 7, 8});
+    setMetricsScope("detector");
 }
 
 DetectionTracker::~DetectionTracker() {
+    if (swap_thread_.joinable()) {
+        swap_thread_.join();
+    }
+    stopPipeline();
 }
 
 bool DetectionTracker::initialize(const std::string& model_path, const std::string& config_path,
                                  const std::string& classes_path, float conf_threshold, 
                                  float nms_threshold) {
     try {
+        auto load_start = std::chrono::high_resolution_clock::now();
+        
         // Load YOLO model
         yolo_net_ = cv::dnn::readNetFromONNX(model_path);
         if (yolo_net_.empty()) {
@@ -79,34 +136,38 @@ bool DetectionTracker::initialize(const std::string& model_path, const std::stri
             return false;
         }
         
-        // Set backend and target for optimal performance
-        yolo_net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        yolo_net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-        
-        // Enable optimizations for better performance
-        yolo_net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        yolo_net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        // Set backend and target (OpenCV/CPU unless setBackend chose otherwise)
+        yolo_net_.setPreferableBackend(backend_);
+        yolo_net_.setPreferableTarget(target_);
         
-        // Set number of threads for parallel processing
-        cv::setNumThreads(num_threads_);
+        // OpenCV's thread count is process-wide, so it is left alone here and
+        // only changed through setThreadCount; loading a model in one tracker
+        // (e.g. an analysis worker) must not reset another's setting
         
         // Enable OpenCV optimizations
         cv::setUseOptimized(use_optimizations_);
         
-        // Set memory pool size for better performance
-        cv::setNumThreads(num_threads_);
-        
         // Enable additional optimizations
         cv::setUseOptimized(true);
-        cv::setNumThreads(num_threads_);
         
         // Load class names
         loadClassNames(classes_path);
         
+        // Output layout from the exporter's metadata; the shape check on the
+        // first output fills in whatever the metadata did not say
+        descriptor_ = ModelOutputDescriptor::fromOnnxFile(model_path);
+        if (!descriptor_.class_names.empty() && descriptor_.class_names.size() != class_names_.size()) {
+            class_names_ = descriptor_.class_names;
+        }
+        std::cout << "Model output: " << descriptor_.describe() << std::endl;
+        model_path_ = model_path;
+        
         // Set thresholds
         conf_threshold_ = conf_threshold;
         nms_threshold_ = nms_threshold;
         
+        metrics_.model_load_ms->set(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - load_start).count());
         std::cout << "DetectionTracker initialized successfully" << std::endl;
         std::cout << "Model: " << model_path << std::endl;
         std::cout << "Classes loaded: " << class_names_.size() << std::endl;
@@ -121,61 +182,208 @@ bool DetectionTracker::initialize(const std::string& model_path, const std::stri
     }
 }
 
-std::vector<TrackedObject> DetectionTracker::processFrame(const cv::Mat& frame) {
+std::vector<TrackedObject> DetectionTracker::processFrame(const cv::Mat& frame, int frame_index) {
     try {
+        // Frames still in the pipeline must be tracked before this one
+        if (pipeline_in_flight_ > 0) {
+            std::vector<PipelineResult> pending;
+            flushPipeline(pending);
+        }
+        adoptStagedModel(nullptr);
+        
+        current_frame_index_ = frame_index;
+        TraceSpan frame_span("processFrame", frame_index);
         auto start_time = std::chrono::high_resolution_clock::now();
         
+        // Between detection frames boxes only follow the motion
+        if (!isDetectionFrame(frame_index)) {
+            auto tracking_start = std::chrono::high_resolution_clock::now();
+            TraceSpan propagate_span("propagate", frame_index);
+            propagateTracks(frame_motion_vectors_);
+            frame_motion_vectors_.clear();
+            auto tracking_end = std::chrono::high_resolution_clock::now();
+            detection_time_ms_ = 0.0;
+            tracking_time_ms_ = std::chrono::duration<double, std::milli>(tracking_end - tracking_start).count();
+            
+            finishFrame(frame_index);
+            std::vector<TrackedObject> tracked_objects = collectTrackedObjects();
+            if (attributes_enabled_ && !secondary_suspended_) {
+                TraceSpan span("attributes", frame_index);
+                attribute_classifier_.annotate(frame, tracked_objects);
+            }
+            current_fps_ = 1000.0 / std::max(0.001, tracking_time_ms_);
+            publishFrameMetrics(false, tracking_time_ms_);
+            return tracked_objects;
+        }
+        frame_motion_vectors_.clear();
+        
         // Detect objects
         auto detection_start = std::chrono::high_resolution_clock::now();
-        std::vector<Detection> detections = detectObjects(frame);
+        std::vector<Detection> detections;
+        bool inferred = gateAllowsInference(frame);
+        if (inferred) {
+            detections = detectObjects(frame);
+        } else {
+            // Nothing moved: remember the frame as empty so replays stay consistent
+            candidate_cache_.store(frame_index, std::vector<DetectionResult>());
+        }
         auto detection_end = std::chrono::high_resolution_clock::now();
         detection_time_ms_ = std::chrono::duration<double, std::milli>(detection_end - detection_start).count();
         
         // Update tracks
         auto tracking_start = std::chrono::high_resolution_clock::now();
-        updateTracks(detections);
+        {
+            TraceSpan span("associate", frame_index);
+            updateTracks(detections);
+        }
         auto tracking_end = std::chrono::high_resolution_clock::now();
         tracking_time_ms_ = std::chrono::duration<double, std::milli>(tracking_end - tracking_start).count();
         
-        // Create tracked objects list
-        std::vector<TrackedObject> tracked_objects;
-        active_tracks_ = 0;
+        finishFrame(frame_index);
         
-        for (const auto& track : tracks_) {
-            if (track->getTimeSinceUpdate() < max_disappeared_ && track->isConfirmed()) {
-                TrackedObject obj;
-                obj.track_id = track->getTrackId();
-                obj.bbox = track->getBBox();
-                obj.confidence = track->getConfidence();
-                obj.class_id = track->getClassId();
-                obj.class_name = track->getClassName();
-                obj.age = track->getAge();
-                obj.total_hits = track->getTotalHits();
-                obj.time_since_update = track->getTimeSinceUpdate();
-                
-                tracked_objects.push_back(obj);
-                active_tracks_++;
-            }
+        // Create tracked objects list
+        std::vector<TrackedObject> tracked_objects = collectTrackedObjects();
+        if (attributes_enabled_ && !secondary_suspended_) {
+            TraceSpan span("attributes", frame_index);
+            attribute_classifier_.annotate(frame, tracked_objects);
         }
         
         // Calculate FPS
         auto end_time = std::chrono::high_resolution_clock::now();
         double frame_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
         current_fps_ = 1000.0 / frame_time;
+        publishFrameMetrics(inferred, frame_time);
         
         return tracked_objects;
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error in processFrame: " << e.what() << std::endl;
+        recordDroppedFrame();
         return std::vector<TrackedObject>();
     } catch (const std::exception& e) {
         std::cerr << "Error in processFrame: " << e.what() << std::endl;
+        recordDroppedFrame();
         return std::vector<TrackedObject>();
     } catch (...) {
         std::cerr << "Unknown error in processFrame" << std::endl;
+        recordDroppedFrame();
         return std::vector<TrackedObject>();
     }
 }
 
+std::vector<Detection> DetectionTracker::detectFrame(const cv::Mat& frame) {
+    if (pipeline_in_flight_ > 0) {
+        std::vector<PipelineResult> pending;
+        flushPipeline(pending);
+    }
+    adoptStagedModel(nullptr);
+    current_frame_index_ = -1;
+    return detectObjects(frame);
+}
+
+std::vector<TrackedObject> DetectionTracker::collectTrackedObjects() {
+    std::vector<TrackedObject> tracked_objects;
+    active_tracks_ = 0;
+    
+    for (const auto& track : tracks_) {
+        if (track->getTimeSinceUpdate() < max_disappeared_ && track->isConfirmed()) {
+            TrackedObject obj;
+            obj.track_id = track->getTrackId();
+            obj.bbox = track->getBBox();
+            obj.confidence = track->getConfidence();
+            obj.class_id = track->getClassId();
+            obj.class_name = track->getClassName();
+            obj.age = track->getAge();
+            obj.total_hits = track->getTotalHits();
+            obj.time_since_update = track->getTimeSinceUpdate();
+            
+            tracked_objects.push_back(obj);
+            active_tracks_++;
+        }
+    }
+    
+    return tracked_objects;
+}
+
+void DetectionTracker::finishFrame(int frame_index) {
+    if (frame_index < 0) {
+        return;
+    }
+    last_frame_index_ = frame_index;
+    if (checkpoints_.isDue(frame_index)) {
+        checkpoints_.store(snapshot());
+    }
+}
+
+TrackerSnapshot DetectionTracker::snapshot() const {
+    TrackerSnapshot snap;
+    snap.frame_index = last_frame_index_;
+    snap.next_track_id = next_track_id_;
+    snap.tracks.reserve(tracks_.size());
+    for (const auto& track : tracks_) {
+        snap.tracks.push_back(track->getState());
+    }
+    return snap;
+}
+
+void DetectionTracker::restore(const TrackerSnapshot& snap) {
+    tracks_.clear();
+    for (const auto& state : snap.tracks) {
+        std::string class_name = (state.class_id >= 0 && state.class_id < static_cast<int>(class_names_.size())) ?
+                                 class_names_[state.class_id] : "unknown";
+        tracks_.push_back(std::make_unique<Track>(state, class_name));
+    }
+    next_track_id_ = snap.next_track_id;
+    last_frame_index_ = snap.frame_index;
+    // Ids from here on belonged to other vehicles on the abandoned timeline
+    attribute_classifier_.forgetFrom(next_track_id_);
+}
+
+void DetectionTracker::resetTracks() {
+    tracks_.clear();
+    attribute_classifier_.clear();
+    last_frame_index_ = -1;
+    active_tracks_ = 0;
+}
+
+int DetectionTracker::seekTo(int frame_index) {
+    // In-order playback keeps the live state
+    if (last_frame_index_ >= 0 && frame_index == last_frame_index_ + 1) {
+        return frame_index;
+    }
+    
+    TrackerSnapshot checkpoint;
+    bool have_checkpoint = checkpoints_.findAtOrBefore(frame_index - 1, checkpoint);
+    
+    // Stepping forward past the last checkpoint: replay from where we are
+    if (last_frame_index_ >= 0 && last_frame_index_ < frame_index &&
+        (!have_checkpoint || checkpoint.frame_index <= last_frame_index_)) {
+        return last_frame_index_ + 1;
+    }
+    
+    if (have_checkpoint) {
+        restore(checkpoint);
+        return checkpoint.frame_index + 1;
+    }
+    
+    // Nothing earlier is known: start fresh with just enough frames to confirm tracks
+    resetTracks();
+    return std::max(0, frame_index - min_hits_);
+}
+
+bool DetectionTracker::trackCachedFrame(int frame_index, std::vector<TrackedObject>* objects) {
+    std::vector<DetectionResult> candidates;
+    if (!candidate_cache_.lookup(frame_index, candidates)) {
+        return false;
+    }
+    
+    updateTracksFromResults(filterCandidates(candidates));
+    finishFrame(frame_index);
+    if (objects) {
+        *objects = collectTrackedObjects();
+    }
+    return true;
+}
+
 std::vector<Detection> DetectionTracker::detectObjects(const cv::Mat& frame) {
     try {
         std::vector<Detection> detections;
@@ -186,140 +394,572 @@ std::vector<Detection> DetectionTracker::detectObjects(const cv::Mat& frame) {
             return detections;
         }
         
-        std::cout << "Frame size: " << frame.size() << ", confidence threshold: " << conf_threshold_ << std::endl;
+        if (tiled_inference_) {
+            return detectObjectsTiled(frame);
+        }
         
         // Preprocess frame
-        cv::Mat blob = preprocessFrame(frame);
+        auto stage_start = std::chrono::high_resolution_clock::now();
+        cv::Mat blob;
+        {
+            TraceSpan span("preprocess", current_frame_index_);
+            blob = preprocessFrame(frame, descriptor_.input_size);
+        }
+        auto preprocess_end = std::chrono::high_resolution_clock::now();
         
         // Run inference
-        yolo_net_.setInput(blob);
         std::vector<cv::Mat> outputs;
-        yolo_net_.forward(outputs, yolo_net_.getUnconnectedOutLayersNames());
-        
-        // Check if we got valid output
-        if (outputs.empty() || outputs[0].empty()) {
-            std::cerr << "Warning: No valid output from YOLO model" << std::endl;
-            return detections;
+        {
+            TraceSpan span("inference", current_frame_index_);
+            yolo_net_.setInput(blob);
+            yolo_net_.forward(outputs, yolo_net_.getUnconnectedOutLayersNames());
         }
+        auto forward_end = std::chrono::high_resolution_clock::now();
         
-        std::cout << "Model output shape: " << outputs[0].size() << std::endl;
-        
-        // Postprocess detections with confidence and class info
-        auto detection_results = postprocessDetectionsWithInfo(outputs[0], frame.size());
-        
-        std::cout << "Raw detection results: " << detection_results.size() << std::endl;
-        
-        // Convert to Detection objects
-        for (const auto& result : detection_results) {
-            Detection det;
-            det.bbox = result.box;
-            det.confidence = result.confidence;
-            det.class_id = result.class_id;
-            det.class_name = (result.class_id < class_names_.size()) ? 
-                            class_names_[result.class_id] : "unknown";
-            detections.push_back(det);
-            std::cout << "Detection: " << det.class_name << " (conf: " << det.confidence 
-                     << ") at " << det.bbox << std::endl;
+        std::vector<Detection> decoded;
+        {
+            TraceSpan span("postprocess", current_frame_index_);
+            decoded = decodeDetections(outputs, frame);
         }
-        
-        return detections;
+        metrics_.preprocess_ms->observe(std::chrono::duration<double, std::milli>(preprocess_end - stage_start).count());
+        metrics_.inference_ms->observe(std::chrono::duration<double, std::milli>(forward_end - preprocess_end).count());
+        metrics_.postprocess_ms->observe(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - forward_end).count());
+        return decoded;
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error in detectObjects: " << e.what() << std::endl;
+        recordDroppedFrame();
         return std::vector<Detection>();
     } catch (const std::exception& e) {
         std::cerr << "Error in detectObjects: " << e.what() << std::endl;
+        recordDroppedFrame();
         return std::vector<Detection>();
     } catch (...) {
         std::cerr << "Unknown error in detectObjects" << std::endl;
+        recordDroppedFrame();
         return std::vector<Detection>();
     }
 }
 
-cv::Mat DetectionTracker::preprocessFrame(const cv::Mat& frame) {
-    // Use pre-allocated buffer for better performance
-    cv::resize(frame, processed_buffer_, cv::Size(640, 640));
-    
-    // Convert to blob using pre-allocated buffer
-    cv::Mat blob = cv::dnn::blobFromImage(processed_buffer_, 1.0/255.0, cv::Size(640, 640), 
-                                         cv::Scalar(0, 0, 0), true, false);
-    return blob;
+bool DetectionTracker::gateAllowsInference(const cv::Mat& frame) {
+    if (!motion_gating_) {
+        return true;
+    }
+    return motion_gate_.shouldRunInference(frame, !tracks_.empty());
 }
 
-std::vector<cv::Rect> DetectionTracker::postprocessDetections(const cv::Mat& output, 
-                                                             const cv::Size& original_size) {
-    std::vector<cv::Rect> boxes;
+bool DetectionTracker::enableAttributeClassification(const std::string& model_path) {
+    attributes_enabled_ = attribute_classifier_.initialize(model_path);
+    return attributes_enabled_;
+}
+
+bool DetectionTracker::isDetectionFrame(int frame_index) {
+    if (detection_interval_ <= 1) {
+        return true;
+    }
+    // Indexed frames use a fixed phase so replays after a seek match playback
+    if (frame_index >= 0) {
+        return frame_index % detection_interval_ == 0;
+    }
+    bool detect = frames_since_detection_ == 0;
+    frames_since_detection_ = (frames_since_detection_ + 1) % detection_interval_;
+    return detect;
+}
+
+void DetectionTracker::setDetectionInterval(int frames) {
+    detection_interval_ = std::max(1, frames);
+    frames_since_detection_ = 0;
+    std::cout << "Detection interval set to every " << detection_interval_ << " frame(s)" << std::endl;
+}
+
+void DetectionTracker::propagateTracks(const std::vector<MotionVector>& vectors) {
+    propagated_frames_++;
     
-    if (output.empty() || original_size.width <= 0 || original_size.height <= 0) {
-        // Fallback to dummy detections if no model output
-        boxes.push_back(cv::Rect(100, 100, 200, 150));
-        boxes.push_back(cv::Rect(300, 200, 180, 120));
-        boxes.push_back(cv::Rect(500, 150, 160, 100));
-        return boxes;
+    std::vector<float> dx, dy;
+    for (auto& track : tracks_) {
+        cv::Rect box = track->getBBox();
+        dx.clear();
+        dy.clear();
+        for (const auto& mv : vectors) {
+            if (box.contains(cv::Point(static_cast<int>(mv.position.x), static_cast<int>(mv.position.y)))) {
+                dx.push_back(mv.motion.x);
+                dy.push_back(mv.motion.y);
+            }
+        }
+        
+        propagated_boxes_++;
+        // A few blocks are not enough to tell the object's motion from noise
+        if (dx.size() < 3) {
+            track->predict();
+            continue;
+        }
+        
+        // Median is robust to background blocks and outliers inside the box
+        size_t mid = dx.size() / 2;
+        std::nth_element(dx.begin(), dx.begin() + mid, dx.end());
+        std::nth_element(dy.begin(), dy.begin() + mid, dy.end());
+        track->shift(cv::Point2f(dx[mid], dy[mid]));
+        mv_propagated_boxes_++;
+    }
+}
+
+void DetectionTracker::enableMotionGating(bool enable) {
+    if (enable && !motion_gating_) {
+        motion_gate_.reset();
+    }
+    motion_gating_ = enable;
+    std::cout << "Motion-gated inference " << (enable ? "enabled" : "disabled") << std::endl;
+}
+
+void DetectionTracker::enableTiledInference(bool enable, int grid_cols, int grid_rows) {
+    tiled_inference_ = enable;
+    tile_cols_ = std::max(1, grid_cols);
+    tile_rows_ = std::max(1, grid_rows);
+    tile_reference_.release();
+    tile_candidates_.assign(tile_cols_ * tile_rows_, std::vector<DetectionResult>());
+    frames_since_full_ = 0;
+    tiles_inferred_ = 0;
+    tiles_considered_ = 0;
+    std::cout << "Tiled inference " << (enable ? "enabled" : "disabled") << " ("
+              << tile_cols_ << "x" << tile_rows_ << " tiles)" << std::endl;
+}
+
+std::vector<cv::Rect> DetectionTracker::tileRects(const cv::Size& frame_size) const {
+    std::vector<cv::Rect> rects;
+    rects.reserve(tile_cols_ * tile_rows_);
+    for (int r = 0; r < tile_rows_; ++r) {
+        for (int c = 0; c < tile_cols_; ++c) {
+            int x0 = frame_size.width * c / tile_cols_;
+            int x1 = frame_size.width * (c + 1) / tile_cols_;
+            int y0 = frame_size.height * r / tile_rows_;
+            int y1 = frame_size.height * (r + 1) / tile_rows_;
+            rects.push_back(cv::Rect(x0, y0, x1 - x0, y1 - y0));
+        }
+    }
+    return rects;
+}
+
+void DetectionTracker::assignCandidatesToTiles(const std::vector<DetectionResult>& candidates,
+                                               const cv::Size& frame_size, const std::vector<int>& tiles) {
+    std::vector<cv::Rect> rects = tileRects(frame_size);
+    for (int t : tiles) {
+        tile_candidates_[t].clear();
+    }
+    // A box belongs to the tile containing its center
+    for (const auto& candidate : candidates) {
+        cv::Point center(candidate.box.x + candidate.box.width / 2, candidate.box.y + candidate.box.height / 2);
+        for (int t : tiles) {
+            if (rects[t].contains(center)) {
+                tile_candidates_[t].push_back(candidate);
+                break;
+            }
+        }
+    }
+}
+
+std::vector<Detection> DetectionTracker::detectObjectsTiled(const cv::Mat& frame) {
+    TraceSpan span("detectTiled", current_frame_index_);
+    const int tile_count = tile_cols_ * tile_rows_;
+    if (static_cast<int>(tile_candidates_.size()) != tile_count) {
+        tile_candidates_.assign(tile_count, std::vector<DetectionResult>());
     }
     
-    // YOLOv8 output format: [batch, 84, 8400] where 84 = 4 (bbox) + 80 (classes)
-    // Transpose to [8400, 84] for easier processing
-    cv::Mat transposed;
-    cv::transpose(output.reshape(1, output.total()), transposed);
+    cv::Mat small = MotionGate::makeChangeImage(frame, 160);
+    std::vector<cv::Rect> rects = tileRects(frame.size());
+    std::vector<int> all_tiles(tile_count);
+    for (int t = 0; t < tile_count; ++t) {
+        all_tiles[t] = t;
+    }
     
-    // Extract bounding boxes and class probabilities
-    std::vector<cv::Rect> detected_boxes;
-    std::vector<float> confidences;
-    std::vector<int> class_ids;
+    // Which tiles changed since they were last inferred
+    std::vector<int> changed;
+    bool full_frame = tile_reference_.empty() || tile_reference_.size() != small.size() ||
+                      ++frames_since_full_ >= full_frame_interval_;
+    if (!full_frame) {
+        cv::Mat diff;
+        cv::absdiff(small, tile_reference_, diff);
+        double sx = static_cast<double>(small.cols) / frame.cols;
+        double sy = static_cast<double>(small.rows) / frame.rows;
+        for (int t = 0; t < tile_count; ++t) {
+            cv::Rect small_rect(static_cast<int>(rects[t].x * sx), static_cast<int>(rects[t].y * sy),
+                                std::max(1, static_cast<int>(rects[t].width * sx)),
+                                std::max(1, static_cast<int>(rects[t].height * sy)));
+            small_rect &= cv::Rect(0, 0, diff.cols, diff.rows);
+            if (small_rect.area() > 0 && cv::mean(diff(small_rect))[0] > tile_change_threshold_) {
+                changed.push_back(t);
+            }
+        }
+        // Beyond half the tiles a single full pass is cheaper than a batch of crops
+        full_frame = static_cast<int>(changed.size()) * 2 > tile_count;
+    }
+    tiles_considered_ += tile_count;
     
-    for (int i = 0; i < transposed.rows; ++i) {
-        // Get class probabilities (last 80 values)
-        cv::Mat class_scores = transposed.row(i).colRange(4, 84);
-        cv::Point class_id;
-        double confidence;
-        cv::minMaxLoc(class_scores, nullptr, &confidence, nullptr, &class_id);
-        
-        // Filter for relevant classes (vehicles and people)
-        bool is_relevant_class = (class_id.x == 0) ||  // person
-                                (class_id.x == 1) ||  // bicycle
-                                (class_id.x == 2) ||  // car
-                                (class_id.x == 3) ||  // motorcycle
-                                (class_id.x == 5) ||  // bus
-                                (class_id.x == 7) ||  // truck
-                                (class_id.x == 8);    // boat
-        
-        // Apply confidence threshold and class filter
-        if (confidence > conf_threshold_ && is_relevant_class) {
-            // Get bounding box coordinates (first 4 values)
-            float* data = transposed.ptr<float>(i);
-            float x_center = data[0];
-            float y_center = data[1];
-            float width = data[2];
-            float height = data[3];
-            
-            // Convert from normalized coordinates to pixel coordinates
-            // YOLOv8 outputs are already normalized to 0-1 range
-            int x = static_cast<int>(x_center * original_size.width);
-            int y = static_cast<int>(y_center * original_size.height);
-            int w = static_cast<int>(width * original_size.width);
-            int h = static_cast<int>(height * original_size.height);
+    if (full_frame) {
+        cv::Mat blob = preprocessFrame(frame, descriptor_.input_size);
+        yolo_net_.setInput(blob);
+        std::vector<cv::Mat> outputs;
+        yolo_net_.forward(outputs, yolo_net_.getUnconnectedOutLayersNames());
+        if (!outputs.empty() && !outputs[0].empty()) {
+            assignCandidatesToTiles(extractCandidates(outputs[0], frame.size(), descriptor_), frame.size(), all_tiles);
+        }
+        tile_reference_ = small.clone();
+        frames_since_full_ = 0;
+        tiles_inferred_ += tile_count;
+    } else if (!changed.empty()) {
+        // Crops get a margin so objects straddling a tile edge are seen whole
+        std::vector<cv::Rect> crops;
+        for (int t : changed) {
+            int margin_x = rects[t].width / 4;
+            int margin_y = rects[t].height / 4;
+            cv::Rect crop(rects[t].x - margin_x, rects[t].y - margin_y,
+                          rects[t].width + 2 * margin_x, rects[t].height + 2 * margin_y);
+            crops.push_back(crop & cv::Rect(0, 0, frame.cols, frame.rows));
+        }
+        
+        size_t begin = 0;
+        while (begin < changed.size()) {
+            size_t end = std::min(changed.size(), begin + static_cast<size_t>(tile_batch_size_));
+            std::vector<cv::Mat> images;
+            for (size_t i = begin; i < end; ++i) {
+                images.push_back(frame(crops[i]));
+            }
             
-            // Ensure box is within image bounds
-            x = std::max(0, std::min(x, original_size.width - 1));
-            y = std::max(0, std::min(y, original_size.height - 1));
-            w = std::min(w, original_size.width - x);
-            h = std::min(h, original_size.height - y);
+            std::vector<cv::Mat> outputs;
+            try {
+                cv::Mat blob = cv::dnn::blobFromImages(images, 1.0/255.0, descriptor_.input_size,
+                                                       cv::Scalar(0, 0, 0), true, false);
+                yolo_net_.setInput(blob);
+                yolo_net_.forward(outputs, yolo_net_.getUnconnectedOutLayersNames());
+            } catch (const cv::Exception& e) {
+                if (images.size() == 1) {
+                    throw;
+                }
+                // Model exported with a fixed batch of 1: retry this batch crop by crop
+                std::cerr << "Batched tile inference failed, falling back to batch size 1" << std::endl;
+                tile_batch_size_ = 1;
+                continue;
+            }
             
-            if (w > 0 && h > 0) {
-                detected_boxes.push_back(cv::Rect(x, y, w, h));
-                confidences.push_back(static_cast<float>(confidence));
-                class_ids.push_back(class_id.x);
+            // Output is [batch, ...]; decode each image's slice as a batch of one
+            if (!outputs.empty() && !outputs[0].empty()) {
+                const cv::Mat& batch_output = outputs[0];
+                std::vector<int> slice_shape(batch_output.size.p, batch_output.size.p + batch_output.dims);
+                slice_shape[0] = 1;
+                for (size_t i = begin; i < end; ++i) {
+                    cv::Mat slice(static_cast<int>(slice_shape.size()), slice_shape.data(), CV_32F,
+                                  const_cast<float*>(batch_output.ptr<float>(static_cast<int>(i - begin))));
+                    std::vector<DetectionResult> candidates = extractCandidates(slice, crops[i].size(), descriptor_);
+                    for (auto& candidate : candidates) {
+                        candidate.box += crops[i].tl();
+                    }
+                    assignCandidatesToTiles(candidates, frame.size(), {changed[i]});
+                }
             }
+            begin = end;
+        }
+        
+        // Reference for re-inferred tiles moves to the current content
+        double sx = static_cast<double>(small.cols) / frame.cols;
+        double sy = static_cast<double>(small.rows) / frame.rows;
+        for (int t : changed) {
+            cv::Rect small_rect(static_cast<int>(rects[t].x * sx), static_cast<int>(rects[t].y * sy),
+                                std::max(1, static_cast<int>(rects[t].width * sx)),
+                                std::max(1, static_cast<int>(rects[t].height * sy)));
+            small_rect &= cv::Rect(0, 0, small.cols, small.rows);
+            small(small_rect).copyTo(tile_reference_(small_rect));
         }
+        tiles_inferred_ += changed.size();
     }
     
-    // Apply Non-Maximum Suppression
-    std::vector<int> indices;
-    cv::dnn::NMSBoxes(detected_boxes, confidences, conf_threshold_, nms_threshold_, indices);
+    // Static tiles contribute their previous candidates unchanged
+    std::vector<DetectionResult> candidates;
+    for (const auto& tile : tile_candidates_) {
+        candidates.insert(candidates.end(), tile.begin(), tile.end());
+    }
+    candidate_cache_.store(current_frame_index_, candidates);
+    
+    std::vector<Detection> detections;
+    for (const auto& result : filterCandidates(candidates)) {
+        Detection det;
+        det.bbox = result.box;
+        det.confidence = result.confidence;
+        det.class_id = result.class_id;
+        det.class_name = (result.class_id >= 0 && result.class_id < static_cast<int>(class_names_.size())) ?
+                        class_names_[result.class_id] : "unknown";
+        detections.push_back(det);
+    }
+    return detections;
+}
+
+std::vector<Detection> DetectionTracker::decodeDetections(const std::vector<cv::Mat>& outputs,
+                                                          const cv::Mat& frame) {
+    std::vector<Detection> detections;
+    
+    // Check if we got valid output
+    if (outputs.empty() || outputs[0].empty()) {
+        std::cerr << "Warning: No valid output from YOLO model" << std::endl;
+        return detections;
+    }
+    
+    // Postprocess detections with confidence and class info
+    bool cascade = cascade_enabled_ && !secondary_suspended_;
+    auto detection_results = cascade ? cascadeDetections(outputs[0], frame) :
+                                       postprocessDetectionsWithInfo(outputs[0], frame.size());
+    
+    // Convert to Detection objects
+    for (const auto& result : detection_results) {
+        Detection det;
+        det.bbox = result.box;
+        det.confidence = result.confidence;
+        det.class_id = result.class_id;
+        det.class_name = (result.class_id >= 0 && result.class_id < static_cast<int>(class_names_.size())) ?
+                        class_names_[result.class_id] : "unknown";
+        detections.push_back(det);
+    }
     
-    // Return filtered boxes
+    return detections;
+}
+
+bool DetectionTracker::enableCascade(const std::string& refine_model_path, int refine_input_size) {
+    try {
+        refine_net_ = cv::dnn::readNetFromONNX(refine_model_path);
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error loading cascade model: " << e.what() << std::endl;
+        refine_net_ = cv::dnn::Net();
+    }
+    if (refine_net_.empty()) {
+        std::cerr << "Failed to load cascade model from: " << refine_model_path << std::endl;
+        cascade_enabled_ = false;
+        return false;
+    }
+    
+    refine_net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    refine_net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    refine_input_size_ = std::max(32, refine_input_size / 32 * 32);
+    refine_descriptor_ = ModelOutputDescriptor::fromOnnxFile(refine_model_path);
+    refine_descriptor_.input_size = cv::Size(refine_input_size_, refine_input_size_);
+    cascade_batch_size_ = 4;
+    cascade_enabled_ = true;
+    std::cout << "Cascade enabled with " << refine_model_path << " at " << refine_input_size_ << "px" << std::endl;
+    return true;
+}
+
+void DetectionTracker::setCascadeBudget(int max_crops_per_frame, double max_ms_per_frame) {
+    cascade_max_crops_ = std::max(0, max_crops_per_frame);
+    cascade_max_ms_ = std::max(0.0, max_ms_per_frame);
+}
+
+std::vector<DetectionResult> DetectionTracker::cascadeDetections(const cv::Mat& output, const cv::Mat& frame) {
+    TraceSpan span("cascade", current_frame_index_);
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    std::vector<DetectionResult> candidates = extractCandidates(output, frame.size(), descriptor_);
+    std::vector<DetectionResult> results = filterCandidates(candidates);
+    
+    std::vector<cv::Rect> regions = selectCascadeRegions(candidates, results);
+    if (!regions.empty()) {
+        candidates = refineRegions(frame, regions, candidates);
+        results = filterCandidates(candidates);
+    }
+    
+    // The merged candidates are what later re-thresholding should see
+    candidate_cache_.store(current_frame_index_, candidates);
+    
+    double elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    cascade_time_ms_ = 0.9 * cascade_time_ms_ + 0.1 * elapsed;
+    cascade_crops_per_frame_ = 0.9 * cascade_crops_per_frame_ + 0.1 * regions.size();
+    return results;
+}
+
+std::vector<cv::Rect> DetectionTracker::selectCascadeRegions(const std::vector<DetectionResult>& candidates,
+                                                             const std::vector<DetectionResult>& results) {
+    std::vector<cv::Rect> regions;
+    auto add_region = [&](const cv::Rect& box) {
+        if (static_cast<int>(regions.size()) >= cascade_max_crops_) {
+            return;
+        }
+        for (const auto& region : regions) {
+            if (calculateIOU(region, box) > 0.5f) {
+                return;
+            }
+        }
+        regions.push_back(box);
+    };
+    
+    // 1. Accepted boxes that a different class also claims
+    for (const auto& result : results) {
+        for (const auto& candidate : candidates) {
+            if (candidate.class_id != result.class_id && candidate.confidence >= cascade_low_conf_ &&
+                isClassEnabled(candidate.class_id) && calculateIOU(candidate.box, result.box) > 0.5f) {
+                add_region(result.box | candidate.box);
+                break;
+            }
+        }
+    }
+    
+    // 2. Objects the small model saw but was not sure about
+    std::vector<cv::Rect> uncertain_boxes;
+    std::vector<float> uncertain_scores;
+    for (const auto& candidate : candidates) {
+        if (candidate.confidence >= cascade_low_conf_ && candidate.confidence <= conf_threshold_ &&
+            isClassEnabled(candidate.class_id)) {
+            uncertain_boxes.push_back(candidate.box);
+            uncertain_scores.push_back(candidate.confidence);
+        }
+    }
+    std::vector<int> indices;
+    cv::dnn::NMSBoxes(uncertain_boxes, uncertain_scores, cascade_low_conf_, nms_threshold_, indices);
     for (int idx : indices) {
-        boxes.push_back(detected_boxes[idx]);
+        bool covered = false;
+        for (const auto& result : results) {
+            if (calculateIOU(uncertain_boxes[idx], result.box) > 0.3f) {
+                covered = true;
+                break;
+            }
+        }
+        if (!covered) {
+            add_region(uncertain_boxes[idx]);
+        }
+    }
+    
+    // 3. Accepted boxes that would start a new track
+    for (const auto& result : results) {
+        bool tracked = false;
+        for (const auto& track : tracks_) {
+            if (calculateIOU(track->getBBox(), result.box) > 0.3f) {
+                tracked = true;
+                break;
+            }
+        }
+        if (!tracked) {
+            add_region(result.box);
+        }
+    }
+    
+    return regions;
+}
+
+std::vector<DetectionResult> DetectionTracker::refineRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                                                             const std::vector<DetectionResult>& candidates) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    
+    // Square crops with context around each region, at least a few model strides wide
+    std::vector<cv::Rect> crops;
+    for (const auto& region : regions) {
+        int side = std::max(64, static_cast<int>(std::max(region.width, region.height) * 1.5f));
+        cv::Point center(region.x + region.width / 2, region.y + region.height / 2);
+        crops.push_back(cv::Rect(center.x - side / 2, center.y - side / 2, side, side) & bounds);
+    }
+    
+    std::vector<bool> refined(regions.size(), false);
+    std::vector<DetectionResult> refined_candidates;
+    size_t begin = 0;
+    while (begin < regions.size()) {
+        // Remaining regions wait for a later frame once the time budget is spent
+        double elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        if (begin > 0 && elapsed > cascade_max_ms_) {
+            break;
+        }
+        
+        size_t end = std::min(regions.size(), begin + static_cast<size_t>(cascade_batch_size_));
+        std::vector<cv::Mat> images;
+        for (size_t i = begin; i < end; ++i) {
+            images.push_back(frame(crops[i]));
+        }
+        
+        std::vector<cv::Mat> outputs;
+        try {
+            cv::Mat blob = cv::dnn::blobFromImages(images, 1.0/255.0, cv::Size(refine_input_size_, refine_input_size_),
+                                                   cv::Scalar(0, 0, 0), true, false);
+            refine_net_.setInput(blob);
+            refine_net_.forward(outputs, refine_net_.getUnconnectedOutLayersNames());
+        } catch (const cv::Exception& e) {
+            if (images.size() == 1) {
+                std::cerr << "OpenCV error in cascade refinement: " << e.what() << std::endl;
+                break;
+            }
+            std::cerr << "Batched cascade inference failed, falling back to batch size 1" << std::endl;
+            cascade_batch_size_ = 1;
+            continue;
+        }
+        
+        if (!outputs.empty() && !outputs[0].empty()) {
+            const cv::Mat& batch_output = outputs[0];
+            std::vector<int> slice_shape(batch_output.size.p, batch_output.size.p + batch_output.dims);
+            slice_shape[0] = 1;
+            for (size_t i = begin; i < end; ++i) {
+                cv::Mat slice(static_cast<int>(slice_shape.size()), slice_shape.data(), CV_32F,
+                              const_cast<float*>(batch_output.ptr<float>(static_cast<int>(i - begin))));
+                for (auto candidate : extractCandidates(slice, crops[i].size(), refine_descriptor_)) {
+                    candidate.box += crops[i].tl();
+                    // Only the object the region was about; the rest of the crop is the primary's
+                    if (calculateIOU(candidate.box, regions[i]) > 0.3f) {
+                        refined_candidates.push_back(candidate);
+                    }
+                }
+                refined[i] = true;
+            }
+        }
+        begin = end;
+    }
+    
+    // An end-to-end primary means the merged set skips NMS, so a refiner
+    // with a raw head has to be deduplicated here
+    if (descriptor_.nms_included && !refine_descriptor_.nms_included && !refined_candidates.empty()) {
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        for (const auto& candidate : refined_candidates) {
+            boxes.push_back(candidate.box);
+            scores.push_back(candidate.confidence);
+        }
+        std::vector<int> indices;
+        cv::dnn::NMSBoxes(boxes, scores, 0.0f, nms_threshold_, indices);
+        std::vector<DetectionResult> kept;
+        for (int idx : indices) {
+            kept.push_back(refined_candidates[idx]);
+        }
+        refined_candidates.swap(kept);
+    }
+    
+    // The larger model's view replaces the primary's inside refined regions
+    std::vector<DetectionResult> merged;
+    merged.reserve(candidates.size() + refined_candidates.size());
+    for (const auto& candidate : candidates) {
+        bool replaced = false;
+        for (size_t i = 0; i < regions.size() && !replaced; ++i) {
+            replaced = refined[i] && calculateIOU(candidate.box, regions[i]) > 0.5f;
+        }
+        if (!replaced) {
+            merged.push_back(candidate);
+        }
+    }
+    merged.insert(merged.end(), refined_candidates.begin(), refined_candidates.end());
+    return merged;
+}
+
+cv::Mat DetectionTracker::preprocessFrame(const cv::Mat& frame, const cv::Size& input_size) {
+    // Use pre-allocated buffer for better performance
+    cv::resize(frame, processed_buffer_, input_size);
+    
+    // Convert to blob using pre-allocated buffer
+    cv::Mat blob = cv::dnn::blobFromImage(processed_buffer_, 1.0/255.0, input_size, 
+                                         cv::Scalar(0, 0, 0), true, false);
+    return blob;
+}
+
+std::vector<cv::Rect> DetectionTracker::postprocessDetections(const cv::Mat& output, 
+                                                             const cv::Size& original_size) {
+    std::vector<cv::Rect> boxes;
+    
+    if (output.empty() || original_size.width <= 0 || original_size.height <= 0) {
+        return boxes;
+    }
+    
+    for (const auto& result : filterCandidates(extractCandidates(output, original_size, descriptor_))) {
+        boxes.push_back(result.box);
     }
     
     return boxes;
@@ -330,96 +970,148 @@ std::vector<DetectionResult> DetectionTracker::postprocessDetectionsWithInfo(con
     std::vector<DetectionResult> results;
     
     if (output.empty() || original_size.width <= 0 || original_size.height <= 0) {
-        // Fallback to dummy detections if no model output
-        results.push_back({cv::Rect(100, 100, 200, 150), 0.8f, 0});
-        results.push_back({cv::Rect(300, 200, 180, 120), 0.7f, 0});
-        results.push_back({cv::Rect(500, 150, 160, 100), 0.6f, 0});
         return results;
     }
     
-    std::cout << "Output shape: " << output.size() << std::endl;
+    // Keep every candidate above the cache floor so thresholds can change later
+    std::vector<DetectionResult> candidates = extractCandidates(output, original_size, descriptor_);
+    candidate_cache_.store(current_frame_index_, candidates);
+    
+    return filterCandidates(candidates);
+}
+
+std::vector<DetectionResult> DetectionTracker::extractCandidates(const cv::Mat& output,
+                                                                 const cv::Size& original_size,
+                                                                 ModelOutputDescriptor& descriptor) {
+    std::vector<DetectionResult> candidates;
+    
+    if (output.empty() || output.dims < 2 || output.type() != CV_32F) {
+        return candidates;
+    }
+    if (!descriptor.resolved) {
+        if (!descriptor.resolveFromShape(output)) {
+            std::cerr << "Model output shape does not match descriptor (" << descriptor.describe()
+                      << "); set one with setModelDescriptor" << std::endl;
+            return candidates;
+        }
+        std::cout << "Decoding model output as " << descriptor.describe() << std::endl;
+    }
+    
+    // View the (possibly batched-of-one) output as values x anchors or anchors x values
+    const int rows = output.size[output.dims - 2];
+    const int cols = output.size[output.dims - 1];
+    const bool channel_major = descriptor.layout == OutputLayout::ChannelMajor;
+    const int anchors = channel_major ? cols : rows;
+    const int values = channel_major ? rows : cols;
+    if (values < descriptor.valuesPerAnchor()) {
+        return candidates;
+    }
+    const float* data = output.ptr<float>();
+    auto at = [&](int anchor, int value) {
+        return channel_major ? data[static_cast<size_t>(value) * anchors + anchor] :
+                               data[static_cast<size_t>(anchor) * values + value];
+    };
     
-    // Handle different output formats
-    cv::Mat processed_output;
-    if (output.size() == cv::Size(84, 1)) {
-        // Single detection output - reshape to standard format
-        processed_output = output.reshape(1, 1);
-        std::cout << "Single detection format detected" << std::endl;
-    } else if (output.size() == cv::Size(1, 84)) {
-        // Transposed single detection
-        processed_output = output.t();
-        std::cout << "Transposed single detection format detected" << std::endl;
+    // Best class per anchor. Channel-major outputs are scanned a class row at a
+    // time so memory is read sequentially.
+    std::vector<float> scores(anchors, 0.0f);
+    std::vector<int> classes(anchors, 0);
+    if (descriptor.nms_included) {
+        for (int i = 0; i < anchors; ++i) {
+            scores[i] = at(i, 4);
+            classes[i] = static_cast<int>(at(i, 5));
+        }
     } else {
-        // Try standard YOLOv8 format
-        processed_output = output.reshape(1, output.total() / 84);
-        std::cout << "Standard YOLOv8 format detected" << std::endl;
+        const int first_class = 4 + (descriptor.has_objectness ? 1 : 0);
+        if (channel_major) {
+            for (int c = 0; c < descriptor.num_classes; ++c) {
+                const float* row = data + static_cast<size_t>(first_class + c) * anchors;
+                for (int i = 0; i < anchors; ++i) {
+                    if (row[i] > scores[i]) {
+                        scores[i] = row[i];
+                        classes[i] = c;
+                    }
+                }
+            }
+        } else {
+            for (int i = 0; i < anchors; ++i) {
+                const float* row = data + static_cast<size_t>(i) * values + first_class;
+                const float* best = std::max_element(row, row + descriptor.num_classes);
+                scores[i] = *best;
+                classes[i] = static_cast<int>(best - row);
+            }
+        }
+        if (descriptor.has_objectness) {
+            for (int i = 0; i < anchors; ++i) {
+                scores[i] *= at(i, 4);
+            }
+        }
     }
     
-    // Extract bounding boxes and class probabilities
+    // Boxes are relative to the network input (or 0-1); the frame was resized, not letterboxed
+    const float scale_x = descriptor.normalized ? original_size.width :
+                          static_cast<float>(original_size.width) / descriptor.input_size.width;
+    const float scale_y = descriptor.normalized ? original_size.height :
+                          static_cast<float>(original_size.height) / descriptor.input_size.height;
+    const float floor = candidate_cache_.getScoreFloor();
+    
+    for (int i = 0; i < anchors; ++i) {
+        // Class filtering happens later so it can be changed without re-inference
+        if (scores[i] < floor) {
+            continue;
+        }
+        
+        float x1, y1, x2, y2;
+        if (descriptor.box_format == BoxFormat::CenterSize) {
+            x1 = at(i, 0) - at(i, 2) / 2.0f;
+            y1 = at(i, 1) - at(i, 3) / 2.0f;
+            x2 = at(i, 0) + at(i, 2) / 2.0f;
+            y2 = at(i, 1) + at(i, 3) / 2.0f;
+        } else {
+            x1 = at(i, 0);
+            y1 = at(i, 1);
+            x2 = at(i, 2);
+            y2 = at(i, 3);
+        }
+        
+        int x = std::max(0, static_cast<int>(x1 * scale_x));
+        int y = std::max(0, static_cast<int>(y1 * scale_y));
+        int w = std::min(static_cast<int>(x2 * scale_x), original_size.width) - x;
+        int h = std::min(static_cast<int>(y2 * scale_y), original_size.height) - y;
+        
+        if (w > 0 && h > 0) {
+            candidates.push_back({cv::Rect(x, y, w, h), scores[i], classes[i]});
+        }
+    }
+    
+    return candidates;
+}
+
+std::vector<DetectionResult> DetectionTracker::filterCandidates(const std::vector<DetectionResult>& candidates) {
+    std::vector<DetectionResult> results;
+    
+    // Apply confidence threshold and class filter
     std::vector<cv::Rect> detected_boxes;
     std::vector<float> confidences;
     std::vector<int> class_ids;
     
-    for (int i = 0; i < processed_output.rows; ++i) {
-        // Get class probabilities (last 80 values)
-        cv::Mat class_scores = processed_output.row(i).colRange(4, 84);
-        cv::Point class_id;
-        double confidence;
-        cv::minMaxLoc(class_scores, nullptr, &confidence, nullptr, &class_id);
-        
-        // Normalize confidence to 0-1 range if it's too high
-        if (confidence > 1.0) {
-            confidence = confidence / 1000.0; // Scale down if needed
-        }
-        
-        std::cout << "Raw confidence: " << confidence << " for class " << class_id.x << std::endl;
-        
-        // Filter for relevant classes (vehicles and people)
-        bool is_relevant_class = (class_id.x == 0) ||  // person
-                                (class_id.x == 1) ||  // bicycle
-                                (class_id.x == 2) ||  // car
-                                (class_id.x == 3) ||  // motorcycle
-                                (class_id.x == 5) ||  // bus
-                                (class_id.x == 7) ||  // truck
-                                (class_id.x == 8);    // boat
-        
-        // Apply confidence threshold and class filter
-        if (confidence > conf_threshold_ && is_relevant_class) {
-            // Get bounding box coordinates (first 4 values)
-            float* data = processed_output.ptr<float>(i);
-            float x_center = data[0];
-            float y_center = data[1];
-            float width = data[2];
-            float height = data[3];
-            
-            std::cout << "Raw bbox: center(" << x_center << "," << y_center << ") size(" << width << "," << height << ")" << std::endl;
-            
-            // Convert from normalized coordinates to pixel coordinates
-            // YOLOv8 outputs are already normalized to 0-1 range
-            int x = static_cast<int>(x_center * original_size.width);
-            int y = static_cast<int>(y_center * original_size.height);
-            int w = static_cast<int>(width * original_size.width);
-            int h = static_cast<int>(height * original_size.height);
-            
-            std::cout << "Pixel bbox: (" << x << "," << y << "," << w << "," << h << ")" << std::endl;
-            
-            // Ensure box is within image bounds
-            x = std::max(0, std::min(x, original_size.width - 1));
-            y = std::max(0, std::min(y, original_size.height - 1));
-            w = std::min(w, original_size.width - x);
-            h = std::min(h, original_size.height - y);
-            
-            if (w > 0 && h > 0) {
-                detected_boxes.push_back(cv::Rect(x, y, w, h));
-                confidences.push_back(static_cast<float>(confidence));
-                class_ids.push_back(class_id.x);
-            }
+    for (const auto& candidate : candidates) {
+        if (candidate.confidence > conf_threshold_ && isClassEnabled(candidate.class_id)) {
+            detected_boxes.push_back(candidate.box);
+            confidences.push_back(candidate.confidence);
+            class_ids.push_back(candidate.class_id);
         }
     }
     
-    // Apply Non-Maximum Suppression
+    // Apply Non-Maximum Suppression, unless the model already did
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(detected_boxes, confidences, conf_threshold_, nms_threshold_, indices);
+    if (descriptor_.nms_included) {
+        for (int i = 0; i < static_cast<int>(detected_boxes.size()); ++i) {
+            indices.push_back(i);
+        }
+    } else {
+        cv::dnn::NMSBoxes(detected_boxes, confidences, conf_threshold_, nms_threshold_, indices);
+    }
     
     // Return filtered results with info
     for (int idx : indices) {
@@ -430,18 +1122,389 @@ std::vector<DetectionResult> DetectionTracker::postprocessDetectionsWithInfo(con
         results.push_back(result);
     }
     
-    // Update tracking with current detections
-    updateTracksFromResults(results);
+    return results;
+}
+
+bool DetectionTracker::reprocessCachedFrame(int frame_index, const std::vector<TrackedObject>& previous,
+                                            std::vector<TrackedObject>& objects) {
+    std::vector<DetectionResult> candidates;
+    if (!candidate_cache_.lookup(frame_index, candidates)) {
+        return false;
+    }
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<DetectionResult> results = filterCandidates(candidates);
     
-    // If no detections found, add some dummy detections for testing
-    if (results.empty()) {
-        std::cout << "No detections found, adding dummy detections for testing" << std::endl;
-        results.push_back({cv::Rect(200, 300, 150, 100), 0.8f, 2}); // car
-        results.push_back({cv::Rect(400, 250, 120, 80), 0.7f, 0});  // person
-        results.push_back({cv::Rect(600, 350, 180, 120), 0.6f, 7}); // truck
+    objects.clear();
+    for (const auto& result : results) {
+        TrackedObject obj;
+        obj.track_id = -1;
+        obj.bbox = result.box;
+        obj.confidence = result.confidence;
+        obj.class_id = result.class_id;
+        obj.class_name = (result.class_id >= 0 && result.class_id < static_cast<int>(class_names_.size())) ?
+                        class_names_[result.class_id] : "unknown";
+        obj.age = 0;
+        obj.total_hits = 0;
+        obj.time_since_update = 0;
+        
+        // Keep the identity of whichever object this box was before the change
+        float best_iou = 0.3f;
+        for (const auto& prev : previous) {
+            float iou = calculateIOU(result.box, prev.bbox);
+            if (iou > best_iou) {
+                best_iou = iou;
+                obj.track_id = prev.track_id;
+                obj.age = prev.age;
+                obj.total_hits = prev.total_hits;
+                obj.color = prev.color;
+                obj.vehicle_type = prev.vehicle_type;
+                obj.attribute_confidence = prev.attribute_confidence;
+            }
+        }
+        objects.push_back(obj);
     }
     
-    return results;
+    auto end_time = std::chrono::high_resolution_clock::now();
+    detection_time_ms_ = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    return true;
+}
+
+void DetectionTracker::setClassFilter(const std::vector<int>& class_ids) {
+    class_filter_ = class_ids;
+    checkpoints_.clear();
+    class_filter_mask_.assign(class_names_.empty() ? 80 : class_names_.size(), false);
+    for (int id : class_ids) {
+        if (id >= 0) {
+            if (id >= static_cast<int>(class_filter_mask_.size())) {
+                class_filter_mask_.resize(id + 1, false);
+            }
+            class_filter_mask_[id] = true;
+        }
+    }
+}
+
+bool DetectionTracker::isClassEnabled(int class_id) const {
+    return class_id >= 0 && class_id < static_cast<int>(class_filter_mask_.size()) &&
+           class_filter_mask_[class_id];
+}
+
+void DetectionTracker::setPipelineDepth(int depth) {
+    depth = std::max(1, std::min(depth, 8));
+    if (depth == pipeline_depth_) {
+        return;
+    }
+    
+    // Drain whatever is in flight; those frames are still tracked
+    std::vector<PipelineResult> pending;
+    flushPipeline(pending);
+    
+    pipeline_depth_ = depth;
+    if (depth > 1) {
+        startPipeline();
+    } else {
+        stopPipeline();
+    }
+    std::cout << "Pipeline depth set to: " << depth << std::endl;
+}
+
+void DetectionTracker::startPipeline() {
+    if (preprocess_thread_.joinable()) {
+        return;
+    }
+    pipeline_stop_ = false;
+    preprocess_thread_ = std::thread(&DetectionTracker::preprocessWorker, this);
+    inference_thread_ = std::thread(&DetectionTracker::inferenceWorker, this);
+}
+
+void DetectionTracker::stopPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(pipeline_mutex_);
+        pipeline_stop_ = true;
+    }
+    pipeline_cv_.notify_all();
+    if (preprocess_thread_.joinable()) {
+        preprocess_thread_.join();
+    }
+    if (inference_thread_.joinable()) {
+        inference_thread_.join();
+    }
+    
+    std::lock_guard<std::mutex> lock(pipeline_mutex_);
+    preprocess_queue_.clear();
+    inference_queue_.clear();
+    completed_queue_.clear();
+    pipeline_in_flight_ = 0;
+    publishQueueDepths();
+}
+
+void DetectionTracker::preprocessWorker() {
+    setCurrentThreadName("dt-preprocess");
+    while (true) {
+        std::unique_ptr<PipelineJob> job;
+        {
+            std::unique_lock<std::mutex> lock(pipeline_mutex_);
+            pipeline_cv_.wait(lock, [this]() { return pipeline_stop_ || !preprocess_queue_.empty(); });
+            if (pipeline_stop_) {
+                return;
+            }
+            job = std::move(preprocess_queue_.front());
+            preprocess_queue_.pop_front();
+            publishQueueDepths();
+        }
+        TraceRecorder::global().record("wait:preprocess", job->enqueued_us, TraceRecorder::nowMicros(), job->frame_index);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!job->skip_inference) {
+            TraceSpan span("preprocess", job->frame_index);
+            try {
+                job->blob = preprocessFrame(job->frame, job->input_size);
+            } catch (const cv::Exception& e) {
+                std::cerr << "OpenCV error in pipeline preprocessing: " << e.what() << std::endl;
+                job->failed = true;
+            }
+        }
+        job->preprocess_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        
+        {
+            std::lock_guard<std::mutex> lock(pipeline_mutex_);
+            job->enqueued_us = TraceRecorder::nowMicros();
+            inference_queue_.push_back(std::move(job));
+            publishQueueDepths();
+        }
+        pipeline_cv_.notify_all();
+    }
+}
+
+void DetectionTracker::inferenceWorker() {
+    setCurrentThreadName("dt-inference");
+    while (true) {
+        std::unique_ptr<PipelineJob> job;
+        {
+            std::unique_lock<std::mutex> lock(pipeline_mutex_);
+            pipeline_cv_.wait(lock, [this]() { return pipeline_stop_ || !inference_queue_.empty(); });
+            if (pipeline_stop_) {
+                return;
+            }
+            job = std::move(inference_queue_.front());
+            inference_queue_.pop_front();
+            publishQueueDepths();
+        }
+        TraceRecorder::global().record("wait:inference", job->enqueued_us, TraceRecorder::nowMicros(), job->frame_index);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!job->failed && !job->skip_inference) {
+            TraceSpan span("inference", job->frame_index);
+            try {
+                job->net.setInput(job->blob);
+                job->net.forward(job->outputs, job->net.getUnconnectedOutLayersNames());
+            } catch (const cv::Exception& e) {
+                std::cerr << "OpenCV error in pipeline inference: " << e.what() << std::endl;
+                job->failed = true;
+            }
+        }
+        job->forward_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        
+        {
+            std::lock_guard<std::mutex> lock(pipeline_mutex_);
+            job->enqueued_us = TraceRecorder::nowMicros();
+            completed_queue_.push_back(std::move(job));
+            publishQueueDepths();
+        }
+        pipeline_cv_.notify_all();
+    }
+}
+
+bool DetectionTracker::processFramePipelined(const cv::Mat& frame, int frame_index, PipelineResult& result) {
+    // Without a pipeline (or a model) this is just processFrame
+    if (pipeline_depth_ <= 1 || yolo_net_.empty()) {
+        auto start = std::chrono::high_resolution_clock::now();
+        result.frame_index = frame_index;
+        result.frame = frame;
+        result.objects = processFrame(frame, frame_index);
+        result.latency_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        return true;
+    }
+    
+    auto job = std::make_unique<PipelineJob>();
+    job->frame_index = frame_index;
+    job->frame = frame.clone();  // callers typically reuse their capture buffer
+    job->failed = false;
+    job->propagate_only = !isDetectionFrame(frame_index);
+    job->skip_inference = job->propagate_only || !gateAllowsInference(frame);
+    job->motion_vectors = std::move(frame_motion_vectors_);
+    frame_motion_vectors_.clear();
+    job->preprocess_ms = 0.0;
+    job->forward_ms = 0.0;
+    job->submitted = std::chrono::high_resolution_clock::now();
+    job->enqueued_us = TraceRecorder::nowMicros();
+    adoptStagedModel(job.get());
+    job->net = yolo_net_;
+    job->input_size = incoming_model_ ? incoming_model_->descriptor.input_size : descriptor_.input_size;
+    
+    std::unique_ptr<PipelineJob> done;
+    {
+        std::unique_lock<std::mutex> lock(pipeline_mutex_);
+        preprocess_queue_.push_back(std::move(job));
+        pipeline_in_flight_++;
+        publishQueueDepths();
+        pipeline_cv_.notify_all();
+        
+        if (pipeline_in_flight_ < pipeline_depth_) {
+            return false;
+        }
+        
+        // Stages are single-threaded FIFOs, so the oldest frame completes first
+        TraceSpan wait_span("wait:result", frame_index);
+        pipeline_cv_.wait(lock, [this]() { return !completed_queue_.empty(); });
+        done = std::move(completed_queue_.front());
+        completed_queue_.pop_front();
+        pipeline_in_flight_--;
+        publishQueueDepths();
+    }
+    
+    result = completeJob(std::move(done));
+    return true;
+}
+
+void DetectionTracker::flushPipeline(std::vector<PipelineResult>& results) {
+    while (true) {
+        std::unique_ptr<PipelineJob> done;
+        {
+            std::unique_lock<std::mutex> lock(pipeline_mutex_);
+            if (pipeline_in_flight_ == 0) {
+                return;
+            }
+            pipeline_cv_.wait(lock, [this]() { return !completed_queue_.empty(); });
+            done = std::move(completed_queue_.front());
+            completed_queue_.pop_front();
+            pipeline_in_flight_--;
+            publishQueueDepths();
+        }
+        results.push_back(completeJob(std::move(done)));
+    }
+}
+
+PipelineResult DetectionTracker::completeJob(std::unique_ptr<PipelineJob> job) {
+    auto start = std::chrono::high_resolution_clock::now();
+    current_frame_index_ = job->frame_index;
+    if (job->adopt_model) {
+        // First frame on the new network: its output layout applies from here
+        applyModel(*job->adopt_model);
+        incoming_model_.reset();
+    }
+    TraceRecorder::global().record("wait:tracking", job->enqueued_us, TraceRecorder::nowMicros(), job->frame_index);
+    
+    std::vector<Detection> detections;
+    if (job->propagate_only) {
+        // Nothing to decode; tracks are moved below
+    } else if (job->skip_inference) {
+        candidate_cache_.store(job->frame_index, std::vector<DetectionResult>());
+    } else if (!job->failed) {
+        TraceSpan span("postprocess", job->frame_index);
+        try {
+            detections = decodeDetections(job->outputs, job->frame);
+        } catch (const cv::Exception& e) {
+            std::cerr << "OpenCV error in pipeline postprocessing: " << e.what() << std::endl;
+        }
+    }
+    auto decode_end = std::chrono::high_resolution_clock::now();
+    
+    {
+        TraceSpan span(job->propagate_only ? "propagate" : "associate", job->frame_index);
+        if (job->propagate_only) {
+            propagateTracks(job->motion_vectors);
+        } else {
+            updateTracks(detections);
+        }
+    }
+    finishFrame(job->frame_index);
+    
+    PipelineResult result;
+    result.frame_index = job->frame_index;
+    result.frame = job->frame;
+    result.objects = collectTrackedObjects();
+    if (attributes_enabled_ && !secondary_suspended_) {
+        TraceSpan span("attributes", job->frame_index);
+        attribute_classifier_.annotate(job->frame, result.objects);
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    double post_ms = std::chrono::duration<double, std::milli>(decode_end - start).count();
+    tracking_time_ms_ = std::chrono::duration<double, std::milli>(end - decode_end).count();
+    detection_time_ms_ = job->preprocess_ms + job->forward_ms + post_ms;
+    if (job->failed) {
+        recordDroppedFrame();
+    } else if (!job->skip_inference) {
+        metrics_.preprocess_ms->observe(job->preprocess_ms);
+        metrics_.inference_ms->observe(job->forward_ms);
+        metrics_.postprocess_ms->observe(post_ms);
+    }
+    result.latency_ms = std::chrono::duration<double, std::milli>(end - job->submitted).count();
+    
+    // Added latency is the time a frame spends waiting in queues rather than being worked on
+    double work_ms = detection_time_ms_ + tracking_time_ms_;
+    pipeline_latency_ms_ = 0.9 * pipeline_latency_ms_ + 0.1 * result.latency_ms;
+    pipeline_added_latency_ms_ = 0.9 * pipeline_added_latency_ms_ +
+                                 0.1 * std::max(0.0, result.latency_ms - work_ms);
+    
+    // Throughput: one frame leaves the pipeline per completed job
+    if (last_frame_time_.time_since_epoch().count() != 0) {
+        double interval = std::chrono::duration<double, std::milli>(end - last_frame_time_).count();
+        if (interval > 0.0) {
+            current_fps_ = 1000.0 / interval;
+        }
+    }
+    last_frame_time_ = end;
+    publishFrameMetrics(!job->propagate_only && !job->skip_inference && !job->failed, result.latency_ms);
+    
+    return result;
+}
+
+void DetectionTracker::setMetricsScope(const std::string& scope) {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    metrics_.frames = &registry.counter(scope + "_frames_total", "Frames tracked");
+    metrics_.inferences = &registry.counter(scope + "_inferences_total", "Frames the detector network ran on");
+    metrics_.detection_ms = &registry.histogram(scope + "_detection_ms", "Preprocess, inference and decode time per frame");
+    metrics_.tracking_ms = &registry.histogram(scope + "_tracking_ms", "Track update time per frame");
+    metrics_.pipeline_latency_ms = &registry.histogram(scope + "_frame_latency_ms", "Submit to result, including queueing");
+    metrics_.preprocess_ms = &registry.histogram(scope + "_stage_preprocess_ms", "Resize and blob conversion per inferred frame");
+    metrics_.inference_ms = &registry.histogram(scope + "_stage_inference_ms", "Network forward pass per inferred frame");
+    metrics_.postprocess_ms = &registry.histogram(scope + "_stage_postprocess_ms", "Output decoding and NMS per inferred frame");
+    metrics_.dropped_frames = &registry.counter(scope + "_dropped_frames_total", "Frames returned without results after an error");
+    metrics_.model_swaps = &registry.counter(scope + "_model_swaps_total", "Detector networks switched in without a restart");
+    metrics_.fps = &registry.gauge(scope + "_fps", "Frames tracked per second");
+    metrics_.active_tracks = &registry.gauge(scope + "_active_tracks", "Confirmed tracks in the last frame");
+    metrics_.preprocess_queue = &registry.gauge(scope + "_queue_depth{stage=\"preprocess\"}", "Frames waiting per pipeline stage");
+    metrics_.inference_queue = &registry.gauge(scope + "_queue_depth{stage=\"inference\"}", "Frames waiting per pipeline stage");
+    metrics_.completed_queue = &registry.gauge(scope + "_queue_depth{stage=\"tracking\"}", "Frames waiting per pipeline stage");
+    metrics_.model_load_ms = &registry.gauge(scope + "_model_load_ms", "Time to load and configure the detector network");
+}
+
+void DetectionTracker::recordDroppedFrame() {
+    dropped_frames_++;
+    metrics_.dropped_frames->add();
+}
+
+void DetectionTracker::publishQueueDepths() {
+    metrics_.preprocess_queue->set(static_cast<double>(preprocess_queue_.size()));
+    metrics_.inference_queue->set(static_cast<double>(inference_queue_.size()));
+    metrics_.completed_queue->set(static_cast<double>(completed_queue_.size()));
+}
+
+void DetectionTracker::publishFrameMetrics(bool inferred, double latency_ms) {
+    metrics_.frames->add();
+    if (inferred) {
+        metrics_.inferences->add();
+        metrics_.detection_ms->observe(detection_time_ms_);
+    }
+    metrics_.tracking_ms->observe(tracking_time_ms_);
+    metrics_.pipeline_latency_ms->observe(latency_ms);
+    metrics_.fps->set(current_fps_);
+    metrics_.active_tracks->set(active_tracks_);
 }
 
 void DetectionTracker::enableHighPerformanceMode(bool enable) {
@@ -460,6 +1523,130 @@ void DetectionTracker::enableHighPerformanceMode(bool enable) {
     }
 }
 
+bool DetectionTracker::swapModel(const std::string& model_path, const cv::Size& input_size) {
+    if (swap_loading_ || swap_ready_) {
+        std::cerr << "Model swap already in progress, ignoring " << model_path << std::endl;
+        return false;
+    }
+    if (swap_thread_.joinable()) {
+        swap_thread_.join();
+    }
+    
+    swap_loading_ = true;
+    int backend = backend_;
+    int target = target_;
+    swap_thread_ = std::thread([this, model_path, input_size, backend, target]() {
+        setCurrentThreadName("dt-model-load");
+        TraceSpan span("model-load");
+        auto start = std::chrono::high_resolution_clock::now();
+        auto model = std::make_shared<LoadedModel>();
+        try {
+            model->net = cv::dnn::readNetFromONNX(model_path);
+            if (model->net.empty()) {
+                std::cerr << "Model swap: failed to load " << model_path << std::endl;
+                swap_loading_ = false;
+                return;
+            }
+            model->net.setPreferableBackend(backend);
+            model->net.setPreferableTarget(target);
+            model->descriptor = ModelOutputDescriptor::fromOnnxFile(model_path);
+            if (input_size.area() > 0) {
+                model->descriptor.input_size = input_size;
+            }
+            
+            // The first passes allocate buffers and pick kernels; do that here
+            // rather than on the first live frame
+            cv::Mat blank(model->descriptor.input_size, CV_8UC3, cv::Scalar::all(114));
+            cv::Mat blob = cv::dnn::blobFromImage(blank, 1.0/255.0, model->descriptor.input_size,
+                                                  cv::Scalar(0, 0, 0), true, false);
+            std::vector<cv::Mat> outputs;
+            for (int i = 0; i < 2; ++i) {
+                model->net.setInput(blob);
+                model->net.forward(outputs, model->net.getUnconnectedOutLayersNames());
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Model swap: OpenCV error loading " << model_path << ": " << e.what() << std::endl;
+            swap_loading_ = false;
+            return;
+        } catch (const std::exception& e) {
+            std::cerr << "Model swap: error loading " << model_path << ": " << e.what() << std::endl;
+            swap_loading_ = false;
+            return;
+        }
+        model->path = model_path;
+        model->load_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "Model swap: " << model_path << " ready after " << model->load_ms << " ms" << std::endl;
+        
+        {
+            std::lock_guard<std::mutex> lock(swap_mutex_);
+            staged_model_ = model;
+        }
+        swap_ready_ = true;
+        swap_loading_ = false;
+    });
+    return true;
+}
+
+void DetectionTracker::adoptStagedModel(PipelineJob* boundary) {
+    // One switch at a time: the previous one must have reached its first frame
+    if (!swap_ready_.load() || incoming_model_) {
+        return;
+    }
+    std::shared_ptr<LoadedModel> model;
+    {
+        std::lock_guard<std::mutex> lock(swap_mutex_);
+        model = std::move(staged_model_);
+    }
+    swap_ready_ = false;
+    if (!model) {
+        return;
+    }
+    
+    // Frames in flight keep their own handle to the old network...
+    yolo_net_ = model->net;
+    if (boundary && pipeline_in_flight_ > 0) {
+        // ...and are decoded with the old layout until this frame completes
+        boundary->adopt_model = model;
+        incoming_model_ = model;
+    } else {
+        applyModel(*model);
+    }
+}
+
+void DetectionTracker::applyModel(const LoadedModel& model) {
+    descriptor_ = model.descriptor;
+    // The new model's own labels win, even when it has as many classes as
+    // the old one; the filter mask is rebuilt for them
+    if (!descriptor_.class_names.empty()) {
+        class_names_ = descriptor_.class_names;
+    }
+    setClassFilter(class_filter_);
+    model_path_ = model.path;
+    model_swaps_++;
+    metrics_.model_swaps->add();
+    metrics_.model_load_ms->set(model.load_ms);
+    std::cout << "Detector switched to " << model.path << " (" << descriptor_.describe() << ")" << std::endl;
+}
+
+void DetectionTracker::setInputSize(const cv::Size& size) {
+    // Preprocessing reads the size on the worker threads
+    std::vector<PipelineResult> pending;
+    flushPipeline(pending);
+    descriptor_.input_size = size;
+}
+
+void DetectionTracker::setBackend(int backend, int target) {
+    // Stages must not run the network while it is being reconfigured
+    std::vector<PipelineResult> pending;
+    flushPipeline(pending);
+    backend_ = backend;
+    target_ = target;
+    yolo_net_.setPreferableBackend(backend);
+    yolo_net_.setPreferableTarget(target);
+    std::cout << "Detector backend " << backend << ", target " << target << std::endl;
+}
+
 void DetectionTracker::setThreadCount(int threads) {
     num_threads_ = threads;
     cv::setNumThreads(threads);
@@ -515,7 +1702,8 @@ void DetectionTracker::updateTracksFromResults(const std::vector<DetectionResult
         det.bbox = result.box;
         det.confidence = result.confidence;
         det.class_id = result.class_id;
-        det.class_name = class_names_[result.class_id];
+        det.class_name = (result.class_id >= 0 && result.class_id < static_cast<int>(class_names_.size())) ?
+                        class_names_[result.class_id] : "unknown";
         detections.push_back(det);
     }
     
@@ -6,6 +6,19 @@
 #include <memory>
 #include <string>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+#include "candidate_cache.h"
+#include "tracker_checkpoints.h"
+#include "motion_gate.h"
+#include "motion_vectors.h"
+#include "attribute_classifier.h"
+#include "model_descriptor.h"
+#include "MetricsRegistry.hpp"
 
 // Forward declarations
 class Track;
@@ -32,6 +45,19 @@ struct TrackedObject {
     int age;
     int total_hits;
     int time_since_update;
+    
+    // Secondary attributes, filled per track by the attribute classifier
+    std::string color;
+    std::string vehicle_type;
+    float attribute_confidence = 0.0f;
+};
+
+// Frame that went through the internal pipeline, returned in submission order
+struct PipelineResult {
+    int frame_index;
+    cv::Mat frame;
+    std::vector<TrackedObject> objects;
+    double latency_ms;  // submit to result
 };
 
 class DetectionTracker {
@@ -44,25 +70,163 @@ public:
                    const std::string& classes_path, float conf_threshold = 0.5, 
                    float nms_threshold = 0.4);
 
-    // Process a frame and return tracked objects
-    std::vector<TrackedObject> processFrame(const cv::Mat& frame);
+    // Process a frame and return tracked objects. When frame_index is given the
+    // frame's pre-NMS candidates are cached for later re-thresholding.
+    std::vector<TrackedObject> processFrame(const cv::Mat& frame, int frame_index = -1);
+
+    // Detector output alone: no tracking, caching or detection skipping, with
+    // the confidence/NMS/class filters applied. For comparing with other pipelines.
+    std::vector<Detection> detectFrame(const cv::Mat& frame);
+
+    // Output layout of the loaded model; read from ONNX metadata on initialize
+    // and completed from the first output shape. Set by hand for exports that
+    // carry no metadata and do not follow the usual layouts.
+    void setModelDescriptor(const ModelOutputDescriptor& descriptor) { descriptor_ = descriptor; }
+    const ModelOutputDescriptor& modelDescriptor() const { return descriptor_; }
+
+    // Network input resolution; smaller is faster and less accurate. Only
+    // models exported with dynamic input shapes accept other sizes.
+    void setInputSize(const cv::Size& size);
+    cv::Size getInputSize() const { return descriptor_.input_size; }
+
+    // Load another network on a background thread, warm it up, and switch to
+    // it at the next frame boundary. Tracks, caches and settings are kept, and
+    // frames already in the pipeline finish on the old network. An empty
+    // input_size keeps the new model's native size. False if a swap is
+    // already under way.
+    bool swapModel(const std::string& model_path, const cv::Size& input_size = cv::Size());
+    bool isModelSwapPending() const { return swap_loading_ || swap_ready_ || incoming_model_ != nullptr; }
+    long getModelSwaps() const { return model_swaps_; }
+    const std::string& getModelPath() const { return model_path_; }
+
+    // cv::dnn backend/target pair for the detector network
+    void setBackend(int backend, int target);
+    int getBackend() const { return backend_; }
+    int getTarget() const { return target_; }
+    bool hasModel() const { return !yolo_net_.empty(); }
+
+    // Re-apply the current confidence/NMS/class filters to a cached frame without
+    // running the network or touching tracker state. Surviving boxes inherit the
+    // id of the best-overlapping object in previous (-1 if none).
+    bool reprocessCachedFrame(int frame_index, const std::vector<TrackedObject>& previous,
+                              std::vector<TrackedObject>& objects);
+    bool hasCachedFrame(int frame_index) const { return candidate_cache_.contains(frame_index); }
+    void clearCandidateCache() { candidate_cache_.clear(); }
+    CandidateCache& candidateCache() { return candidate_cache_; }
+
+    // Tracker state snapshots for consistent random seeking
+    TrackerSnapshot snapshot() const;
+    void restore(const TrackerSnapshot& snapshot);
+    void resetTracks();
+    
+    // Prepare to process frame_index next: keeps the current state for in-order
+    // frames, otherwise restores the nearest earlier checkpoint. Returns the first
+    // frame that has to be replayed (via trackCachedFrame or processFrame) before
+    // frame_index itself.
+    int seekTo(int frame_index);
+    
+    // Advance tracking by one frame from cached candidates, without inference;
+    // objects, if given, receives the frame's tracked objects
+    bool trackCachedFrame(int frame_index, std::vector<TrackedObject>* objects = nullptr);
+    
+    void setCheckpointInterval(int frames) { checkpoints_.setInterval(frames); }
+    void clearCheckpoints() { checkpoints_.clear(); last_frame_index_ = -1; }
+    const TrackerCheckpointStore& checkpoints() const { return checkpoints_; }
+    int getLastFrameIndex() const { return last_frame_index_; }
+
+    // Software pipelining: with depth > 1, preprocessing and inference of later
+    // frames run on worker threads while earlier frames are decoded/NMS'd and
+    // tracked by the caller. Results come back (depth - 1) frames late.
+    void setPipelineDepth(int depth);
+    int getPipelineDepth() const { return pipeline_depth_; }
+    bool processFramePipelined(const cv::Mat& frame, int frame_index, PipelineResult& result);
+    void flushPipeline(std::vector<PipelineResult>& results);
+    double getPipelineLatency() const { return pipeline_latency_ms_; }
+    double getPipelineAddedLatency() const { return pipeline_added_latency_ms_; }
+
+    // Motion gating for static cameras: skip inference while nothing moves
+    // and nothing is tracked, with a periodic forced refresh
+    void enableMotionGating(bool enable);
+    bool isMotionGatingEnabled() const { return motion_gating_; }
+    MotionGate& motionGate() { return motion_gate_; }
+    double getMotionSkipRate() const { return motion_gate_.getSkipRate(); }
+    long getSkippedInferences() const { return motion_gate_.getFramesSkipped(); }
+
+    // Tiled change-aware inference for wide static views: only tiles whose
+    // content changed since their last inference are re-run (batched); static
+    // tiles carry their detections forward. A full frame runs every N frames.
+    void enableTiledInference(bool enable, int grid_cols = 3, int grid_rows = 2);
+    bool isTiledInferenceEnabled() const { return tiled_inference_; }
+    void setTileChangeThreshold(float threshold) { tile_change_threshold_ = threshold; }
+    void setFullFrameInterval(int frames) { full_frame_interval_ = std::max(1, frames); }
+    void setTileBatchSize(int size) { tile_batch_size_ = std::max(1, size); }
+    double getTileReuseRate() const {
+        return tiles_considered_ > 0 ? 1.0 - static_cast<double>(tiles_inferred_) / tiles_considered_ : 0.0;
+    }
+
+    // Run the detector only every Nth frame; frames in between move existing
+    // tracks by the median codec motion vector inside each box (given through
+    // setFrameMotionVectors before processing), or by their velocity otherwise
+    void setDetectionInterval(int frames);
+    int getDetectionInterval() const { return detection_interval_; }
+    void setFrameMotionVectors(std::vector<MotionVector> vectors) { frame_motion_vectors_ = std::move(vectors); }
+    long getPropagatedFrames() const { return propagated_frames_; }
+    double getMotionVectorCoverage() const {
+        return propagated_boxes_ > 0 ? static_cast<double>(mv_propagated_boxes_) / propagated_boxes_ : 0.0;
+    }
+
+    // Two-model cascade: the primary model runs on full frames; uncertain
+    // regions (low-confidence candidates, class conflicts, new objects) are
+    // cropped and re-detected by a larger model within a per-frame budget
+    bool enableCascade(const std::string& refine_model_path, int refine_input_size = 320);
+    void disableCascade() { cascade_enabled_ = false; }
+    bool isCascadeEnabled() const { return cascade_enabled_; }
+    void setCascadeBudget(int max_crops_per_frame, double max_ms_per_frame);
+    void setCascadeLowConfidence(float threshold) { cascade_low_conf_ = threshold; }
+    double getCascadeCropsPerFrame() const { return cascade_crops_per_frame_; }
+    double getCascadeTime() const { return cascade_time_ms_; }
+
+    // Vehicle color/type from a secondary classifier, run once per new track
+    // and re-checked periodically rather than on every detection
+    bool enableAttributeClassification(const std::string& model_path);
+    void disableAttributeClassification() { attributes_enabled_ = false; }
+    bool isAttributeClassificationEnabled() const { return attributes_enabled_; }
+    AttributeClassifier& attributeClassifier() { return attribute_classifier_; }
+
+    // Skip attribute classification and cascade refinement without unloading
+    // either, so they can be shed under load and resumed instantly
+    void suspendSecondaryStages(bool suspend) { secondary_suspended_ = suspend; }
+    bool areSecondaryStagesSuspended() const { return secondary_suspended_; }
+
+    // Frame, inference and latency metrics are also published to
+    // MetricsRegistry::global() as <scope>_*; trackers sharing a scope add up
+    void setMetricsScope(const std::string& scope);
 
     // Get performance metrics
     double getFPS() const { return current_fps_; }
     double getDetectionTime() const { return detection_time_ms_; }
     double getTrackingTime() const { return tracking_time_ms_; }
+    long getDroppedFrames() const { return dropped_frames_; }
     int getActiveTracks() const { return active_tracks_; }
 
-    // Settings
-    void setConfidenceThreshold(float threshold) { conf_threshold_ = threshold; }
-    void setNMSThreshold(float threshold) { nms_threshold_ = threshold; }
-    void setMaxDisappeared(int frames) { max_disappeared_ = frames; }
-    void setMinHits(int hits) { min_hits_ = hits; }
-    void setIOUThreshold(float threshold) { iou_threshold_ = threshold; }
+    // Settings. Anything that changes what the tracker would have produced
+    // drops the checkpoints taken under the old values; the live state is
+    // kept so in-order playback carries on
+    void setConfidenceThreshold(float threshold) { conf_threshold_ = threshold; checkpoints_.clear(); }
+    void setNMSThreshold(float threshold) { nms_threshold_ = threshold; checkpoints_.clear(); }
+    void setMaxDisappeared(int frames) { max_disappeared_ = frames; checkpoints_.clear(); }
+    void setMinHits(int hits) { min_hits_ = hits; checkpoints_.clear(); }
+    void setIOUThreshold(float threshold) { iou_threshold_ = threshold; checkpoints_.clear(); }
+    void setClassFilter(const std::vector<int>& class_ids);
+    const std::vector<int>& getClassFilter() const { return class_filter_; }
+    const std::vector<std::string>& getClassNames() const { return class_names_; }
+    float getConfidenceThreshold() const { return conf_threshold_; }
+    float getNMSThreshold() const { return nms_threshold_; }
     
     // Performance settings
     void enableHighPerformanceMode(bool enable = true);
     void setThreadCount(int threads);
+    int getThreadCount() const { return num_threads_; }
     void setBufferSize(int size);
 
 private:
@@ -71,6 +235,61 @@ private:
     std::vector<std::string> class_names_;
     float conf_threshold_;
     float nms_threshold_;
+    std::vector<int> class_filter_;
+    std::vector<bool> class_filter_mask_;
+    
+    // How to read the primary model's output
+    ModelOutputDescriptor descriptor_;
+    
+    // Pre-NMS candidates per frame for re-thresholding without inference
+    CandidateCache candidate_cache_;
+    int current_frame_index_;
+    
+    // Change detection ahead of inference
+    MotionGate motion_gate_;
+    bool motion_gating_;
+    
+    // Tiled incremental inference state
+    bool tiled_inference_;
+    int tile_cols_;
+    int tile_rows_;
+    float tile_change_threshold_;
+    int full_frame_interval_;
+    int tile_batch_size_;
+    int frames_since_full_;
+    cv::Mat tile_reference_;                                   // small gray frame at last inference per tile
+    std::vector<std::vector<DetectionResult>> tile_candidates_; // candidates whose center lies in each tile
+    long tiles_inferred_;
+    long tiles_considered_;
+    
+    // Detect-every-N with motion vector propagation in between
+    int detection_interval_;
+    int frames_since_detection_;
+    std::vector<MotionVector> frame_motion_vectors_;
+    long propagated_frames_;
+    long propagated_boxes_;
+    long mv_propagated_boxes_;
+    
+    // Cascade re-detection with a larger model
+    cv::dnn::Net refine_net_;
+    ModelOutputDescriptor refine_descriptor_;
+    bool cascade_enabled_;
+    int refine_input_size_;
+    int cascade_max_crops_;
+    double cascade_max_ms_;
+    int cascade_batch_size_;
+    float cascade_low_conf_;
+    double cascade_crops_per_frame_;
+    double cascade_time_ms_;
+    
+    // Per-track secondary inference
+    AttributeClassifier attribute_classifier_;
+    bool attributes_enabled_;
+    bool secondary_suspended_;  // attributes and cascade skipped while loaded
+    
+    // Checkpoints of tracker state, keyed by frame
+    TrackerCheckpointStore checkpoints_;
+    int last_frame_index_;
     
     // SORT tracking
     std::vector<std::unique_ptr<Track>> tracks_;
@@ -86,6 +305,31 @@ private:
     int active_tracks_;
     std::chrono::high_resolution_clock::time_point last_frame_time_;
     
+    // Registry handles, resolved once per scope so frames only touch atomics
+    struct RegistryMetrics {
+        Counter* frames;
+        Counter* inferences;
+        Histogram* detection_ms;
+        Histogram* tracking_ms;
+        Histogram* pipeline_latency_ms;
+        Histogram* preprocess_ms;
+        Histogram* inference_ms;
+        Histogram* postprocess_ms;
+        Counter* dropped_frames;
+        Counter* model_swaps;
+        Gauge* fps;
+        Gauge* active_tracks;
+        Gauge* preprocess_queue;
+        Gauge* inference_queue;
+        Gauge* completed_queue;
+        Gauge* model_load_ms;
+    };
+    RegistryMetrics metrics_;
+    long dropped_frames_;
+    void publishFrameMetrics(bool inferred, double latency_ms);
+    void recordDroppedFrame();
+    void publishQueueDepths();  // pipeline_mutex_ held
+    
     // Performance optimization buffers
     cv::Mat frame_buffer_;
     cv::Mat processed_buffer_;
@@ -95,23 +339,103 @@ private:
     
     // Threading and optimization
     int num_threads_;
+    int backend_;
+    int target_;
     bool use_optimizations_;
     
+    // A network loaded off the playback path, waiting to be switched in
+    struct LoadedModel {
+        cv::dnn::Net net;
+        ModelOutputDescriptor descriptor;
+        std::string path;
+        double load_ms;
+    };
+    
+    // Internal pipeline: preprocess thread -> inference thread -> caller
+    struct PipelineJob {
+        int frame_index;
+        cv::Mat frame;
+        cv::Mat blob;
+        std::vector<cv::Mat> outputs;
+        bool failed;
+        bool skip_inference;
+        bool propagate_only;
+        std::vector<MotionVector> motion_vectors;
+        double preprocess_ms;
+        double forward_ms;
+        std::chrono::high_resolution_clock::time_point submitted;
+        uint64_t enqueued_us;  // trace clock, when it entered its current queue
+        cv::dnn::Net net;       // network current at submit, so a swap never splits a frame
+        cv::Size input_size;
+        std::shared_ptr<const LoadedModel> adopt_model;  // first frame on a swapped-in model
+    };
+    int pipeline_depth_;
+    bool pipeline_stop_;
+    int pipeline_in_flight_;
+    std::thread preprocess_thread_;
+    std::thread inference_thread_;
+    std::mutex pipeline_mutex_;
+    std::condition_variable pipeline_cv_;
+    std::deque<std::unique_ptr<PipelineJob>> preprocess_queue_;
+    std::deque<std::unique_ptr<PipelineJob>> inference_queue_;
+    std::deque<std::unique_ptr<PipelineJob>> completed_queue_;
+    double pipeline_latency_ms_;
+    double pipeline_added_latency_ms_;
+    
+    // Hot model swap
+    std::string model_path_;
+    std::thread swap_thread_;
+    std::mutex swap_mutex_;
+    std::shared_ptr<LoadedModel> staged_model_;  // loaded and warmed up, guarded by swap_mutex_
+    std::atomic<bool> swap_loading_;
+    std::atomic<bool> swap_ready_;
+    std::shared_ptr<const LoadedModel> incoming_model_;  // switched in, first frame still in flight
+    long model_swaps_;
+    void adoptStagedModel(PipelineJob* boundary);
+    void applyModel(const LoadedModel& model);
+    
+    void startPipeline();
+    void stopPipeline();
+    void preprocessWorker();
+    void inferenceWorker();
+    PipelineResult completeJob(std::unique_ptr<PipelineJob> job);
+    
     // Detection methods
     std::vector<Detection> detectObjects(const cv::Mat& frame);
-    cv::Mat preprocessFrame(const cv::Mat& frame);
+    bool gateAllowsInference(const cv::Mat& frame);
+    bool isDetectionFrame(int frame_index);
+    std::vector<Detection> detectObjectsTiled(const cv::Mat& frame);
+    std::vector<cv::Rect> tileRects(const cv::Size& frame_size) const;
+    void assignCandidatesToTiles(const std::vector<DetectionResult>& candidates, const cv::Size& frame_size,
+                                 const std::vector<int>& tiles);
+    std::vector<Detection> decodeDetections(const std::vector<cv::Mat>& outputs,
+                                            const cv::Mat& frame);
+    std::vector<DetectionResult> cascadeDetections(const cv::Mat& output, const cv::Mat& frame);
+    std::vector<cv::Rect> selectCascadeRegions(const std::vector<DetectionResult>& candidates,
+                                               const std::vector<DetectionResult>& results);
+    std::vector<DetectionResult> refineRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                                               const std::vector<DetectionResult>& candidates);
+    cv::Mat preprocessFrame(const cv::Mat& frame, const cv::Size& input_size);
     std::vector<cv::Rect> postprocessDetections(const cv::Mat& output, 
                                                const cv::Size& original_size);
     std::vector<DetectionResult> postprocessDetectionsWithInfo(const cv::Mat& output,
                                                               const cv::Size& original_size);
+    std::vector<DetectionResult> extractCandidates(const cv::Mat& output,
+                                                   const cv::Size& original_size,
+                                                   ModelOutputDescriptor& descriptor);
+    std::vector<DetectionResult> filterCandidates(const std::vector<DetectionResult>& candidates);
+    bool isClassEnabled(int class_id) const;
     
     // Tracking methods
     void updateTracks(const std::vector<Detection>& detections);
     void updateTracksFromResults(const std::vector<DetectionResult>& results);
+    void propagateTracks(const std::vector<MotionVector>& vectors);
     std::vector<int> associateDetectionsToTracks(const std::vector<Detection>& detections,
                                                 std::vector<TrackedObject>& tracked_objects);
     float calculateIOU(const cv::Rect& rect1, const cv::Rect& rect2);
     void updateTrackedObjects(std::vector<TrackedObject>& tracked_objects);
+    std::vector<TrackedObject> collectTrackedObjects();
+    void finishFrame(int frame_index);
     
     // Utility methods
     void loadClassNames(const std::string& classes_path);
@@ -123,9 +447,11 @@ class Track {
 public:
     Track(const cv::Rect& bbox, int track_id, int class_id, float confidence, 
           const std::string& class_name);
+    Track(const TrackState& state, const std::string& class_name);
     
     void predict();
     void update(const cv::Rect& bbox, float confidence);
+    void shift(const cv::Point2f& displacement);
     cv::Rect getBBox() const;
     cv::Point2f getCenter() const;
     int getTrackId() const { return track_id_; }
@@ -136,6 +462,7 @@ public:
     int getTotalHits() const { return total_hits_; }
     int getTimeSinceUpdate() const { return time_since_update_; }
     bool isConfirmed() const { return total_hits_ >= 3; }
+    TrackState getState() const;
     
 private:
     int track_id_;
@@ -0,0 +1,392 @@
+// Accuracy vs throughput for detector/tracker configurations.
+//
+//   evaluate_accuracy --model models/yolov8n.onnx \
+//       --coco instances_val2017.json --images val2017 \
+//       --mot MOT17-04/gt/gt.txt --video MOT17-04/img1/%06d.jpg --mot-classes 1 --track-classes 0 \
+//       --config baseline: --config small:input=416 --config sparse:interval=3,gating=1
+//
+// Each configuration is run over every dataset in turn; inference is timed on
+// its own, the metrics are computed afterwards on all cores. With
+// --metrics-port the run can be scraped by Prometheus like the GUI.
+
+#include "detection_tracker.h"
+#include "evaluation.h"
+#include "MetricsHttpServer.hpp"
+#include "ResourceSampler.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+struct EvalConfig {
+    std::string name;
+    std::string model_path;  // empty: --model
+    cv::Size input_size;     // empty: native
+    int detection_interval = 1;
+    bool motion_gating = false;
+    float conf_threshold = 0.5f;
+    int threads = 0;         // 0: tracker default
+};
+
+struct Throughput {
+    long frames = 0;
+    double seconds = 0.0;
+    double fps() const { return seconds > 0.0 ? frames / seconds : 0.0; }
+    double latencyMs() const { return frames > 0 ? 1000.0 * seconds / frames : 0.0; }
+};
+
+struct ConfigReport {
+    EvalConfig config;
+    Throughput coco_speed;
+    Throughput mot_speed;
+    DetectionMetrics detection{};
+    TrackingMetrics tracking{};
+    bool has_detection = false;
+    bool has_tracking = false;
+};
+
+std::vector<int> parseIntList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::stoi(item));
+        }
+    }
+    return values;
+}
+
+// name:key=value,key=value
+bool parseConfig(const std::string& text, EvalConfig& config) {
+    size_t colon = text.find(':');
+    config.name = text.substr(0, colon);
+    if (colon == std::string::npos) {
+        return !config.name.empty();
+    }
+    std::stringstream stream(text.substr(colon + 1));
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+        if (key == "model") {
+            config.model_path = value;
+        } else if (key == "input") {
+            size_t x = value.find('x');
+            int width = std::stoi(value.substr(0, x));
+            config.input_size = cv::Size(width, x == std::string::npos ? width : std::stoi(value.substr(x + 1)));
+        } else if (key == "interval") {
+            config.detection_interval = std::max(1, std::stoi(value));
+        } else if (key == "gating") {
+            config.motion_gating = value == "1" || value == "on" || value == "true";
+        } else if (key == "conf") {
+            config.conf_threshold = std::stof(value);
+        } else if (key == "threads") {
+            config.threads = std::stoi(value);
+        } else {
+            std::cerr << "Unknown config key " << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool setUpTracker(DetectionTracker& tracker, const EvalConfig& config, const std::string& model_path,
+                  const std::string& classes_path, const std::vector<int>& track_classes) {
+    std::string model = config.model_path.empty() ? model_path : config.model_path;
+    if (!tracker.initialize(model, "", classes_path, config.conf_threshold)) {
+        std::cerr << config.name << ": failed to load " << model << std::endl;
+        return false;
+    }
+    if (!config.input_size.empty()) {
+        tracker.setInputSize(config.input_size);
+    }
+    if (config.threads > 0) {
+        tracker.setThreadCount(config.threads);
+    }
+    if (!track_classes.empty()) {
+        tracker.setClassFilter(track_classes);  // otherwise the tracker's vehicle default
+    }
+    tracker.setMetricsScope("eval");
+    return true;
+}
+
+// Plain detections per image: every image is independent, so detection
+// skipping and motion gating do not apply here. mAP averages over every
+// COCO class, so all classes are enabled; the tracking filter is put back
+// afterwards for the MOT sequences.
+void runCoco(DetectionTracker& tracker, const CocoDataset& dataset, float eval_conf, int max_frames,
+             EvalFrames& detections, Throughput& speed) {
+    std::vector<int> track_filter = tracker.getClassFilter();
+    std::vector<int> all_classes(std::max<size_t>(tracker.getClassNames().size(), 80));
+    std::iota(all_classes.begin(), all_classes.end(), 0);
+    tracker.setClassFilter(all_classes);
+
+    tracker.setDetectionInterval(1);
+    tracker.enableMotionGating(false);
+    tracker.setConfidenceThreshold(eval_conf);
+    tracker.candidateCache().setScoreFloor(std::min(tracker.candidateCache().getScoreFloor(), eval_conf));
+
+    size_t count = max_frames > 0 ? std::min(dataset.image_paths.size(), static_cast<size_t>(max_frames)) :
+                                    dataset.image_paths.size();
+    detections.assign(count, {});
+    for (size_t i = 0; i < count; ++i) {
+        cv::Mat image = cv::imread(dataset.image_paths[i]);
+        if (image.empty()) {
+            std::cerr << "Cannot read " << dataset.image_paths[i] << std::endl;
+            continue;
+        }
+        tracker.resetTracks();
+        auto start = std::chrono::steady_clock::now();
+        tracker.processFrame(image, static_cast<int>(i));
+        speed.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        speed.frames++;
+
+        std::vector<TrackedObject> objects;
+        tracker.reprocessCachedFrame(static_cast<int>(i), {}, objects);
+        for (const auto& obj : objects) {
+            detections[i].push_back(EvalBox{cv::Rect2f(obj.bbox), obj.class_id, -1, obj.confidence, false});
+        }
+        tracker.clearCandidateCache();
+    }
+    tracker.setClassFilter(track_filter);
+}
+
+// Tracker output per frame with the configuration's own interval and gating
+void runSequence(DetectionTracker& tracker, const EvalConfig& config, const std::string& video_path,
+                 int max_frames, EvalFrames& tracks, Throughput& speed) {
+    tracker.resetTracks();
+    tracker.clearCheckpoints();
+    tracker.setDetectionInterval(config.detection_interval);
+    tracker.enableMotionGating(config.motion_gating);
+    tracker.setConfidenceThreshold(config.conf_threshold);
+
+    cv::VideoCapture capture(video_path);
+    if (!capture.isOpened()) {
+        std::cerr << "Cannot open " << video_path << std::endl;
+        return;
+    }
+    cv::Mat frame;
+    tracks.clear();
+    while ((max_frames <= 0 || static_cast<int>(tracks.size()) < max_frames) && capture.read(frame)) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<TrackedObject> objects = tracker.processFrame(frame);
+        speed.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        speed.frames++;
+
+        tracks.emplace_back();
+        for (const auto& obj : objects) {
+            tracks.back().push_back(EvalBox{cv::Rect2f(obj.bbox), obj.class_id, obj.track_id, obj.confidence, false});
+        }
+    }
+}
+
+void printUsage() {
+    std::cout << "Usage: evaluate_accuracy --model MODEL.onnx [--classes coco.names]\n"
+              << "         [--coco ANNOTATIONS.json --images DIR]\n"
+              << "         [--mot gt.txt --video SEQUENCE]...  (video file or image pattern, e.g. img1/%06d.jpg)\n"
+              << "         [--config NAME:key=value,...]...    (model, input=WxH, interval, gating, conf, threads)\n"
+              << "         [--mot-classes 1,2] [--track-classes 0] [--eval-conf 0.01]\n"
+              << "         [--max-frames N] [--threads N] [--csv report.csv] [--metrics-port N]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string model_path;
+    std::string classes_path = "models/coco.names";
+    std::string coco_path, image_dir, csv_path;
+    std::vector<std::string> mot_paths, video_paths;
+    std::vector<EvalConfig> configs;
+    std::vector<int> mot_classes, track_classes;
+    float eval_conf = 0.01f;
+    int max_frames = 0;
+    int threads = 0;
+    int metrics_port = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value" << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--model") {
+            model_path = next();
+        } else if (arg == "--classes") {
+            classes_path = next();
+        } else if (arg == "--coco") {
+            coco_path = next();
+        } else if (arg == "--images") {
+            image_dir = next();
+        } else if (arg == "--mot") {
+            mot_paths.push_back(next());
+        } else if (arg == "--video") {
+            video_paths.push_back(next());
+        } else if (arg == "--config") {
+            EvalConfig config;
+            if (!parseConfig(next(), config)) {
+                std::cerr << "Invalid --config " << argv[i] << std::endl;
+                return 1;
+            }
+            configs.push_back(config);
+        } else if (arg == "--mot-classes") {
+            mot_classes = parseIntList(next());
+        } else if (arg == "--track-classes") {
+            track_classes = parseIntList(next());
+        } else if (arg == "--eval-conf") {
+            eval_conf = std::stof(next());
+        } else if (arg == "--max-frames") {
+            max_frames = std::stoi(next());
+        } else if (arg == "--threads") {
+            threads = std::stoi(next());
+        } else if (arg == "--csv") {
+            csv_path = next();
+        } else if (arg == "--metrics-port") {
+            metrics_port = std::stoi(next());
+        } else {
+            printUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    if (model_path.empty() || (coco_path.empty() && mot_paths.empty()) || mot_paths.size() != video_paths.size()) {
+        printUsage();
+        return 1;
+    }
+    if (configs.empty()) {
+        configs.push_back(EvalConfig{"baseline"});
+    }
+
+    // Prometheus scrape endpoint, off unless asked for
+    MetricsHttpServer metrics_server;
+    if (metrics_port >= 0) {
+        MetricsRegistry::global().startSampler();
+        ResourceSampler::global().start();
+        if (!metrics_server.start(metrics_port)) {
+            return 1;
+        }
+        std::cout << "Metrics on http://localhost:" << metrics_server.port() << "/metrics" << std::endl;
+    }
+
+    // Ground truth is loaded once and shared by every configuration
+    CocoDataset coco;
+    if (!coco_path.empty()) {
+        std::vector<std::string> class_names;
+        std::ifstream classes(classes_path);
+        for (std::string line; std::getline(classes, line);) {
+            class_names.push_back(line);
+        }
+        if (!loadCocoDataset(coco_path, image_dir, class_names, coco)) {
+            return 1;
+        }
+        if (max_frames > 0 && coco.ground_truth.size() > static_cast<size_t>(max_frames)) {
+            coco.ground_truth.resize(max_frames);
+        }
+        std::cout << "COCO: " << coco.ground_truth.size() << " images" << std::endl;
+    }
+    std::vector<EvalFrames> mot_ground_truth(mot_paths.size());
+    for (size_t s = 0; s < mot_paths.size(); ++s) {
+        if (!loadMotGroundTruth(mot_paths[s], mot_classes, mot_ground_truth[s])) {
+            return 1;
+        }
+        std::cout << "MOT: " << mot_paths[s] << ", " << mot_ground_truth[s].size() << " frames" << std::endl;
+    }
+
+    std::vector<ConfigReport> reports;
+    for (const auto& config : configs) {
+        ConfigReport report;
+        report.config = config;
+        DetectionTracker tracker;
+        if (!setUpTracker(tracker, config, model_path, classes_path, track_classes)) {
+            continue;
+        }
+        std::cout << "Running " << config.name << "..." << std::endl;
+
+        if (!coco.image_paths.empty()) {
+            EvalFrames detections;
+            runCoco(tracker, coco, eval_conf, max_frames, detections, report.coco_speed);
+            report.detection = evaluateDetections(coco.ground_truth, detections, 100, threads);
+            report.has_detection = true;
+        }
+
+        if (!mot_paths.empty()) {
+            // All sequences scored as one, ids kept apart per sequence
+            EvalFrames all_gt, all_tracks;
+            int gt_offset = 0, track_offset = 0;
+            for (size_t s = 0; s < mot_paths.size(); ++s) {
+                EvalFrames tracks;
+                runSequence(tracker, config, video_paths[s], max_frames, tracks, report.mot_speed);
+                EvalFrames gt = mot_ground_truth[s];
+                size_t frames = std::max(gt.size(), tracks.size());
+                if (max_frames > 0) {
+                    frames = std::min(frames, static_cast<size_t>(max_frames));
+                }
+                gt.resize(frames);
+                tracks.resize(frames);
+                appendSequence(all_gt, gt, gt_offset);
+                appendSequence(all_tracks, tracks, track_offset);
+            }
+            report.tracking = evaluateTracking(all_gt, all_tracks, threads);
+            report.has_tracking = true;
+        }
+        reports.push_back(report);
+    }
+
+    // Side by side: what each configuration costs and what it buys
+    std::cout << "\n" << std::left << std::setw(16) << "config"
+              << std::right << std::setw(8) << "FPS" << std::setw(10) << "ms/frame"
+              << std::setw(8) << "mAP" << std::setw(8) << "mAP50" << std::setw(8) << "mAP75"
+              << std::setw(8) << "MOT FPS" << std::setw(8) << "MOTA" << std::setw(8) << "IDF1"
+              << std::setw(8) << "HOTA" << std::setw(7) << "IDSW" << std::endl;
+    std::cout << std::fixed;
+    for (const auto& r : reports) {
+        std::cout << std::left << std::setw(16) << r.config.name << std::right << std::setprecision(1);
+        if (r.has_detection) {
+            std::cout << std::setw(8) << r.coco_speed.fps() << std::setw(10) << r.coco_speed.latencyMs()
+                      << std::setprecision(3) << std::setw(8) << r.detection.map << std::setw(8) << r.detection.map50
+                      << std::setw(8) << r.detection.map75;
+        } else {
+            std::cout << std::setw(8) << "-" << std::setw(10) << "-" << std::setw(8) << "-" << std::setw(8) << "-"
+                      << std::setw(8) << "-";
+        }
+        if (r.has_tracking) {
+            std::cout << std::setprecision(1) << std::setw(8) << r.mot_speed.fps() << std::setprecision(3)
+                      << std::setw(8) << r.tracking.mota << std::setw(8) << r.tracking.idf1
+                      << std::setw(8) << r.tracking.hota << std::setw(7) << r.tracking.id_switches;
+        } else {
+            std::cout << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(8) << "-"
+                      << std::setw(7) << "-";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path);
+        csv << "config,coco_frames,coco_fps,coco_ms_per_frame,map,map50,map75,"
+               "mot_frames,mot_fps,mot_ms_per_frame,mota,motp,idf1,idp,idr,hota,deta,assa,loca,"
+               "false_positives,false_negatives,id_switches\n";
+        for (const auto& r : reports) {
+            csv << r.config.name << ',' << r.coco_speed.frames << ',' << r.coco_speed.fps() << ','
+                << r.coco_speed.latencyMs() << ',' << r.detection.map << ',' << r.detection.map50 << ','
+                << r.detection.map75 << ',' << r.mot_speed.frames << ',' << r.mot_speed.fps() << ','
+                << r.mot_speed.latencyMs() << ',' << r.tracking.mota << ',' << r.tracking.motp << ','
+                << r.tracking.idf1 << ',' << r.tracking.idp << ',' << r.tracking.idr << ','
+                << r.tracking.hota << ',' << r.tracking.deta << ',' << r.tracking.assa << ','
+                << r.tracking.loca << ',' << r.tracking.false_positives << ','
+                << r.tracking.false_negatives << ',' << r.tracking.id_switches << '\n';
+        }
+        std::cout << "Report written to " << csv_path << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,680 @@
+#include "evaluation.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+float boxIoU(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float intersection = (a & b).area();
+    float union_area = a.area() + b.area() - intersection;
+    return union_area > 0.0f ? intersection / union_area : 0.0f;
+}
+
+// Crowd regions cover many objects; COCO scores a detection against them by
+// how much of the detection lies inside
+float crowdIoU(const cv::Rect2f& detection, const cv::Rect2f& crowd) {
+    float area = detection.area();
+    return area > 0.0f ? (detection & crowd).area() / area : 0.0f;
+}
+
+std::string normalizeName(std::string name) {
+    for (char& c : name) {
+        c = c == '_' ? ' ' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return name;
+}
+
+constexpr int kApThresholds = 10;  // IoU 0.50:0.05:0.95
+constexpr int kHotaAlphas = 19;    // IoU 0.05:0.05:0.95
+constexpr double kEpsilon = 1e-10;
+
+// 101-point interpolated AP from detections sorted by descending score
+double averagePrecision(const std::vector<std::pair<float, bool>>& scored, long positives) {
+    std::vector<double> precision(scored.size());
+    std::vector<double> recall(scored.size());
+    long tp = 0;
+    for (size_t i = 0; i < scored.size(); ++i) {
+        tp += scored[i].second ? 1 : 0;
+        precision[i] = static_cast<double>(tp) / (i + 1);
+        recall[i] = static_cast<double>(tp) / positives;
+    }
+    for (size_t i = precision.size(); i-- > 1;) {
+        precision[i - 1] = std::max(precision[i - 1], precision[i]);
+    }
+    double sum = 0.0;
+    for (int r = 0; r <= 100; ++r) {
+        auto it = std::lower_bound(recall.begin(), recall.end(), r / 100.0 - kEpsilon);
+        if (it != recall.end()) {
+            sum += precision[it - recall.begin()];
+        }
+    }
+    return sum / 101.0;
+}
+
+}  // namespace
+
+void parallelFor(int count, int threads, const std::function<void(int)>& fn) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (int i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::vector<int> solveAssignment(const std::vector<double>& cost, int rows, int cols) {
+    std::vector<int> assignment(rows, -1);
+    if (rows == 0 || cols == 0) {
+        return assignment;
+    }
+
+    // Shortest augmenting paths with potentials; needs rows <= cols, so a
+    // tall matrix is solved transposed
+    const bool transposed = rows > cols;
+    const int n = transposed ? cols : rows;
+    const int m = transposed ? rows : cols;
+    auto at = [&](int i, int j) { return transposed ? cost[j * cols + i] : cost[i * cols + j]; };
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> u(n + 1, 0.0), v(m + 1, 0.0), min_v(m + 1);
+    std::vector<int> p(m + 1, 0), way(m + 1, 0);
+    std::vector<char> used(m + 1);
+    for (int i = 1; i <= n; ++i) {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(min_v.begin(), min_v.end(), inf);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            int i0 = p[j0];
+            int j1 = 0;
+            double delta = inf;
+            for (int j = 1; j <= m; ++j) {
+                if (used[j]) {
+                    continue;
+                }
+                double current = at(i0 - 1, j - 1) - u[i0] - v[j];
+                if (current < min_v[j]) {
+                    min_v[j] = current;
+                    way[j] = j0;
+                }
+                if (min_v[j] < delta) {
+                    delta = min_v[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; ++j) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    min_v[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (int j = 1; j <= m; ++j) {
+        if (p[j] != 0) {
+            if (transposed) {
+                assignment[j - 1] = p[j] - 1;
+            } else {
+                assignment[p[j] - 1] = j - 1;
+            }
+        }
+    }
+    return assignment;
+}
+
+bool loadCocoDataset(const std::string& annotation_path, const std::string& image_dir,
+                     const std::vector<std::string>& class_names, CocoDataset& dataset) {
+    cv::FileStorage fs;
+    try {
+        fs.open(annotation_path, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to parse " << annotation_path << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (!fs.isOpened()) {
+        std::cerr << "Cannot open COCO annotations " << annotation_path << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<int, std::string>> categories;
+    cv::FileNode category_nodes = fs["categories"];
+    for (auto it = category_nodes.begin(); it != category_nodes.end(); ++it) {
+        categories.push_back({static_cast<int>((*it)["id"]), static_cast<std::string>((*it)["name"])});
+    }
+    std::sort(categories.begin(), categories.end());
+
+    std::unordered_map<int, int> category_to_class;
+    int unmapped = 0;
+    for (size_t k = 0; k < categories.size(); ++k) {
+        std::string name = normalizeName(categories[k].second);
+        int class_id = -1;
+        for (size_t c = 0; c < class_names.size(); ++c) {
+            if (normalizeName(class_names[c]) == name) {
+                class_id = static_cast<int>(c);
+                break;
+            }
+        }
+        if (class_id < 0 && k < class_names.size()) {
+            class_id = static_cast<int>(k);
+        }
+        if (class_id < 0) {
+            unmapped++;
+        }
+        category_to_class[categories[k].first] = class_id;
+    }
+    if (unmapped > 0) {
+        std::cerr << unmapped << " COCO categories have no detector class and are skipped" << std::endl;
+    }
+
+    dataset.image_paths.clear();
+    dataset.ground_truth.clear();
+    std::unordered_map<int, size_t> image_index;
+    std::string prefix = image_dir.empty() ? "" : image_dir + "/";
+    cv::FileNode image_nodes = fs["images"];
+    for (auto it = image_nodes.begin(); it != image_nodes.end(); ++it) {
+        image_index[static_cast<int>((*it)["id"])] = dataset.image_paths.size();
+        dataset.image_paths.push_back(prefix + static_cast<std::string>((*it)["file_name"]));
+    }
+    dataset.ground_truth.resize(dataset.image_paths.size());
+
+    cv::FileNode annotation_nodes = fs["annotations"];
+    for (auto it = annotation_nodes.begin(); it != annotation_nodes.end(); ++it) {
+        const cv::FileNode& node = *it;
+        auto image = image_index.find(static_cast<int>(node["image_id"]));
+        auto category = category_to_class.find(static_cast<int>(node["category_id"]));
+        if (image == image_index.end() || category == category_to_class.end() || category->second < 0) {
+            continue;
+        }
+        cv::FileNode bbox = node["bbox"];
+        if (bbox.size() != 4) {
+            continue;
+        }
+        EvalBox box{cv::Rect2f(static_cast<float>(bbox[0]), static_cast<float>(bbox[1]),
+                               static_cast<float>(bbox[2]), static_cast<float>(bbox[3])),
+                    category->second, -1, 1.0f, static_cast<int>(node["iscrowd"]) != 0};
+        dataset.ground_truth[image->second].push_back(box);
+    }
+    return !dataset.image_paths.empty();
+}
+
+bool loadMotGroundTruth(const std::string& path, const std::vector<int>& eval_classes, EvalFrames& frames) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open MOT ground truth " << path << std::endl;
+        return false;
+    }
+
+    frames.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        int frame, id;
+        float x, y, w, h;
+        if (!(fields >> frame >> id >> x >> y >> w >> h) || frame < 1) {
+            continue;
+        }
+        float active = 1.0f;
+        int mot_class = -1;
+        fields >> active >> mot_class;
+        if (active == 0.0f) {
+            continue;
+        }
+        bool evaluated = eval_classes.empty() || mot_class < 0 ||
+                         std::find(eval_classes.begin(), eval_classes.end(), mot_class) != eval_classes.end();
+        if (static_cast<size_t>(frame) > frames.size()) {
+            frames.resize(frame);
+        }
+        frames[frame - 1].push_back(EvalBox{cv::Rect2f(x, y, w, h), mot_class, id, 1.0f, !evaluated});
+    }
+    return true;
+}
+
+void appendSequence(EvalFrames& all, const EvalFrames& sequence, int& id_offset) {
+    int max_id = -1;
+    for (const auto& frame : sequence) {
+        all.push_back(frame);
+        for (auto& box : all.back()) {
+            if (box.track_id >= 0) {
+                max_id = std::max(max_id, box.track_id);
+                box.track_id += id_offset;
+            }
+        }
+    }
+    id_offset += max_id + 1;
+}
+
+DetectionMetrics evaluateDetections(const EvalFrames& ground_truth, const EvalFrames& detections,
+                                    int max_detections, int threads) {
+    DetectionMetrics metrics{0.0, 0.0, 0.0, {}, 0, 0};
+    const size_t frame_count = std::max(ground_truth.size(), detections.size());
+
+    std::vector<int> classes;
+    for (const auto& frame : ground_truth) {
+        for (const auto& box : frame) {
+            if (!box.ignore) {
+                classes.push_back(box.class_id);
+                metrics.ground_truth_boxes++;
+            }
+        }
+    }
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    if (classes.empty()) {
+        return metrics;
+    }
+
+    // Per class and frame: ground truth with crowds last, detections best first
+    struct ClassFrames {
+        std::vector<std::vector<const EvalBox*>> gt;
+        std::vector<std::vector<const EvalBox*>> dt;
+        long positives = 0;
+    };
+    std::vector<ClassFrames> per_class(classes.size());
+    std::vector<long> detection_counts(classes.size(), 0);
+    parallelFor(static_cast<int>(classes.size()), threads, [&](int c) {
+        ClassFrames& data = per_class[c];
+        data.gt.resize(frame_count);
+        data.dt.resize(frame_count);
+        for (size_t f = 0; f < frame_count; ++f) {
+            if (f < ground_truth.size()) {
+                for (const auto& box : ground_truth[f]) {
+                    if (box.class_id == classes[c]) {
+                        data.gt[f].push_back(&box);
+                        data.positives += box.ignore ? 0 : 1;
+                    }
+                }
+                std::stable_partition(data.gt[f].begin(), data.gt[f].end(),
+                                      [](const EvalBox* box) { return !box->ignore; });
+            }
+            if (f < detections.size()) {
+                for (const auto& box : detections[f]) {
+                    if (box.class_id == classes[c]) {
+                        data.dt[f].push_back(&box);
+                    }
+                }
+                std::stable_sort(data.dt[f].begin(), data.dt[f].end(),
+                                 [](const EvalBox* a, const EvalBox* b) { return a->score > b->score; });
+                if (data.dt[f].size() > static_cast<size_t>(max_detections)) {
+                    data.dt[f].resize(max_detections);
+                }
+                detection_counts[c] += static_cast<long>(data.dt[f].size());
+            }
+        }
+    });
+    for (long count : detection_counts) {
+        metrics.detections += count;
+    }
+
+    // One work item per class and IoU threshold
+    std::vector<double> ap(classes.size() * kApThresholds, 0.0);
+    parallelFor(static_cast<int>(ap.size()), threads, [&](int item) {
+        const ClassFrames& data = per_class[item / kApThresholds];
+        const float threshold = 0.5f + 0.05f * (item % kApThresholds);
+
+        std::vector<std::pair<float, bool>> scored;
+        std::vector<char> matched;
+        for (size_t f = 0; f < frame_count; ++f) {
+            const auto& gt = data.gt[f];
+            matched.assign(gt.size(), 0);
+            for (const EvalBox* det : data.dt[f]) {
+                int best = -1;
+                float best_iou = std::min(threshold, 1.0f - 1e-6f);
+                for (size_t g = 0; g < gt.size(); ++g) {
+                    if (matched[g] && !gt[g]->ignore) {
+                        continue;
+                    }
+                    // A real match is never traded for a crowd
+                    if (best >= 0 && !gt[best]->ignore && gt[g]->ignore) {
+                        break;
+                    }
+                    float iou = gt[g]->ignore ? crowdIoU(det->box, gt[g]->box) : boxIoU(det->box, gt[g]->box);
+                    if (iou < best_iou) {
+                        continue;
+                    }
+                    best_iou = iou;
+                    best = static_cast<int>(g);
+                }
+                if (best < 0) {
+                    scored.push_back({det->score, false});
+                } else if (!gt[best]->ignore) {
+                    matched[best] = 1;
+                    scored.push_back({det->score, true});
+                }
+            }
+        }
+        std::stable_sort(scored.begin(), scored.end(),
+                         [](const std::pair<float, bool>& a, const std::pair<float, bool>& b) {
+                             return a.first > b.first;
+                         });
+        ap[item] = data.positives > 0 ? averagePrecision(scored, data.positives) : 0.0;
+    });
+
+    for (size_t c = 0; c < classes.size(); ++c) {
+        double sum = 0.0;
+        for (int t = 0; t < kApThresholds; ++t) {
+            sum += ap[c * kApThresholds + t];
+        }
+        metrics.ap_per_class[classes[c]] = sum / kApThresholds;
+        metrics.map += sum / kApThresholds;
+        metrics.map50 += ap[c * kApThresholds];
+        metrics.map75 += ap[c * kApThresholds + 5];
+    }
+    metrics.map /= classes.size();
+    metrics.map50 /= classes.size();
+    metrics.map75 /= classes.size();
+    return metrics;
+}
+
+TrackingMetrics evaluateTracking(const EvalFrames& ground_truth, const EvalFrames& tracks, int threads) {
+    TrackingMetrics metrics{};
+    const int frame_count = static_cast<int>(std::max(ground_truth.size(), tracks.size()));
+
+    // Dense ids for ground truth and tracker identities
+    std::unordered_map<int, int> gt_index, track_index;
+    for (const auto& frame : ground_truth) {
+        for (const auto& box : frame) {
+            if (!box.ignore) {
+                gt_index.emplace(box.track_id, static_cast<int>(gt_index.size()));
+            }
+        }
+    }
+    for (const auto& frame : tracks) {
+        for (const auto& box : frame) {
+            track_index.emplace(box.track_id, static_cast<int>(track_index.size()));
+        }
+    }
+    const int num_gt = static_cast<int>(gt_index.size());
+    const int num_tracks = static_cast<int>(track_index.size());
+
+    // Per frame: valid boxes and their IoU matrix; tracker boxes that only
+    // cover an ignore region are removed first
+    struct FrameData {
+        std::vector<int> gt;
+        std::vector<int> tr;
+        std::vector<float> iou;  // gt.size() x tr.size()
+    };
+    std::vector<FrameData> data(frame_count);
+    parallelFor(frame_count, threads, [&](int f) {
+        static const std::vector<EvalBox> empty;
+        const auto& gt_boxes = f < static_cast<int>(ground_truth.size()) ? ground_truth[f] : empty;
+        const auto& tr_boxes = f < static_cast<int>(tracks.size()) ? tracks[f] : empty;
+
+        std::vector<const EvalBox*> valid, ignored;
+        for (const auto& box : gt_boxes) {
+            (box.ignore ? ignored : valid).push_back(&box);
+        }
+        std::vector<double> cost(valid.size() * tr_boxes.size(), 0.0);
+        for (size_t g = 0; g < valid.size(); ++g) {
+            for (size_t t = 0; t < tr_boxes.size(); ++t) {
+                float iou = boxIoU(valid[g]->box, tr_boxes[t].box);
+                cost[g * tr_boxes.size() + t] = iou >= 0.5f ? -iou : 0.0;
+            }
+        }
+        std::vector<char> matched(tr_boxes.size(), 0);
+        std::vector<int> assignment = solveAssignment(cost, static_cast<int>(valid.size()),
+                                                      static_cast<int>(tr_boxes.size()));
+        for (size_t g = 0; g < valid.size(); ++g) {
+            if (assignment[g] >= 0 && cost[g * tr_boxes.size() + assignment[g]] < 0.0) {
+                matched[assignment[g]] = 1;
+            }
+        }
+
+        FrameData& frame = data[f];
+        std::vector<const EvalBox*> kept;
+        for (size_t t = 0; t < tr_boxes.size(); ++t) {
+            bool in_ignore = false;
+            for (const EvalBox* region : ignored) {
+                in_ignore = in_ignore || boxIoU(region->box, tr_boxes[t].box) >= 0.5f;
+            }
+            if (matched[t] || !in_ignore) {
+                kept.push_back(&tr_boxes[t]);
+                frame.tr.push_back(track_index.at(tr_boxes[t].track_id));
+            }
+        }
+        for (const EvalBox* box : valid) {
+            frame.gt.push_back(gt_index.at(box->track_id));
+        }
+        frame.iou.resize(valid.size() * kept.size());
+        for (size_t g = 0; g < valid.size(); ++g) {
+            for (size_t t = 0; t < kept.size(); ++t) {
+                frame.iou[g * kept.size() + t] = boxIoU(valid[g]->box, kept[t]->box);
+            }
+        }
+    });
+
+    long gt_total = 0;
+    long track_total = 0;
+    std::vector<long> gt_frames(num_gt, 0), track_frames(num_tracks, 0);
+    for (const auto& frame : data) {
+        gt_total += static_cast<long>(frame.gt.size());
+        track_total += static_cast<long>(frame.tr.size());
+        for (int g : frame.gt) {
+            gt_frames[g]++;
+        }
+        for (int t : frame.tr) {
+            track_frames[t]++;
+        }
+    }
+    metrics.ground_truth_boxes = gt_total;
+    if (gt_total == 0 && track_total == 0) {
+        return metrics;
+    }
+
+    // CLEAR MOT: sequential, a match is kept from one frame to the next
+    // whenever it still overlaps enough
+    {
+        std::vector<int> last_track(num_gt, -1), previous_frame_track(num_gt, -1);
+        long matches = 0;
+        double iou_sum = 0.0;
+        for (const auto& frame : data) {
+            const size_t nt = frame.tr.size();
+            std::vector<double> cost(frame.gt.size() * nt, 0.0);
+            for (size_t g = 0; g < frame.gt.size(); ++g) {
+                for (size_t t = 0; t < nt; ++t) {
+                    float iou = frame.iou[g * nt + t];
+                    if (iou >= 0.5f) {
+                        bool continued = previous_frame_track[frame.gt[g]] == frame.tr[t];
+                        cost[g * nt + t] = -(iou + (continued ? 1000.0 : 0.0));
+                    }
+                }
+            }
+            std::vector<int> assignment = solveAssignment(cost, static_cast<int>(frame.gt.size()),
+                                                          static_cast<int>(nt));
+            std::fill(previous_frame_track.begin(), previous_frame_track.end(), -1);
+            for (size_t g = 0; g < frame.gt.size(); ++g) {
+                int t = assignment[g];
+                if (t < 0 || cost[g * nt + t] >= 0.0) {
+                    continue;
+                }
+                int gt_id = frame.gt[g];
+                int track_id = frame.tr[t];
+                if (last_track[gt_id] >= 0 && last_track[gt_id] != track_id) {
+                    metrics.id_switches++;
+                }
+                last_track[gt_id] = track_id;
+                previous_frame_track[gt_id] = track_id;
+                iou_sum += frame.iou[g * nt + t];
+                matches++;
+            }
+        }
+        metrics.false_negatives = gt_total - matches;
+        metrics.false_positives = track_total - matches;
+        metrics.mota = gt_total > 0 ?
+            1.0 - static_cast<double>(metrics.false_negatives + metrics.false_positives + metrics.id_switches) / gt_total :
+            0.0;
+        metrics.motp = matches > 0 ? iou_sum / matches : 0.0;
+    }
+
+    // Identity metrics: one global ground truth <-> track assignment that
+    // maximizes the number of frames where the pair overlaps
+    std::vector<double> overlap_frames(static_cast<size_t>(num_gt) * num_tracks, 0.0);
+    for (const auto& frame : data) {
+        const size_t nt = frame.tr.size();
+        for (size_t g = 0; g < frame.gt.size(); ++g) {
+            for (size_t t = 0; t < nt; ++t) {
+                if (frame.iou[g * nt + t] >= 0.5f) {
+                    overlap_frames[static_cast<size_t>(frame.gt[g]) * num_tracks + frame.tr[t]] += 1.0;
+                }
+            }
+        }
+    }
+    {
+        std::vector<double> cost(overlap_frames.size());
+        std::transform(overlap_frames.begin(), overlap_frames.end(), cost.begin(), [](double v) { return -v; });
+        std::vector<int> assignment = solveAssignment(cost, num_gt, num_tracks);
+        double idtp = 0.0;
+        for (int g = 0; g < num_gt; ++g) {
+            if (assignment[g] >= 0) {
+                idtp += overlap_frames[static_cast<size_t>(g) * num_tracks + assignment[g]];
+            }
+        }
+        metrics.idp = track_total > 0 ? idtp / track_total : 0.0;
+        metrics.idr = gt_total > 0 ? idtp / gt_total : 0.0;
+        metrics.idf1 = 2.0 * idtp / (gt_total + track_total);
+    }
+
+    // HOTA: identities are aligned globally by how well each pair overlaps
+    // over the whole sequence, then matched per frame
+    std::vector<double> alignment(static_cast<size_t>(num_gt) * num_tracks, 0.0);
+    for (const auto& frame : data) {
+        const size_t ng = frame.gt.size();
+        const size_t nt = frame.tr.size();
+        std::vector<double> row_sum(ng, 0.0), col_sum(nt, 0.0);
+        for (size_t g = 0; g < ng; ++g) {
+            for (size_t t = 0; t < nt; ++t) {
+                row_sum[g] += frame.iou[g * nt + t];
+                col_sum[t] += frame.iou[g * nt + t];
+            }
+        }
+        for (size_t g = 0; g < ng; ++g) {
+            for (size_t t = 0; t < nt; ++t) {
+                double similarity = frame.iou[g * nt + t];
+                double denominator = row_sum[g] + col_sum[t] - similarity;
+                if (denominator > kEpsilon) {
+                    alignment[static_cast<size_t>(frame.gt[g]) * num_tracks + frame.tr[t]] += similarity / denominator;
+                }
+            }
+        }
+    }
+    for (int g = 0; g < num_gt; ++g) {
+        for (int t = 0; t < num_tracks; ++t) {
+            double& score = alignment[static_cast<size_t>(g) * num_tracks + t];
+            score /= std::max(kEpsilon, static_cast<double>(gt_frames[g] + track_frames[t]) - score);
+        }
+    }
+
+    // The per-frame assignment does not depend on alpha; only which of its
+    // pairs count as matches does
+    struct Pair {
+        int gt;
+        int tr;
+        float iou;
+    };
+    std::vector<std::vector<Pair>> frame_pairs(frame_count);
+    parallelFor(frame_count, threads, [&](int f) {
+        const FrameData& frame = data[f];
+        const size_t nt = frame.tr.size();
+        std::vector<double> cost(frame.gt.size() * nt);
+        for (size_t g = 0; g < frame.gt.size(); ++g) {
+            for (size_t t = 0; t < nt; ++t) {
+                cost[g * nt + t] = -alignment[static_cast<size_t>(frame.gt[g]) * num_tracks + frame.tr[t]] *
+                                   frame.iou[g * nt + t];
+            }
+        }
+        std::vector<int> assignment = solveAssignment(cost, static_cast<int>(frame.gt.size()), static_cast<int>(nt));
+        for (size_t g = 0; g < frame.gt.size(); ++g) {
+            if (assignment[g] >= 0 && frame.iou[g * nt + assignment[g]] > 0.0f) {
+                frame_pairs[f].push_back({frame.gt[g], frame.tr[assignment[g]], frame.iou[g * nt + assignment[g]]});
+            }
+        }
+    });
+
+    // Distinct identity pairs, so match counts per alpha stay sparse
+    std::unordered_map<long long, int> pair_slot;
+    std::vector<std::pair<int, int>> pair_ids;
+    std::vector<std::vector<int>> frame_slots(frame_count);
+    for (int f = 0; f < frame_count; ++f) {
+        for (const Pair& pair : frame_pairs[f]) {
+            long long key = static_cast<long long>(pair.gt) * num_tracks + pair.tr;
+            auto inserted = pair_slot.emplace(key, static_cast<int>(pair_ids.size()));
+            if (inserted.second) {
+                pair_ids.push_back({pair.gt, pair.tr});
+            }
+            frame_slots[f].push_back(inserted.first->second);
+        }
+    }
+
+    std::vector<double> hota(kHotaAlphas), deta(kHotaAlphas), assa(kHotaAlphas), loca(kHotaAlphas);
+    parallelFor(kHotaAlphas, threads, [&](int a) {
+        const float alpha = 0.05f * (a + 1);
+        std::vector<long> counts(pair_ids.size(), 0);
+        long tp = 0;
+        double iou_sum = 0.0;
+        for (int f = 0; f < frame_count; ++f) {
+            for (size_t i = 0; i < frame_pairs[f].size(); ++i) {
+                if (frame_pairs[f][i].iou >= alpha - 1e-6f) {
+                    counts[frame_slots[f][i]]++;
+                    iou_sum += frame_pairs[f][i].iou;
+                    tp++;
+                }
+            }
+        }
+        double association = 0.0;
+        for (size_t s = 0; s < pair_ids.size(); ++s) {
+            if (counts[s] > 0) {
+                double denominator = gt_frames[pair_ids[s].first] + track_frames[pair_ids[s].second] - counts[s];
+                association += counts[s] * (counts[s] / std::max(1.0, denominator));
+            }
+        }
+        long fn = gt_total - tp;
+        long fp = track_total - tp;
+        deta[a] = static_cast<double>(tp) / std::max(1L, tp + fn + fp);
+        assa[a] = association / std::max(1L, tp);
+        hota[a] = std::sqrt(deta[a] * assa[a]);
+        loca[a] = std::max(kEpsilon, iou_sum) / std::max(kEpsilon, static_cast<double>(tp));
+    });
+    for (int a = 0; a < kHotaAlphas; ++a) {
+        metrics.hota += hota[a] / kHotaAlphas;
+        metrics.deta += deta[a] / kHotaAlphas;
+        metrics.assa += assa[a] / kHotaAlphas;
+        metrics.loca += loca[a] / kHotaAlphas;
+    }
+    return metrics;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Ground truth or detector/tracker output for one object in one frame.
+// track_id is -1 for plain detections, score is 1 for ground truth.
+struct EvalBox {
+    cv::Rect2f box;
+    int class_id;
+    int track_id;
+    float score;
+    bool ignore;  // crowd or distractor region: matching it is neither TP nor FP
+};
+
+// Boxes per frame; detection datasets have one frame per image
+using EvalFrames = std::vector<std::vector<EvalBox>>;
+
+// COCO detection annotations with the image each frame comes from.
+// Category ids are mapped to detector class ids by name, falling back to
+// the position in the sorted category list (the usual 80-class export).
+struct CocoDataset {
+    std::vector<std::string> image_paths;
+    EvalFrames ground_truth;
+};
+bool loadCocoDataset(const std::string& annotation_path, const std::string& image_dir,
+                     const std::vector<std::string>& class_names, CocoDataset& dataset);
+
+// MOTChallenge gt.txt (frame,id,x,y,w,h,active,class,visibility), frames
+// 1-based in the file and 0-based in the result. Rows with active == 0 are
+// dropped; rows whose class is not in eval_classes (if given) become ignore
+// regions, like the distractor classes in MOT17.
+bool loadMotGroundTruth(const std::string& path, const std::vector<int>& eval_classes, EvalFrames& frames);
+
+// Append a sequence to an evaluation set so several sequences are scored as
+// one: track ids are offset to stay distinct across sequences.
+void appendSequence(EvalFrames& all, const EvalFrames& sequence, int& id_offset);
+
+// COCO-style box AP: greedy matching per class and IoU threshold, 101-point
+// interpolated precision, averaged over IoU 0.50:0.05:0.95
+struct DetectionMetrics {
+    double map;    // mAP@0.5:0.95
+    double map50;
+    double map75;
+    std::map<int, double> ap_per_class;  // AP@0.5:0.95, classes present in the ground truth
+    long ground_truth_boxes;
+    long detections;
+};
+DetectionMetrics evaluateDetections(const EvalFrames& ground_truth, const EvalFrames& detections,
+                                    int max_detections = 100, int threads = 0);
+
+// Class-agnostic multi-object tracking metrics at IoU 0.5 (CLEAR MOT and
+// identity metrics) and HOTA averaged over IoU 0.05:0.05:0.95
+struct TrackingMetrics {
+    double mota;
+    double motp;
+    long false_positives;
+    long false_negatives;
+    long id_switches;
+    long ground_truth_boxes;
+    double idf1;
+    double idp;
+    double idr;
+    double hota;
+    double deta;
+    double assa;
+    double loca;
+};
+TrackingMetrics evaluateTracking(const EvalFrames& ground_truth, const EvalFrames& tracks, int threads = 0);
+
+// Run fn(0..count-1) on up to threads workers (0 = hardware concurrency)
+void parallelFor(int count, int threads, const std::function<void(int)>& fn);
+
+// Minimum-cost assignment of rows to columns (Hungarian algorithm); returns
+// the column for each row, -1 for rows left over when there are more rows
+std::vector<int> solveAssignment(const std::vector<double>& cost, int rows, int cols);
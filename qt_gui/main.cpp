@@ -14,6 +14,7 @@
 #include <QStatusBar>
 #include <QMenuBar>
 #include <QFileDialog>
+#include <QFile>
 #include <QMessageBox>
 #include <QTimer>
 #include <QProgressBar>
@@ -24,6 +25,14 @@
 #include <QDir>
 #include <QStandardPaths>
 #include <QSettings>
+#include <QSignalBlocker>
+#include <QProgressDialog>
+#include <QCryptographicHash>
+#include <QSysInfo>
+#include <QDialog>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QListWidget>
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/videoio.hpp>
@@ -38,8 +47,18 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <numeric>
 
 #include "detection_tracker.h"
+#include "chunked_analyzer.h"
+#include "auto_tuner.h"
+#include "overload_controller.h"
+#include "arrow_exporter.h"
+#include "results_index.h"
+#include "ResourceSampler.hpp"
+#include "MetricsHttpServer.hpp"
+#include "TraceRecorder.hpp"
 
 class VideoPlayerWidget : public QWidget {
     Q_OBJECT
@@ -50,10 +69,20 @@ public:
         setupVideoTimer();
     }
 
+    ~VideoPlayerWidget() {
+        cancelParallelAnalysis();
+        stopExportFeeder();
+        resultExporter.close();
+    }
+
     void loadVideo(const QString& filePath) {
         if (videoCapture.isOpened()) {
             videoCapture.release();
         }
+        cancelParallelAnalysis();
+        analysisResults_ = ChunkedAnalysisResult();
+        resultsIndex.clear();
+        currentVideoPath = filePath.toStdString();
 
         videoCapture.open(filePath.toStdString());
         if (!videoCapture.isOpened()) {
@@ -67,12 +96,25 @@ public:
         frameWidth = static_cast<int>(videoCapture.get(cv::CAP_PROP_FRAME_WIDTH));
         frameHeight = static_cast<int>(videoCapture.get(cv::CAP_PROP_FRAME_HEIGHT));
 
+        if (useMotionVectors) {
+            motionVectorReader.open(currentVideoPath);
+        }
+
         // Initialize detection and tracking
         initializeDetection();
+        if (detector_) {
+            detector_->clearCandidateCache();
+            detector_->clearCheckpoints();
+            detector_->resetTracks();
+        }
 
         // Update UI
+        frameSlider->setEnabled(true);
         frameSlider->setMaximum(totalFrames - 1);
-        frameSlider->setValue(0);
+        {
+            QSignalBlocker blocker(frameSlider);
+            frameSlider->setValue(0);
+        }
         currentFrame = 0;
         isPlaying = false;
 
@@ -90,9 +132,11 @@ public:
         playButton->setText(isPlaying ? "⏸️ Pause" : "▶️ Play");
         
         if (isPlaying) {
+            pacedNextFrame = -1;
             videoTimer->start(1000.0 / fps);
         } else {
             videoTimer->stop();
+            finishPipelinedPlayback();
         }
     }
 
@@ -101,7 +145,7 @@ public:
         
         if (currentFrame < totalFrames - 1) {
             currentFrame++;
-            frameSlider->setValue(currentFrame);
+            syncSlider();
             loadCurrentFrame();
             updateFrameInfo();
         }
@@ -112,7 +156,7 @@ public:
         
         if (currentFrame > 0) {
             currentFrame--;
-            frameSlider->setValue(currentFrame);
+            syncSlider();
             loadCurrentFrame();
             updateFrameInfo();
         }
@@ -139,24 +183,314 @@ public:
             detector_->setConfidenceThreshold(static_cast<float>(threshold));
             std::cout << "Confidence threshold updated to: " << threshold << std::endl;
         }
-        if (videoCapture.isOpened()) {
-            loadCurrentFrame();
+        if (hasAnalysisResults()) {
+            startAnalysisRethreshold();
+        } else if (videoCapture.isOpened()) {
+            refreshAnnotations();
+        }
+    }
+
+    void setNMSThreshold(double threshold) {
+        nmsThreshold = threshold;
+        if (detector_) {
+            detector_->setNMSThreshold(static_cast<float>(threshold));
+            std::cout << "NMS threshold updated to: " << threshold << std::endl;
+        }
+        if (hasAnalysisResults()) {
+            startAnalysisRethreshold();
+        } else if (videoCapture.isOpened()) {
+            refreshAnnotations();
+        }
+    }
+
+    void setClassFilter(const std::vector<int>& classIds) {
+        if (detector_) {
+            detector_->setClassFilter(classIds);
+        }
+        if (hasAnalysisResults()) {
+            startAnalysisRethreshold();
+        } else if (videoCapture.isOpened()) {
+            refreshAnnotations();
+        }
+    }
+
+    // Analyse the whole video offline in parallel chunks; playback then shows
+    // the stitched results instead of running detection per frame
+    bool startParallelAnalysis(int chunks) {
+        if (currentVideoPath.empty() || analysisThread_.joinable()) return false;
+
+        ChunkedAnalysisConfig config = analysisConfig();
+        config.num_chunks = chunks;
+
+        analyzer_ = std::make_unique<ChunkedVideoAnalyzer>(config);
+        analysisFinished_ = false;
+        analysisSucceeded_ = false;
+        rethresholding_ = false;
+        rethresholdPending_ = false;
+        std::string path = currentVideoPath;
+        analysisThread_ = std::thread([this, path]() {
+            setCurrentThreadName("analysis");
+            ChunkedAnalysisResult result;
+            analysisSucceeded_ = analyzer_->analyze(path, result);
+            pendingAnalysis_ = std::move(result);
+            analysisFinished_ = true;
+        });
+        analysisPollTimer->start(200);
+        return true;
+    }
+
+    // Re-derive the loaded analysis from its cached candidates after a
+    // threshold or class filter change, in the background like the analysis
+    void startAnalysisRethreshold() {
+        if (analysisThread_.joinable()) {
+            if (rethresholding_) {
+                rethresholdPending_ = true;  // picked up when the running job finishes
+            }
+            return;
+        }
+        if (analysisResults_.chunk_candidates.empty()) return;
+
+        analyzer_ = std::make_unique<ChunkedVideoAnalyzer>(analysisConfig());
+        analysisFinished_ = false;
+        analysisSucceeded_ = false;
+        rethresholding_ = true;
+        rethresholdPending_ = false;
+
+        // The thread owns the candidates until it is done; frames stay on screen meanwhile
+        ChunkedAnalysisResult job;
+        job.total_frames = analysisResults_.total_frames;
+        job.chunks = analysisResults_.chunks;
+        job.class_names = analysisResults_.class_names;
+        job.model_descriptor = analysisResults_.model_descriptor;
+        job.chunk_candidates = std::move(analysisResults_.chunk_candidates);
+        analysisResults_.chunk_candidates.clear();
+        analysisThread_ = std::thread([this, job = std::move(job)]() mutable {
+            setCurrentThreadName("analysis");
+            analysisSucceeded_ = analyzer_->rethreshold(job);
+            pendingAnalysis_ = std::move(job);
+            analysisFinished_ = true;
+        });
+        analysisPollTimer->start(50);
+    }
+
+    void cancelParallelAnalysis() {
+        if (analyzer_) {
+            analyzer_->cancel();
+        }
+        if (analysisThread_.joinable()) {
+            analysisThread_.join();
+        }
+        analysisPollTimer->stop();
+        analyzer_.reset();
+        if (rethresholding_) {
+            // Keep the candidates for the next change
+            analysisResults_.chunk_candidates = std::move(pendingAnalysis_.chunk_candidates);
+            rethresholding_ = false;
+        }
+        rethresholdPending_ = false;
+    }
+
+    // Stream every processed frame's tracks to an Arrow/Parquet file; when a
+    // parallel analysis is loaded its results are written in one pass instead
+    bool startResultExport(const std::string& path) {
+        stopExportFeeder();
+        resultExporter.close();
+        if (!resultExporter.open(path)) return false;
+        if (!analysisResults_.frames.empty()) {
+            // The bulk write waits on the writer's bounded queue, so it is fed
+            // from its own thread with a copy a re-threshold cannot change
+            auto frames = std::make_shared<const std::vector<std::vector<TrackedObject>>>(analysisResults_.frames);
+            double frameMs = fps > 0.0 ? 1000.0 / fps : 0.0;
+            exportFeederStop_ = false;
+            exportFeeding_ = true;
+            exportFeeder_ = std::thread([this, frames, frameMs]() {
+                setCurrentThreadName("export-feeder");
+                for (size_t f = 0; f < frames->size() && !exportFeederStop_.load(); ++f) {
+                    resultExporter.push(static_cast<int>(f), f * frameMs, (*frames)[f], true);
+                }
+                exportFeeding_ = false;
+            });
+        }
+        return true;
+    }
+
+    // Unchecking during a bulk write keeps the frames written so far
+    ExportStats stopResultExport() {
+        stopExportFeeder();
+        resultExporter.close();
+        return resultExporter.stats();
+    }
+
+    void stopExportFeeder() {
+        exportFeederStop_ = true;
+        if (exportFeeder_.joinable()) {
+            exportFeeder_.join();
+        }
+        exportFeeding_ = false;
+    }
+
+    bool isExportingResults() const { return resultExporter.isOpen(); }
+
+    // Index of every frame processed so far (or of the parallel analysis)
+    const ResultsIndex& getResultsIndex() const { return resultsIndex; }
+
+    // Jump to a search hit: stop playback and show the frame with its annotations
+    void jumpToFrame(int frame) {
+        if (!videoCapture.isOpened()) return;
+        pause();
+        currentFrame = std::max(0, std::min(frame, totalFrames - 1));
+        syncSlider();
+        loadCurrentFrame();
+        updateFrameInfo();
+        emit frameChanged(currentFrame);
+    }
+
+    void setPipelineDepth(int depth) {
+        if (detector_) {
+            finishPipelinedPlayback();
+            detector_->setPipelineDepth(depth);
+        }
+    }
+
+    void setDetectionInterval(int frames) {
+        if (detector_) {
+            finishPipelinedPlayback();
+            detector_->setDetectionInterval(frames);
+        }
+    }
+
+    // Feed codec motion vectors to the tracker for boxes between detections
+    bool setMotionVectorPropagation(bool enable) {
+        // The decoder changes hands; pipelined playback restarts from currentFrame
+        finishPipelinedPlayback();
+        useMotionVectors = enable;
+        motionVectorReader.close();
+        if (enable && !currentVideoPath.empty()) {
+            return motionVectorReader.open(currentVideoPath);
+        }
+        return !enable || MotionVectorReader::isSupported();
+    }
+
+    bool setAttributeClassification(bool enable) {
+        initializeDetection();
+        if (!detector_) return false;
+        if (!enable) {
+            detector_->disableAttributeClassification();
+            return true;
+        }
+        return detector_->enableAttributeClassification(attributeModelPath);
+    }
+
+    bool setCascade(bool enable) {
+        initializeDetection();
+        if (!detector_) return false;
+        finishPipelinedPlayback();
+        if (!enable) {
+            detector_->disableCascade();
+            return true;
+        }
+        return detector_->enableCascade(cascadeModelPath);
+    }
+
+    // Shed detector quality instead of slowing down when inference cannot
+    // keep up, and drop frames rather than fall behind the clock
+    void setAdaptiveQuality(bool enable) {
+        initializeDetection();
+        adaptiveQuality = enable;
+        pacedNextFrame = -1;
+        if (!detector_) return;
+        if (!enable) {
+            overloadController.reset();
+            overloadController.attach(nullptr);
+            return;
+        }
+        overloadController.attach(detector_.get());
+        if (QFileInfo::exists(QString::fromStdString(fallbackModelPath))) {
+            overloadController.setModelSwitch([this](bool small, const cv::Size& inputSize) {
+                return detector_->swapModel(small ? fallbackModelPath : modelPath, inputSize);
+            });
+        } else {
+            overloadController.setModelSwitch(nullptr);
+        }
+    }
+
+    bool isAdaptiveQualityEnabled() const { return adaptiveQuality; }
+    const OverloadController& getOverloadController() const { return overloadController; }
+    long getSkippedFrames() const { return skippedFrames; }
+
+    // Switch detection models without stopping playback or losing tracks; a
+    // detector without a model yet just loads it
+    bool swapModel(const std::string& path) {
+        if (!detector_ || !detector_->hasModel()) {
+            modelPath = path;
+            if (!detector_) {
+                initializeDetection();
+                return detector_ && detector_->hasModel();
+            }
+            return detector_->initialize(modelPath, "", classesPath, confidenceThreshold, nmsThreshold);
+        }
+        if (!detector_->swapModel(path)) return false;
+        modelPath = path;
+        return true;
+    }
+
+    bool hasAnalysisResults() const { return !analysisResults_.frames.empty(); }
+    bool hasVideo() const { return videoCapture.isOpened(); }
+    double getVideoFPS() const { return fps; }
+    cv::Size getFrameSize() const { return cv::Size(frameWidth, frameHeight); }
+    const std::string& getModelPath() const { return modelPath; }
+
+    void pause() {
+        if (isPlaying) {
+            playPause();
         }
     }
 
+    // Frames spread evenly over the video, read with a separate capture so
+    // playback position is untouched
+    std::vector<cv::Mat> sampleFrames(int count) {
+        std::vector<cv::Mat> frames;
+        cv::VideoCapture capture(currentVideoPath);
+        if (!capture.isOpened() || totalFrames <= 0) return frames;
+        for (int i = 0; i < count; ++i) {
+            capture.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(totalFrames) * i / count);
+            cv::Mat frame;
+            if (capture.read(frame) && !frame.empty()) {
+                frames.push_back(frame);
+            }
+        }
+        return frames;
+    }
+
 signals:
     void frameChanged(int frame);
     void fpsChanged(double fps);
+    void analysisProgress(int percent);
+    void analysisCompleted(bool success, double elapsedMs, int tracks);
+    void detectorInitialized();
 
 private slots:
     void onVideoTimer() {
         try {
+            if (usePipelinedPlayback()) {
+                advancePipelined();
+                return;
+            }
             if (currentFrame < totalFrames - 1) {
-                currentFrame++;
-                frameSlider->setValue(currentFrame);
+                auto tickStart = std::chrono::steady_clock::now();
+                int backlog = std::min(framesBehind(currentFrame + 1), totalFrames - 2 - currentFrame);
+                currentFrame += 1 + backlog;
+                recordSkippedFrames(backlog);
+                syncSlider();
+                // Skipped frames are not replayed through the tracker
+                replaySkippedFrames = backlog == 0;
                 loadCurrentFrame();
+                replaySkippedFrames = true;
                 updateFrameInfo();
                 emit frameChanged(currentFrame);
+                pacedNextFrame = currentFrame + 1;
+                reportLoad(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - tickStart).count(), backlog);
             } else {
                 // End of video
                 isPlaying = false;
@@ -177,6 +511,61 @@ private slots:
         }
     }
 
+    void onAnalysisPoll() {
+        if (!analyzer_) return;
+        if (!analysisFinished_.load()) {
+            if (!rethresholding_) {
+                emit analysisProgress(static_cast<int>(analyzer_->getProgress() * 100.0));
+            }
+            return;
+        }
+        analysisThread_.join();
+        analysisPollTimer->stop();
+        analyzer_.reset();
+        if (rethresholding_) {
+            rethresholding_ = false;
+            if (analysisSucceeded_.load()) {
+                analysisResults_ = std::move(pendingAnalysis_);
+                rebuildAnalysisIndex();
+                loadCurrentFrame();
+            } else {
+                analysisResults_.chunk_candidates = std::move(pendingAnalysis_.chunk_candidates);
+            }
+            if (rethresholdPending_) {
+                startAnalysisRethreshold();
+            }
+            return;
+        }
+        if (analysisSucceeded_.load()) {
+            analysisResults_ = std::move(pendingAnalysis_);
+            rebuildAnalysisIndex();
+            loadCurrentFrame();
+        }
+        emit analysisCompleted(analysisSucceeded_.load(), analysisResults_.elapsed_ms,
+                               analysisResults_.total_tracks);
+    }
+
+    void rebuildAnalysisIndex() {
+        resultsIndex.clear();
+        for (size_t f = 0; f < analysisResults_.frames.size(); ++f) {
+            resultsIndex.append(static_cast<int>(f), frameTimestampMs(static_cast<int>(f)),
+                                analysisResults_.frames[f]);
+        }
+    }
+
+    // Analysis settings from the player's current model, thresholds and filter
+    ChunkedAnalysisConfig analysisConfig() const {
+        ChunkedAnalysisConfig config;
+        config.model_path = modelPath;
+        config.classes_path = classesPath;
+        config.conf_threshold = static_cast<float>(confidenceThreshold);
+        config.nms_threshold = static_cast<float>(nmsThreshold);
+        if (detector_) {
+            config.class_filter = detector_->getClassFilter();
+        }
+        return config;
+    }
+
     void onFrameSliderChanged(int value) {
         try {
             if (!videoCapture.isOpened()) return;
@@ -236,6 +625,9 @@ private:
     void setupVideoTimer() {
         videoTimer = new QTimer(this);
         connect(videoTimer, &QTimer::timeout, this, &VideoPlayerWidget::onVideoTimer);
+        
+        analysisPollTimer = new QTimer(this);
+        connect(analysisPollTimer, &QTimer::timeout, this, &VideoPlayerWidget::onAnalysisPoll);
     }
 
     void initializeDetection() {
@@ -243,35 +635,223 @@ private:
         
         detector_ = std::make_unique<DetectionTracker>();
         
-        // Try to initialize with a default model (will use dummy detections if not found)
-        std::string model_path = "models/yolov8n.onnx";
+        // Try to initialize with a default model (no detections until one loads)
         std::string config_path = "";
-        std::string classes_path = "models/coco.names";
         
-        if (!detector_->initialize(model_path, config_path, classes_path, confidenceThreshold, 0.4)) {
-            std::cout << "Warning: Could not load YOLO model, using dummy detections" << std::endl;
-            // Create a dummy detector that will work without model files
+        if (!detector_->initialize(modelPath, config_path, classesPath, confidenceThreshold, nmsThreshold)) {
+            std::cout << "Warning: Could not load YOLO model, annotations stay empty until a model is loaded" << std::endl;
             detection_initialized_ = true;
         } else {
             std::cout << "Detection and tracking initialized successfully" << std::endl;
             detection_initialized_ = true;
+            emit detectorInitialized();
+        }
+    }
+
+    void syncSlider() {
+        QSignalBlocker blocker(frameSlider);
+        frameSlider->setValue(currentFrame);
+    }
+
+    // Motion vectors are only needed on frames the detector skips
+    void feedMotionVectors(int frameIndex) {
+        if (!useMotionVectors || !motionVectorReader.isOpened() ||
+            detector_->getDetectionInterval() <= 1 || frameIndex % detector_->getDetectionInterval() == 0) {
+            return;
+        }
+        std::vector<MotionVector> vectors;
+        if (motionVectorReader.motionVectorsFor(frameIndex, vectors)) {
+            detector_->setFrameMotionVectors(std::move(vectors));
+        }
+    }
+
+    // With motion vectors on, the FFmpeg reader is the only decoder: pixels and
+    // vectors come out of one decode (feedMotionVectors then hits its cache).
+    // VideoCapture decodes otherwise, and when the reader cannot land on the
+    // exact frame; positioned says it already sits at frameIndex.
+    bool readerDecodes() const {
+        return useMotionVectors && motionVectorReader.isOpened();
+    }
+
+    bool decodeFrame(int frameIndex, cv::Mat& frame, bool positioned) {
+        if (readerDecodes()) {
+            std::vector<MotionVector> vectors;
+            if (motionVectorReader.frameAt(frameIndex, frame, vectors)) {
+                return true;
+            }
+            positioned = false;
+        }
+        if (!positioned) {
+            videoCapture.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+        }
+        videoCapture >> frame;
+        return !frame.empty();
+    }
+
+    bool usePipelinedPlayback() const {
+        return showAnnotations && detection_initialized_ && detector_ &&
+               detector_->getPipelineDepth() > 1 && analysisResults_.frames.empty();
+    }
+
+    // Pipelined playback: decode and submit the next frame, then show whichever
+    // frame the pipeline hands back (pipeline depth - 1 frames behind)
+    void advancePipelined() {
+        if (pipelineNextFrame < 0) {
+            pipelineNextFrame = currentFrame + 1;
+            prepareTrackerFor(pipelineNextFrame);
+            if (!readerDecodes()) {
+                videoCapture.set(cv::CAP_PROP_POS_FRAMES, pipelineNextFrame);
+            }
+        }
+        
+        PipelineResult result;
+        if (pipelineNextFrame < totalFrames) {
+            // Behind the clock: skip ahead without decoding the frames in between
+            int backlog = std::min(framesBehind(pipelineNextFrame), totalFrames - 1 - pipelineNextFrame);
+            if (!readerDecodes()) {
+                for (int i = 0; i < backlog; ++i) {
+                    videoCapture.grab();
+                }
+            }
+            pipelineNextFrame += backlog;
+            recordSkippedFrames(backlog);
+            
+            cv::Mat frame;
+            {
+                TraceSpan span("decode", pipelineNextFrame);
+                decodeFrame(pipelineNextFrame, frame, true);
+            }
+            if (!frame.empty()) {
+                feedMotionVectors(pipelineNextFrame);
+                pacedNextFrame = pipelineNextFrame + 1;
+                if (detector_->processFramePipelined(frame, pipelineNextFrame++, result)) {
+                    showPipelineResult(result);
+                    reportLoad(result.latency_ms, backlog);
+                }
+                return;
+            }
+            pipelineNextFrame = totalFrames;
+        }
+        
+        // End of video: drain what is still in flight
+        finishPipelinedPlayback();
+        isPlaying = false;
+        playButton->setText("▶️ Play");
+        videoTimer->stop();
+    }
+
+    // Frames the wall clock is ahead of next when adaptive quality is on. The
+    // clock restarts whenever playback did not continue from the last paced
+    // frame (resume, seek, new video).
+    int framesBehind(int next) {
+        if (!adaptiveQuality) return 0;
+        auto now = std::chrono::steady_clock::now();
+        if (next != pacedNextFrame) {
+            paceStart = now;
+            paceStartFrame = next;
+        }
+        double elapsed = std::chrono::duration<double>(now - paceStart).count();
+        int due = paceStartFrame + static_cast<int>(elapsed * fps);
+        return std::max(0, due - next);
+    }
+
+    void recordSkippedFrames(int frames) {
+        if (frames <= 0) return;
+        skippedFrames += frames;
+        skippedFramesMetric.add(frames);
+    }
+
+    void reportLoad(double latencyMs, int backlog) {
+        if (!adaptiveQuality || !showAnnotations || !detector_) return;
+        overloadController.setFrameBudget(1000.0 / fps * std::max(1, detector_->getPipelineDepth()));
+        overloadController.update(latencyMs, backlog);
+    }
+
+    void finishPipelinedPlayback() {
+        if (pipelineNextFrame < 0 || !detector_) return;
+        pipelineNextFrame = -1;
+        std::vector<PipelineResult> pending;
+        detector_->flushPipeline(pending);
+        if (!pending.empty()) {
+            showPipelineResult(pending.back());
+        }
+    }
+
+    // Seeking during pipelined playback: frames still in flight must reach the
+    // tracker before it is repositioned, but the seek target is shown instead
+    void drainPipeline() {
+        if (pipelineNextFrame < 0 || !detector_) return;
+        pipelineNextFrame = -1;
+        std::vector<PipelineResult> pending;
+        detector_->flushPipeline(pending);
+        for (const auto& result : pending) {
+            recordFrame(result.frame_index, result.objects);
+        }
+    }
+
+    void showPipelineResult(const PipelineResult& result) {
+        currentFrame = result.frame_index;
+        currentRawFrame = result.frame;
+        current_tracked_objects_ = result.objects;
+        processed_tracked_objects_ = current_tracked_objects_;
+        recordCurrentFrame();
+        
+        cv::Mat frame = currentRawFrame.clone();
+        drawDetections(frame, current_tracked_objects_);
+        displayFrame(frame);
+        
+        syncSlider();
+        updateFrameInfo();
+        emit frameChanged(currentFrame);
+    }
+
+    // Bring the tracker to the state right before target: out-of-order frames
+    // restore the nearest checkpoint and replay cached detections, only running
+    // the network for frames that were never analysed
+    void prepareTrackerFor(int target) {
+        int next = detector_->seekTo(target);
+        bool positioned = false;
+        cv::Mat frame;
+        for (int f = next; f < target; ++f) {
+            if (detector_->trackCachedFrame(f)) {
+                positioned = false;
+                continue;
+            }
+            if (!decodeFrame(f, frame, positioned)) break;
+            positioned = true;
+            feedMotionVectors(f);
+            detector_->processFrame(frame, f);
         }
     }
 
     void loadCurrentFrame() {
         if (!videoCapture.isOpened()) return;
+        drainPipeline();
         
         cv::Mat frame;
-        videoCapture.set(cv::CAP_PROP_POS_FRAMES, currentFrame);
-        videoCapture >> frame;
+        {
+            TraceSpan span("decode", currentFrame);
+            decodeFrame(currentFrame, frame, false);
+        }
         
         if (frame.empty()) return;
+        currentRawFrame = frame.clone();
         
-        // Run detection and tracking if enabled with error handling
-        if (showAnnotations && detection_initialized_ && detector_) {
+        // Offline results from a parallel analysis take precedence over live detection
+        if (showAnnotations && currentFrame < static_cast<int>(analysisResults_.frames.size())) {
+            current_tracked_objects_ = analysisResults_.frames[currentFrame];
+            processed_tracked_objects_ = current_tracked_objects_;
+            drawDetections(frame, current_tracked_objects_);
+        } else if (showAnnotations && detection_initialized_ && detector_) {
             try {
                 std::cout << "Processing frame " << currentFrame << " with detection..." << std::endl;
-                current_tracked_objects_ = detector_->processFrame(frame);
+                if (replaySkippedFrames) {
+                    prepareTrackerFor(currentFrame);
+                }
+                feedMotionVectors(currentFrame);
+                current_tracked_objects_ = detector_->processFrame(frame, currentFrame);
+                processed_tracked_objects_ = current_tracked_objects_;
+                recordCurrentFrame();
                 std::cout << "Detected " << current_tracked_objects_.size() << " objects" << std::endl;
                 drawDetections(frame, current_tracked_objects_);
             } catch (const std::exception& e) {
@@ -284,6 +864,28 @@ private:
             }
         }
         
+        displayFrame(frame);
+    }
+
+    void refreshAnnotations() {
+        // A paused frame that was already analysed is re-thresholded from its
+        // cached candidates instead of running the network again
+        if (!isPlaying && showAnnotations && detector_ && !currentRawFrame.empty() &&
+            detector_->hasCachedFrame(currentFrame)) {
+            std::vector<TrackedObject> objects;
+            if (detector_->reprocessCachedFrame(currentFrame, processed_tracked_objects_, objects)) {
+                current_tracked_objects_ = objects;
+                cv::Mat frame = currentRawFrame.clone();
+                drawDetections(frame, current_tracked_objects_);
+                displayFrame(frame);
+                return;
+            }
+        }
+        loadCurrentFrame();
+    }
+
+    void displayFrame(const cv::Mat& frame) {
+        TraceSpan span("present", currentFrame);
         // Convert to Qt format with error handling
         try {
             cv::Mat rgbFrame;
@@ -303,6 +905,7 @@ private:
     }
 
     void drawDetections(cv::Mat& frame, const std::vector<TrackedObject>& objects) {
+        TraceSpan span("draw", currentFrame);
         try {
             for (const auto& obj : objects) {
                 // Validate bounding box
@@ -325,10 +928,16 @@ private:
                 cv::rectangle(frame, obj.bbox, color, 2);
                 
                 // Draw label with track ID and class
-                std::string label = obj.class_name + " #" + std::to_string(obj.track_id);
+                std::string label = obj.class_name;
+                if (obj.track_id >= 0) {
+                    label += " #" + std::to_string(obj.track_id);
+                }
                 if (obj.confidence > 0) {
                     label += " (" + std::to_string(static_cast<int>(obj.confidence * 100)) + "%)";
                 }
+                if (!obj.color.empty() || !obj.vehicle_type.empty()) {
+                    label += " " + obj.color + " " + obj.vehicle_type;
+                }
                 
                 int baseline = 0;
                 cv::Size text_size = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
@@ -356,6 +965,26 @@ private:
         }
     }
 
+    double frameTimestampMs(int frame) const {
+        return fps > 0.0 ? frame * 1000.0 / fps : 0.0;
+    }
+
+    // Live results only: offline analysis results are indexed when the
+    // analysis completes and written when the export starts
+    void recordCurrentFrame() {
+        recordFrame(currentFrame, current_tracked_objects_);
+    }
+
+    void recordFrame(int frame, const std::vector<TrackedObject>& objects) {
+        if (!analysisResults_.frames.empty()) return;
+        resultsIndex.append(frame, frameTimestampMs(frame), objects);
+        // The exporter takes one producer; a bulk write may still be running
+        // after a new video was loaded
+        if (resultExporter.isOpen() && !exportFeeding_.load()) {
+            resultExporter.push(frame, frameTimestampMs(frame), objects);
+        }
+    }
+
     void updateFrameInfo() {
         QString info = QString("Frame: %1 / %2 | FPS: %3")
                       .arg(currentFrame + 1)
@@ -374,11 +1003,51 @@ private:
     bool isPlaying = false;
     bool showAnnotations = false;
     double confidenceThreshold = 0.3; // Lower threshold for better detection
+    double nmsThreshold = 0.4;
+    cv::Mat currentRawFrame;
+    std::string currentVideoPath;
+    int pipelineNextFrame = -1;  // next frame to submit in pipelined playback, -1 when idle
+    std::string modelPath = "models/yolov8n.onnx";
+    std::string classesPath = "models/coco.names";
+    std::string attributeModelPath = "models/vehicle-attributes.onnx";
+    std::string cascadeModelPath = "models/yolov8m.onnx";
+    std::string fallbackModelPath = "models/yolov8n-320.onnx";
+    MotionVectorReader motionVectorReader;
+    bool useMotionVectors = false;
+    
+    // Adaptive quality and real-time pacing
+    OverloadController overloadController;
+    bool adaptiveQuality = false;
+    bool replaySkippedFrames = true;
+    int pacedNextFrame = -1;
+    int paceStartFrame = 0;
+    std::chrono::steady_clock::time_point paceStart;
+    long skippedFrames = 0;
+    Counter& skippedFramesMetric = MetricsRegistry::global().counter(
+        "player_skipped_frames_total", "Frames dropped by playback to stay in real time");
+    
+    // Parallel offline analysis
+    std::unique_ptr<ChunkedVideoAnalyzer> analyzer_;
+    std::thread analysisThread_;
+    std::atomic<bool> analysisFinished_{false};
+    std::atomic<bool> analysisSucceeded_{false};
+    ChunkedAnalysisResult pendingAnalysis_;
+    ChunkedAnalysisResult analysisResults_;
+    bool rethresholding_ = false;       // the analysis thread is re-deriving analysisResults_
+    bool rethresholdPending_ = false;   // settings changed again while it was
+    
+    // Columnar export and searchable index of tracking results
+    ArrowExporter resultExporter;
+    std::thread exportFeeder_;          // bulk export of a parallel analysis
+    std::atomic<bool> exportFeederStop_{false};
+    std::atomic<bool> exportFeeding_{false};
+    ResultsIndex resultsIndex;
     
 public:
     // Detection and tracking
     std::unique_ptr<DetectionTracker> detector_;
     std::vector<TrackedObject> current_tracked_objects_;
+    std::vector<TrackedObject> processed_tracked_objects_;
     bool detection_initialized_ = false;
 
 private:
@@ -389,6 +1058,7 @@ private:
     QSlider* frameSlider;
     QLabel* frameInfoLabel;
     QTimer* videoTimer;
+    QTimer* analysisPollTimer;
 };
 
 class MainWindow : public QMainWindow {
@@ -400,6 +1070,8 @@ public:
         setupMenuBar();
         setupStatusBar();
         loadSettings();
+        MetricsRegistry::global().startSampler();
+        ResourceSampler::global().start();
     }
 
     ~MainWindow() {
@@ -437,6 +1109,20 @@ private slots:
         }
     }
 
+    // New weights are loaded and warmed up in the background, then switched
+    // in between two frames; playback and tracks carry on
+    void loadModel() {
+        QString path = QFileDialog::getOpenFileName(this, "Load Detection Model", "models",
+                                                    "ONNX Models (*.onnx);;All Files (*)");
+        if (path.isEmpty()) return;
+        if (!videoPlayer->swapModel(path.toStdString())) {
+            QMessageBox::warning(this, "Load Detection Model",
+                "Could not load " + path + " (a model switch may already be in progress).");
+            return;
+        }
+        statusBar()->showMessage("Loading " + QFileInfo(path).fileName() + " in the background...");
+    }
+
     void onFileSelected(const QModelIndex& index) {
         QString filePath = fileSystemModel->filePath(index);
         if (QFileInfo(filePath).isFile()) {
@@ -458,6 +1144,10 @@ private slots:
         videoPlayer->setConfidenceThreshold(value);
     }
 
+    void onNMSThresholdChanged(double value) {
+        videoPlayer->setNMSThreshold(value);
+    }
+
     void onHighPerformanceChanged(bool enabled) {
         DetectionTracker* detector = getDetector();
         if (detector) {
@@ -472,40 +1162,467 @@ private slots:
         }
     }
 
-    void onOptimizeClicked() {
+    void onMotionGatingChanged(bool enabled) {
         DetectionTracker* detector = getDetector();
         if (detector) {
-            // Optimize for 16GB RAM system
-            detector->enableHighPerformanceMode(true);
-            detector->setThreadCount(std::thread::hardware_concurrency());
-            detector->setBufferSize(500); // Large buffer for 16GB RAM
-            
-            // Update UI
-            highPerformanceCheckBox->setChecked(true);
-            threadCountSpinBox->setValue(std::thread::hardware_concurrency());
-            
-            QMessageBox::information(this, "Optimization Complete", 
-                "System optimized for 16GB RAM:\n"
-                "- High performance mode enabled\n"
-                "- Maximum thread count set\n"
-                "- Large buffer allocation\n"
-                "- Memory optimizations active");
+            detector->enableMotionGating(enabled);
+        }
+    }
+
+    void onTiledInferenceChanged(bool enabled) {
+        DetectionTracker* detector = getDetector();
+        if (detector) {
+            detector->enableTiledInference(enabled);
+        }
+    }
+
+    void onPipelineDepthChanged(int depth) {
+        videoPlayer->setPipelineDepth(depth);
+    }
+
+    void onAttributesChanged(bool enabled) {
+        if (!videoPlayer->setAttributeClassification(enabled)) {
+            QSignalBlocker blocker(attributesCheckBox);
+            attributesCheckBox->setChecked(false);
+            QMessageBox::warning(this, "Vehicle Attributes",
+                "Could not load the attribute model (models/vehicle-attributes.onnx).");
+        }
+    }
+
+    void onCascadeChanged(bool enabled) {
+        if (!videoPlayer->setCascade(enabled)) {
+            QSignalBlocker blocker(cascadeCheckBox);
+            cascadeCheckBox->setChecked(false);
+            QMessageBox::warning(this, "Cascade Detection",
+                "Could not load the refinement model (models/yolov8m.onnx).");
+        }
+    }
+
+    void onDetectionIntervalChanged(int frames) {
+        videoPlayer->setDetectionInterval(frames);
+    }
+
+    void onMotionVectorsChanged(bool enabled) {
+        if (!videoPlayer->setMotionVectorPropagation(enabled)) {
+            statusBar()->showMessage("Codec motion vectors unavailable, boxes follow track velocity instead");
+        }
+    }
+
+    // Let the overload controller step quality down when frames run late
+    void onAdaptiveQualityChanged(bool enabled) {
+        videoPlayer->setAdaptiveQuality(enabled);
+    }
+
+    // Benchmark detector configurations on frames from the open video and
+    // keep the fastest; the result is remembered per machine and model
+    void onOptimizeClicked() {
+        DetectionTracker* detector = getDetector();
+        if (!detector || !videoPlayer->hasVideo()) {
+            QMessageBox::information(this, "Auto-Tune", "Open a video first; it is used to benchmark the detector.");
+            return;
+        }
+        if (!detector->hasModel()) {
+            QMessageBox::warning(this, "Auto-Tune", "No detection model is loaded, so there is nothing to tune.");
+            return;
+        }
+
+        QSettings settings;
+        QString key = tuningKey();
+        if (settings.contains(key + "/threads")) {
+            auto answer = QMessageBox::question(this, "Auto-Tune",
+                QString("A tuned configuration for this machine and model already exists (%1 FPS).\n"
+                        "Run the benchmark again?")
+                    .arg(settings.value(key + "/fps").toDouble(), 0, 'f', 1));
+            if (answer != QMessageBox::Yes) {
+                applySavedTuning();
+                return;
+            }
+        }
+
+        videoPlayer->pause();
+        std::vector<cv::Mat> frames = videoPlayer->sampleFrames(8);
+        if (frames.empty()) {
+            QMessageBox::warning(this, "Auto-Tune", "Could not read frames from the video.");
+            return;
+        }
+
+        double targetFps = std::max(1.0, videoPlayer->getVideoFPS());
+        AutoTuner tuner;
+        tuner.setTargetFPS(targetFps);
+
+        QProgressDialog progress("Benchmarking detector configurations...", "Cancel", 0, 1, this);
+        progress.setWindowModality(Qt::WindowModal);
+        progress.setMinimumDuration(0);
+        tuner.setProgressCallback([&progress](int done, int planned, const std::string& status) {
+            progress.setMaximum(planned);
+            progress.setValue(done);
+            progress.setLabelText(QString::fromStdString(status));
+            QApplication::processEvents();
+            return !progress.wasCanceled();
+        });
+
+        TuningTrial result;
+        bool tuned = tuner.tune(*detector, frames, result);
+        progress.setValue(progress.maximum());
+        if (!tuned) {
+            statusBar()->showMessage(progress.wasCanceled() ? "Auto-tune cancelled, previous settings kept"
+                                                            : "Auto-tune failed, previous settings kept");
+            return;
+        }
+
+        const TuningConfig& best = result.config;
+        settings.setValue(key + "/backend", best.backend);
+        settings.setValue(key + "/target", best.target);
+        settings.setValue(key + "/threads", best.threads);
+        settings.setValue(key + "/inputWidth", best.input_size.width);
+        settings.setValue(key + "/inputHeight", best.input_size.height);
+        settings.setValue(key + "/pipelineDepth", best.pipeline_depth);
+        settings.setValue(key + "/fps", result.fps);
+        settings.setValue(key + "/latencyMs", result.latency_ms);
+        settings.setValue(key + "/targetFps", targetFps);
+        syncTuningControls(best);
+
+        QString message = QString("Chose %1\n%2 FPS, %3 ms per frame (target %4 FPS)\n\nTrials:\n")
+                              .arg(QString::fromStdString(best.describe()))
+                              .arg(result.fps, 0, 'f', 1)
+                              .arg(result.latency_ms, 0, 'f', 1)
+                              .arg(targetFps, 0, 'f', 1);
+        for (const auto& trial : tuner.trials()) {
+            message += trial.ok ? QString("- %1: %2 FPS, %3 ms\n")
+                                      .arg(QString::fromStdString(trial.config.describe()))
+                                      .arg(trial.fps, 0, 'f', 1)
+                                      .arg(trial.latency_ms, 0, 'f', 1)
+                                : QString("- %1: failed\n").arg(QString::fromStdString(trial.config.describe()));
+        }
+        QMessageBox::information(this, "Auto-Tune Complete", message);
+    }
+
+    // Reuse a previous auto-tune result so restarts skip the search
+    void applySavedTuning() {
+        DetectionTracker* detector = getDetector();
+        if (!detector || !detector->hasModel()) return;
+
+        QSettings settings;
+        QString key = tuningKey();
+        if (!settings.contains(key + "/threads")) return;
+
+        TuningConfig config{settings.value(key + "/backend").toInt(),
+                            settings.value(key + "/target").toInt(),
+                            settings.value(key + "/threads").toInt(),
+                            cv::Size(settings.value(key + "/inputWidth").toInt(),
+                                     settings.value(key + "/inputHeight").toInt()),
+                            settings.value(key + "/pipelineDepth", 1).toInt()};
+        if (config.threads <= 0 || config.input_size.area() <= 0) return;
+
+        videoPlayer->pause();
+        AutoTuner::apply(*detector, config);
+        syncTuningControls(config);
+        statusBar()->showMessage("Applied saved auto-tune result: " + QString::fromStdString(config.describe()));
+    }
+
+    // Spans from every pipeline thread, written as Chrome trace JSON when
+    // recording stops (open in ui.perfetto.dev or chrome://tracing)
+    void onRecordTraceToggled(bool recording) {
+        saveTraceWindowAction->setEnabled(recording);
+        if (recording) {
+            TraceRecorder::global().start();
+            statusBar()->showMessage("Recording trace...");
+            return;
+        }
+        TraceRecorder::global().stop();
+        saveTrace(std::chrono::milliseconds(0));
+    }
+
+    void saveTrace(std::chrono::milliseconds lastWindow) {
+        QString path = QFileDialog::getSaveFileName(this, "Save Trace", lastDirectory + "/trace.json",
+                                                    "Chrome Trace (*.json)");
+        if (path.isEmpty()) return;
+        if (TraceRecorder::global().writeChromeTrace(path.toStdString(), lastWindow)) {
+            statusBar()->showMessage("Trace saved to " + path);
+        } else {
+            QMessageBox::warning(this, "Trace", "Could not write " + path);
+        }
+    }
+
+    // Tracks of every processed frame go to the file until unchecked; with a
+    // parallel analysis loaded the whole video is written in the background
+    void onExportResultsToggled(bool exporting) {
+        if (!exporting) {
+            if (!videoPlayer->isExportingResults()) return;
+            ExportStats stats = videoPlayer->stopResultExport();
+            statusBar()->showMessage(QString("Exported %1 rows from %2 frames (%3 KB, %4 rows/s, %5 dropped)")
+                                     .arg(stats.rows_written).arg(stats.frames_written)
+                                     .arg(stats.bytes_written / 1024)
+                                     .arg(stats.rowsPerSecond(), 0, 'f', 0)
+                                     .arg(stats.dropped_frames));
+            return;
+        }
+
+        QString path = QFileDialog::getSaveFileName(this, "Export Results", lastDirectory + "/results.parquet",
+                                                    "Parquet (*.parquet);;Arrow IPC Stream (*.arrows *.arrow)");
+        if (path.isEmpty() || !videoPlayer->startResultExport(path.toStdString())) {
+            if (!path.isEmpty()) {
+                QMessageBox::warning(this, "Export Results", "Could not open " + path);
+            }
+            QSignalBlocker blocker(exportResultsAction);
+            exportResultsAction->setChecked(false);
+            return;
+        }
+        statusBar()->showMessage("Exporting results to " + path);
+    }
+
+    // Query the results index by class, track, time window and zone; activating
+    // a hit jumps the player to its first frame
+    void onSearchResultsClicked() {
+        const ResultsIndex* index = &videoPlayer->getResultsIndex();
+        if (index->empty()) {
+            QMessageBox::information(this, "Search Results",
+                "Nothing indexed yet. Play the video with annotations on, or run a parallel analysis.");
+            return;
+        }
+
+        double fps = std::max(1.0, videoPlayer->getVideoFPS());
+        double duration = (index->lastFrame() + 1) / fps;
+        cv::Size frameSize = videoPlayer->getFrameSize();
+        auto formatTime = [](double seconds) {
+            int minutes = static_cast<int>(seconds / 60.0);
+            return QString("%1:%2").arg(minutes).arg(seconds - minutes * 60.0, 4, 'f', 1, QChar('0'));
+        };
+
+        QDialog* dialog = new QDialog(this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->setWindowTitle("Search Results");
+        QVBoxLayout* layout = new QVBoxLayout(dialog);
+        QFormLayout* form = new QFormLayout();
+
+        QComboBox* classCombo = new QComboBox();
+        classCombo->addItem("Any", -1);
+        for (const auto& entry : index->classNames()) {
+            classCombo->addItem(QString::fromStdString(entry.second), entry.first);
+        }
+        form->addRow("Class:", classCombo);
+
+        QSpinBox* trackSpin = new QSpinBox();
+        trackSpin->setRange(-1, std::numeric_limits<int>::max());
+        trackSpin->setSpecialValueText("Any");
+        trackSpin->setValue(-1);
+        form->addRow("Track ID:", trackSpin);
+
+        QDoubleSpinBox* fromSpin = new QDoubleSpinBox();
+        QDoubleSpinBox* toSpin = new QDoubleSpinBox();
+        for (QDoubleSpinBox* spin : {fromSpin, toSpin}) {
+            spin->setRange(0.0, duration);
+            spin->setDecimals(1);
+            spin->setSuffix(" s");
+        }
+        toSpin->setValue(duration);
+        QHBoxLayout* timeLayout = new QHBoxLayout();
+        timeLayout->addWidget(fromSpin);
+        timeLayout->addWidget(new QLabel("to"));
+        timeLayout->addWidget(toSpin);
+        form->addRow("Time:", timeLayout);
+
+        // Zone in frame pixels; a box matches when its centre is inside
+        QCheckBox* zoneCheck = new QCheckBox("Only in zone");
+        QSpinBox* zoneX = new QSpinBox();
+        QSpinBox* zoneY = new QSpinBox();
+        QSpinBox* zoneW = new QSpinBox();
+        QSpinBox* zoneH = new QSpinBox();
+        QHBoxLayout* zoneLayout = new QHBoxLayout();
+        zoneLayout->addWidget(zoneCheck);
+        for (QSpinBox* spin : {zoneX, zoneY, zoneW, zoneH}) {
+            spin->setRange(0, 16384);
+            spin->setEnabled(false);
+            connect(zoneCheck, &QCheckBox::toggled, spin, &QSpinBox::setEnabled);
+            zoneLayout->addWidget(spin);
+        }
+        zoneX->setPrefix("x ");
+        zoneY->setPrefix("y ");
+        zoneW->setPrefix("w ");
+        zoneH->setPrefix("h ");
+        zoneW->setValue(frameSize.width);
+        zoneH->setValue(frameSize.height);
+        form->addRow("Zone:", zoneLayout);
+        layout->addLayout(form);
+
+        QPushButton* searchButton = new QPushButton("Search");
+        searchButton->setDefault(true);
+        layout->addWidget(searchButton);
+        QListWidget* hitList = new QListWidget();
+        layout->addWidget(hitList);
+        QLabel* summaryLabel = new QLabel();
+        layout->addWidget(summaryLabel);
+
+        connect(searchButton, &QPushButton::clicked, dialog, [=]() {
+            ResultsQuery query;
+            if (classCombo->currentData().toInt() >= 0) {
+                query.class_ids.push_back(classCombo->currentData().toInt());
+            }
+            if (trackSpin->value() >= 0) {
+                query.track_ids.push_back(trackSpin->value());
+            }
+            query.begin_ms = fromSpin->value() * 1000.0;
+            query.end_ms = toSpin->value() >= toSpin->maximum() ? std::numeric_limits<double>::max()
+                                                       : toSpin->value() * 1000.0;
+            if (zoneCheck->isChecked()) {
+                query.zone = cv::Rect(zoneX->value(), zoneY->value(), zoneW->value(), zoneH->value());
+            }
+            query.max_gap = static_cast<int>(fps);
+
+            ResultsQueryResult result = index->query(query);
+            hitList->clear();
+            for (const auto& hit : result.hits) {
+                auto name = index->classNames().find(hit.class_id);
+                QListWidgetItem* item = new QListWidgetItem(
+                    QString("Track %1 (%2)  %3 - %4  frames %5-%6")
+                        .arg(hit.track_id)
+                        .arg(name != index->classNames().end() ? QString::fromStdString(name->second) : "?")
+                        .arg(formatTime(hit.frames.begin / fps))
+                        .arg(formatTime(hit.frames.end / fps))
+                        .arg(hit.frames.begin)
+                        .arg(hit.frames.end));
+                item->setData(Qt::UserRole, hit.frames.begin);
+                hitList->addItem(item);
+            }
+            summaryLabel->setText(QString("%1 hits, %2 tracks, %3 frame ranges in %4 ms (%5 of %6 boxes scanned)")
+                                  .arg(result.hits.size()).arg(result.track_ids.size()).arg(result.ranges.size())
+                                  .arg(result.elapsed_ms, 0, 'f', 2)
+                                  .arg(result.observations_scanned).arg(index->observationCount()));
+        });
+        connect(hitList, &QListWidget::itemActivated, this, [this](QListWidgetItem* item) {
+            videoPlayer->jumpToFrame(item->data(Qt::UserRole).toInt());
+        });
+
+        dialog->resize(620, 480);
+        dialog->show();
+    }
+
+    void onParallelAnalysisClicked() {
+        int chunks = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        if (!videoPlayer->startParallelAnalysis(chunks)) {
+            QMessageBox::warning(this, "Parallel Analysis",
+                "Open a video first, and wait for any running analysis to finish.");
+            return;
+        }
+        statusBar()->showMessage(QString("Analysing video in %1 parallel chunks...").arg(chunks));
+    }
+
+    void onAnalysisProgress(int percent) {
+        statusBar()->showMessage(QString("Parallel analysis: %1%").arg(percent));
+    }
+
+    void onAnalysisCompleted(bool success, double elapsedMs, int tracks) {
+        if (success) {
+            statusBar()->showMessage(QString("Parallel analysis finished in %1 s (%2 tracks)")
+                                     .arg(elapsedMs / 1000.0, 0, 'f', 1).arg(tracks));
+        } else {
+            statusBar()->showMessage("Parallel analysis failed or was cancelled");
         }
     }
 
     void updatePerformanceMetrics() {
         DetectionTracker* detector = getDetector();
         if (detector) {
-            fpsLabel->setText(QString("FPS: %1").arg(detector->getFPS(), 0, 'f', 1));
-            latencyLabel->setText(QString("Detection: %1ms | Tracking: %2ms")
-                                .arg(detector->getDetectionTime(), 0, 'f', 1)
-                                .arg(detector->getTrackingTime(), 0, 'f', 1));
-            frameCountLabel->setText(QString("Active Tracks: %1")
-                                   .arg(detector->getActiveTracks()));
+            // Headline numbers come from the shared registry, which also keeps their history
+            MetricsRegistry& metrics = MetricsRegistry::global();
+            MetricSnapshot detection, tracking;
+            metrics.read("detector_detection_ms", detection);
+            metrics.read("detector_tracking_ms", tracking);
+            fpsLabel->setText(QString("FPS: %1 (1 min avg %2)")
+                            .arg(metrics.value("detector_fps"), 0, 'f', 1)
+                            .arg(recentAverage(metrics.history("detector_fps", Resolution::Second), 60), 0, 'f', 1));
+            latencyLabel->setText(QString("Detection: %1ms (p95 %2ms) | Tracking: %3ms")
+                                .arg(recentAverage(metrics.history("detector_detection_ms", Resolution::Second), 1), 0, 'f', 1)
+                                .arg(detection.histogram.quantile(0.95), 0, 'f', 1)
+                                .arg(recentAverage(metrics.history("detector_tracking_ms", Resolution::Second), 1), 0, 'f', 1));
+            frameCountLabel->setText(QString("Active Tracks: %1 | %2 frames, %3 inferred")
+                                   .arg(static_cast<int>(metrics.value("detector_active_tracks")))
+                                   .arg(static_cast<qulonglong>(metrics.value("detector_frames_total")))
+                                   .arg(static_cast<qulonglong>(metrics.value("detector_inferences_total"))));
+            if (detector->isMotionGatingEnabled()) {
+                motionGateLabel->setText(QString("Motion gate: %1% skipped (%2 frames)")
+                                       .arg(detector->getMotionSkipRate() * 100.0, 0, 'f', 1)
+                                       .arg(detector->getSkippedInferences()));
+            } else {
+                motionGateLabel->setText("Motion gate: off");
+            }
+            if (detector->isTiledInferenceEnabled()) {
+                tileLabel->setText(QString("Tiles reused: %1%")
+                                 .arg(detector->getTileReuseRate() * 100.0, 0, 'f', 1));
+            } else {
+                tileLabel->setText("Tiled inference: off");
+            }
+            if (detector->getDetectionInterval() > 1) {
+                propagationLabel->setText(QString("Propagated: %1 frames | %2% boxes by motion vectors")
+                                        .arg(detector->getPropagatedFrames())
+                                        .arg(detector->getMotionVectorCoverage() * 100.0, 0, 'f', 1));
+            } else {
+                propagationLabel->setText("Detecting every frame");
+            }
+            if (detector->isCascadeEnabled()) {
+                cascadeLabel->setText(QString("Cascade: %1 crops/frame | %2ms")
+                                    .arg(detector->getCascadeCropsPerFrame(), 0, 'f', 1)
+                                    .arg(detector->getCascadeTime(), 0, 'f', 1));
+            } else {
+                cascadeLabel->setText("Cascade: off");
+            }
+            if (detector->isAttributeClassificationEnabled()) {
+                const AttributeClassifier& attributes = detector->attributeClassifier();
+                attributeLabel->setText(QString("Attributes: %1 crops classified | %2 reused | %3 too small")
+                                      .arg(attributes.getClassifiedCrops())
+                                      .arg(attributes.getCacheHits())
+                                      .arg(attributes.getSkippedSmall()));
+            } else {
+                attributeLabel->setText("Attributes: off");
+            }
+            if (detector->getModelSwaps() != lastModelSwaps) {
+                lastModelSwaps = detector->getModelSwaps();
+                statusBar()->showMessage("Detector switched to " +
+                                         QFileInfo(QString::fromStdString(detector->getModelPath())).fileName());
+            }
+            if (videoPlayer->isAdaptiveQualityEnabled()) {
+                const OverloadController& overload = videoPlayer->getOverloadController();
+                qualityLabel->setText(QString("Quality: %1 | %2 changes | %3 frames dropped")
+                                    .arg(OverloadController::levelName(overload.level()))
+                                    .arg(overload.transitions())
+                                    .arg(videoPlayer->getSkippedFrames()));
+            } else {
+                qualityLabel->setText("Adaptive quality: off");
+            }
+            if (detector->getPipelineDepth() > 1) {
+                pipelineLabel->setText(QString("Pipeline: %1ms end-to-end | +%2ms queued")
+                                     .arg(detector->getPipelineLatency(), 0, 'f', 1)
+                                     .arg(detector->getPipelineAddedLatency(), 0, 'f', 1));
+            } else {
+                pipelineLabel->setText("Pipeline: off");
+            }
+        }
+        
+        // Busiest named thread shows which stage is saturating its core
+        if (ResourceSampler::isSupported()) {
+            ResourceUsage usage = ResourceSampler::global().latest();
+            QString busiest = usage.threads.empty()
+                                  ? QString()
+                                  : QString(" | %1 %2%").arg(QString::fromStdString(usage.threads.front().name))
+                                                        .arg(usage.threads.front().cpuPercent, 0, 'f', 0);
+            resourceLabel->setText(QString("CPU %1% | RSS %2 MB%3")
+                                 .arg(usage.cpuPercent, 0, 'f', 0)
+                                 .arg(usage.rssBytes / (1024.0 * 1024.0), 0, 'f', 0)
+                                 .arg(busiest));
         }
     }
 
 private:
+    // Mean of the newest samples of a registry history
+    static double recentAverage(const std::vector<float>& history, size_t samples) {
+        if (history.empty()) {
+            return 0.0;
+        }
+        samples = std::min(samples, history.size());
+        double sum = std::accumulate(history.end() - samples, history.end(), 0.0);
+        return sum / samples;
+    }
+
     void setupUI() {
         setWindowTitle("Professional Video Analysis");
         setMinimumSize(1200, 800);
@@ -565,6 +1682,15 @@ private:
         controlsLayout->addWidget(confidenceLabel);
         controlsLayout->addWidget(confidenceSpinBox);
         
+        QLabel* nmsLabel = new QLabel("NMS Threshold:");
+        nmsSpinBox = new QDoubleSpinBox;
+        nmsSpinBox->setRange(0.0, 1.0);
+        nmsSpinBox->setSingleStep(0.05);
+        nmsSpinBox->setValue(0.4);
+        nmsSpinBox->setDecimals(2);
+        controlsLayout->addWidget(nmsLabel);
+        controlsLayout->addWidget(nmsSpinBox);
+        
         rightLayout->addWidget(controlsGroup);
         
         // Performance group
@@ -574,10 +1700,26 @@ private:
         fpsLabel = new QLabel("FPS: 0.0");
         latencyLabel = new QLabel("Latency: 0ms");
         frameCountLabel = new QLabel("Frame Count: 0");
+        pipelineLabel = new QLabel("Pipeline: off");
+        motionGateLabel = new QLabel("Motion gate: off");
+        tileLabel = new QLabel("Tiled inference: off");
+        propagationLabel = new QLabel("Detecting every frame");
+        attributeLabel = new QLabel("Attributes: off");
+        cascadeLabel = new QLabel("Cascade: off");
+        resourceLabel = new QLabel("CPU: n/a");
+        qualityLabel = new QLabel("Adaptive quality: off");
         
         performanceLayout->addWidget(fpsLabel);
         performanceLayout->addWidget(latencyLabel);
         performanceLayout->addWidget(frameCountLabel);
+        performanceLayout->addWidget(pipelineLabel);
+        performanceLayout->addWidget(motionGateLabel);
+        performanceLayout->addWidget(tileLabel);
+        performanceLayout->addWidget(propagationLabel);
+        performanceLayout->addWidget(attributeLabel);
+        performanceLayout->addWidget(cascadeLabel);
+        performanceLayout->addWidget(resourceLabel);
+        performanceLayout->addWidget(qualityLabel);
         
         rightLayout->addWidget(performanceGroup);
         
@@ -589,6 +1731,12 @@ private:
         highPerformanceCheckBox->setChecked(true);
         optimizationLayout->addWidget(highPerformanceCheckBox);
         
+        motionGatingCheckBox = new QCheckBox("Motion-Gated Inference (static camera)");
+        optimizationLayout->addWidget(motionGatingCheckBox);
+        
+        tiledInferenceCheckBox = new QCheckBox("Tiled Incremental Inference");
+        optimizationLayout->addWidget(tiledInferenceCheckBox);
+        
         QLabel* threadLabel = new QLabel("Thread Count:");
         threadCountSpinBox = new QSpinBox;
         threadCountSpinBox->setRange(1, 16);
@@ -596,7 +1744,34 @@ private:
         optimizationLayout->addWidget(threadLabel);
         optimizationLayout->addWidget(threadCountSpinBox);
         
-        optimizeButton = new QPushButton("Optimize for 16GB RAM");
+        attributesCheckBox = new QCheckBox("Vehicle Color/Type Attributes");
+        optimizationLayout->addWidget(attributesCheckBox);
+        
+        cascadeCheckBox = new QCheckBox("Cascade Re-detection (larger model)");
+        optimizationLayout->addWidget(cascadeCheckBox);
+        
+        adaptiveQualityCheckBox = new QCheckBox("Adaptive Quality (shed detail to stay real-time)");
+        optimizationLayout->addWidget(adaptiveQualityCheckBox);
+        
+        QLabel* detectionIntervalLabel = new QLabel("Detect Every N Frames:");
+        detectionIntervalSpinBox = new QSpinBox;
+        detectionIntervalSpinBox->setRange(1, 10);
+        detectionIntervalSpinBox->setValue(1);
+        optimizationLayout->addWidget(detectionIntervalLabel);
+        optimizationLayout->addWidget(detectionIntervalSpinBox);
+        
+        motionVectorsCheckBox = new QCheckBox("Propagate Boxes with Codec Motion Vectors");
+        motionVectorsCheckBox->setEnabled(MotionVectorReader::isSupported());
+        optimizationLayout->addWidget(motionVectorsCheckBox);
+        
+        QLabel* pipelineDepthLabel = new QLabel("Pipeline Depth (latency vs throughput):");
+        pipelineDepthSpinBox = new QSpinBox;
+        pipelineDepthSpinBox->setRange(1, 4);
+        pipelineDepthSpinBox->setValue(1);
+        optimizationLayout->addWidget(pipelineDepthLabel);
+        optimizationLayout->addWidget(pipelineDepthSpinBox);
+        
+        optimizeButton = new QPushButton("Auto-Tune Performance");
         optimizationLayout->addWidget(optimizeButton);
         
         rightLayout->addWidget(optimizationGroup);
@@ -614,10 +1789,25 @@ private:
         connect(showAnnotationsCheckBox, &QCheckBox::toggled, this, &MainWindow::onShowAnnotationsChanged);
         connect(confidenceSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
                 this, &MainWindow::onConfidenceThresholdChanged);
+        connect(nmsSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), 
+                this, &MainWindow::onNMSThresholdChanged);
         connect(highPerformanceCheckBox, &QCheckBox::toggled, this, &MainWindow::onHighPerformanceChanged);
         connect(threadCountSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), 
                 this, &MainWindow::onThreadCountChanged);
+        connect(motionGatingCheckBox, &QCheckBox::toggled, this, &MainWindow::onMotionGatingChanged);
+        connect(tiledInferenceCheckBox, &QCheckBox::toggled, this, &MainWindow::onTiledInferenceChanged);
+        connect(pipelineDepthSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), 
+                this, &MainWindow::onPipelineDepthChanged);
+        connect(detectionIntervalSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), 
+                this, &MainWindow::onDetectionIntervalChanged);
+        connect(motionVectorsCheckBox, &QCheckBox::toggled, this, &MainWindow::onMotionVectorsChanged);
+        connect(attributesCheckBox, &QCheckBox::toggled, this, &MainWindow::onAttributesChanged);
+        connect(cascadeCheckBox, &QCheckBox::toggled, this, &MainWindow::onCascadeChanged);
+        connect(adaptiveQualityCheckBox, &QCheckBox::toggled, this, &MainWindow::onAdaptiveQualityChanged);
         connect(optimizeButton, &QPushButton::clicked, this, &MainWindow::onOptimizeClicked);
+        connect(videoPlayer, &VideoPlayerWidget::analysisProgress, this, &MainWindow::onAnalysisProgress);
+        connect(videoPlayer, &VideoPlayerWidget::analysisCompleted, this, &MainWindow::onAnalysisCompleted);
+        connect(videoPlayer, &VideoPlayerWidget::detectorInitialized, this, &MainWindow::applySavedTuning);
         
         // Setup performance monitoring timer
         performanceTimer = new QTimer(this);
@@ -640,6 +1830,10 @@ private:
         connect(openDirectoryAction, &QAction::triggered, this, &MainWindow::openDirectory);
         fileMenu->addAction(openDirectoryAction);
         
+        QAction* loadModelAction = new QAction("Load Detection &Model...", this);
+        connect(loadModelAction, &QAction::triggered, this, &MainWindow::loadModel);
+        fileMenu->addAction(loadModelAction);
+        
         fileMenu->addSeparator();
         
         QAction* exitAction = new QAction("E&xit", this);
@@ -647,6 +1841,43 @@ private:
         connect(exitAction, &QAction::triggered, this, &QApplication::quit);
         fileMenu->addAction(exitAction);
         
+        // Analysis menu
+        QMenu* analysisMenu = menuBar->addMenu("&Analysis");
+        
+        QAction* parallelAnalysisAction = new QAction("Analyse Full Video (&Parallel)", this);
+        connect(parallelAnalysisAction, &QAction::triggered, this, &MainWindow::onParallelAnalysisClicked);
+        analysisMenu->addAction(parallelAnalysisAction);
+        
+        QAction* searchResultsAction = new QAction("&Search Results...", this);
+        searchResultsAction->setShortcut(QKeySequence::Find);
+        connect(searchResultsAction, &QAction::triggered, this, &MainWindow::onSearchResultsClicked);
+        analysisMenu->addAction(searchResultsAction);
+        
+        analysisMenu->addSeparator();
+        
+        QAction* recordTraceAction = new QAction("&Record Trace", this);
+        recordTraceAction->setCheckable(true);
+        connect(recordTraceAction, &QAction::toggled, this, &MainWindow::onRecordTraceToggled);
+        analysisMenu->addAction(recordTraceAction);
+        
+        saveTraceWindowAction = new QAction("Save &Last 10 Seconds of Trace...", this);
+        saveTraceWindowAction->setEnabled(false);
+        connect(saveTraceWindowAction, &QAction::triggered, [this]() {
+            saveTrace(std::chrono::seconds(10));
+        });
+        analysisMenu->addAction(saveTraceWindowAction);
+        
+        analysisMenu->addSeparator();
+        
+        exportResultsAction = new QAction("&Export Results (Arrow/Parquet)...", this);
+        exportResultsAction->setCheckable(true);
+        exportResultsAction->setEnabled(ArrowExporter::isSupported());
+        if (!ArrowExporter::isSupported()) {
+            exportResultsAction->setToolTip("Built without Apache Arrow");
+        }
+        connect(exportResultsAction, &QAction::toggled, this, &MainWindow::onExportResultsToggled);
+        analysisMenu->addAction(exportResultsAction);
+        
         // Help menu
         QMenu* helpMenu = menuBar->addMenu("&Help");
         
@@ -669,6 +1900,32 @@ private:
         statusBar()->showMessage("Ready");
     }
 
+    // Settings group for auto-tune results: machine and model file contents
+    QString tuningKey() const {
+        QString machine = QString("%1-%2-%3")
+                              .arg(QSysInfo::machineHostName())
+                              .arg(QSysInfo::currentCpuArchitecture())
+                              .arg(std::thread::hardware_concurrency());
+        machine.replace('/', '_');
+
+        QString modelHash = "none";
+        QFile model(QString::fromStdString(videoPlayer->getModelPath()));
+        if (model.open(QIODevice::ReadOnly)) {
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(&model);
+            modelHash = hash.result().toHex();
+        }
+        return "autotune/" + machine + "/" + modelHash;
+    }
+
+    // Reflect a tuning result in the controls without re-applying it
+    void syncTuningControls(const TuningConfig& config) {
+        QSignalBlocker threadBlocker(threadCountSpinBox);
+        QSignalBlocker depthBlocker(pipelineDepthSpinBox);
+        threadCountSpinBox->setValue(config.threads);
+        pipelineDepthSpinBox->setValue(config.pipeline_depth);
+    }
+
     void loadSettings() {
         QSettings settings;
         lastDirectory = settings.value("lastDirectory", QDir::homePath()).toString();
@@ -693,18 +1950,38 @@ private:
     QTreeView* fileTreeView;
     QCheckBox* showAnnotationsCheckBox;
     QDoubleSpinBox* confidenceSpinBox;
+    QDoubleSpinBox* nmsSpinBox;
     QLabel* fpsLabel;
     QLabel* latencyLabel;
     QLabel* frameCountLabel;
+    QLabel* pipelineLabel;
+    QLabel* motionGateLabel;
+    QLabel* tileLabel;
+    QLabel* propagationLabel;
+    QLabel* attributeLabel;
+    QLabel* cascadeLabel;
+    QLabel* resourceLabel;
+    QLabel* qualityLabel;
+    QAction* saveTraceWindowAction;
+    QAction* exportResultsAction;
     QTimer* performanceTimer;
     
     // Performance controls
     QCheckBox* highPerformanceCheckBox;
+    QCheckBox* motionGatingCheckBox;
+    QCheckBox* tiledInferenceCheckBox;
     QSpinBox* threadCountSpinBox;
+    QSpinBox* pipelineDepthSpinBox;
+    QSpinBox* detectionIntervalSpinBox;
+    QCheckBox* motionVectorsCheckBox;
+    QCheckBox* attributesCheckBox;
+    QCheckBox* cascadeCheckBox;
+    QCheckBox* adaptiveQualityCheckBox;
     QPushButton* optimizeButton;
     
     // Settings
     QString lastDirectory;
+    long lastModelSwaps = 0;
 };
 
 int main(int argc, char *argv[]) {
@@ -739,9 +2016,28 @@ int main(int argc, char *argv[]) {
     MainWindow window;
     window.show();
     
+    // Command line: [--metrics-port N] [video file]
+    QString filePath;
+    int metricsPort = -1;
+    QStringList arguments = app.arguments();
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments[i] == "--metrics-port" && i + 1 < arguments.size()) {
+            metricsPort = arguments[++i].toInt();
+        } else if (arguments[i].startsWith("--metrics-port=")) {
+            metricsPort = arguments[i].section('=', 1).toInt();
+        } else {
+            filePath = arguments[i];
+        }
+    }
+    
+    // Prometheus scrape endpoint, off unless asked for
+    MetricsHttpServer metricsServer;
+    if (metricsPort >= 0) {
+        metricsServer.start(metricsPort);
+    }
+    
     // Load video file if provided as command line argument
-    if (argc > 1) {
-        QString filePath = QString::fromLocal8Bit(argv[1]);
+    if (!filePath.isEmpty()) {
         if (QFileInfo(filePath).exists()) {
             window.videoPlayer->loadVideo(filePath);
             window.setWindowTitle("Professional Video Analysis - " + QFileInfo(filePath).fileName());
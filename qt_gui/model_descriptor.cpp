@@ -0,0 +1,237 @@
+#include "model_descriptor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool skipField(std::istream& in, int wire_type) {
+    uint64_t length = 0;
+    switch (wire_type) {
+        case 0:
+            return readVarint(in, length);
+        case 1:
+            in.seekg(8, std::ios::cur);
+            return static_cast<bool>(in);
+        case 2:
+            if (!readVarint(in, length)) {
+                return false;
+            }
+            in.seekg(static_cast<std::streamoff>(length), std::ios::cur);
+            return static_cast<bool>(in);
+        case 5:
+            in.seekg(4, std::ios::cur);
+            return static_cast<bool>(in);
+        default:
+            return false;  // groups are not used by ONNX
+    }
+}
+
+// StringStringEntryProto { string key = 1; string value = 2; }
+void parseEntry(const std::string& bytes, std::map<std::string, std::string>& metadata) {
+    std::istringstream in(bytes);
+    std::string key, value;
+    uint64_t tag = 0;
+    while (readVarint(in, tag)) {
+        int field = static_cast<int>(tag >> 3);
+        int wire_type = static_cast<int>(tag & 0x7);
+        if ((field == 1 || field == 2) && wire_type == 2) {
+            uint64_t length = 0;
+            if (!readVarint(in, length)) {
+                break;
+            }
+            std::string text(length, '\0');
+            in.read(&text[0], static_cast<std::streamsize>(length));
+            (field == 1 ? key : value) = text;
+        } else if (!skipField(in, wire_type)) {
+            break;
+        }
+    }
+    if (!key.empty()) {
+        metadata[key] = value;
+    }
+}
+
+// Python dict literal written by Ultralytics: {0: 'person', 1: 'bicycle', ...}
+std::vector<std::string> parseNames(const std::string& text) {
+    std::vector<std::string> names;
+    size_t pos = 0;
+    while ((pos = text.find(':', pos)) != std::string::npos) {
+        size_t quote = text.find_first_of("'\"", pos);
+        if (quote == std::string::npos) {
+            break;
+        }
+        size_t end = text.find(text[quote], quote + 1);
+        if (end == std::string::npos) {
+            break;
+        }
+        names.push_back(text.substr(quote + 1, end - quote - 1));
+        pos = end + 1;
+    }
+    return names;
+}
+
+std::vector<int> parseInts(const std::string& text) {
+    std::vector<int> values;
+    std::string number;
+    for (char c : text + " ") {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            number += c;
+        } else if (!number.empty()) {
+            values.push_back(std::stoi(number));
+            number.clear();
+        }
+    }
+    return values;
+}
+
+}  // namespace
+
+bool readOnnxMetadata(const std::string& model_path, std::map<std::string, std::string>& metadata) {
+    std::ifstream in(model_path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    // ModelProto.metadata_props is field 14; everything else is skipped by length
+    uint64_t tag = 0;
+    while (readVarint(in, tag)) {
+        int field = static_cast<int>(tag >> 3);
+        int wire_type = static_cast<int>(tag & 0x7);
+        if (field == 14 && wire_type == 2) {
+            uint64_t length = 0;
+            if (!readVarint(in, length) || length > (1u << 24)) {
+                return false;
+            }
+            std::string bytes(length, '\0');
+            in.read(&bytes[0], static_cast<std::streamsize>(length));
+            parseEntry(bytes, metadata);
+        } else if (!skipField(in, wire_type)) {
+            break;
+        }
+    }
+    return true;
+}
+
+int ModelOutputDescriptor::valuesPerAnchor() const {
+    return nms_included ? 6 : 4 + (has_objectness ? 1 : 0) + num_classes;
+}
+
+bool ModelOutputDescriptor::resolveFromShape(const cv::Mat& output) {
+    if (output.dims < 2) {
+        return false;
+    }
+    int rows = output.size[output.dims - 2];
+    int cols = output.size[output.dims - 1];
+
+    if (nms_included) {
+        layout = OutputLayout::AnchorMajor;
+        resolved = cols >= 6;
+        return resolved;
+    }
+
+    int expected = valuesPerAnchor();
+    if (rows == expected && cols != expected) {
+        layout = OutputLayout::ChannelMajor;
+    } else if (cols == expected && rows != expected) {
+        layout = OutputLayout::AnchorMajor;
+    } else if (rows == expected) {
+        // Square output: keep the configured layout
+    } else if (from_metadata) {
+        return false;
+    } else {
+        // Nothing known about the model: the value axis is the short one
+        int channels = std::min(rows, cols);
+        int anchors = std::max(rows, cols);
+        layout = rows < cols ? OutputLayout::ChannelMajor : OutputLayout::AnchorMajor;
+        if (layout == OutputLayout::AnchorMajor && channels == 6 && anchors <= 1000) {
+            // Few rows of [x1, y1, x2, y2, score, class]: an end-to-end head
+            nms_included = true;
+            box_format = BoxFormat::Corners;
+        } else {
+            // 85 anchor-major values is the YOLOv5 COCO head with objectness
+            has_objectness = layout == OutputLayout::AnchorMajor && channels == 85;
+            num_classes = channels - 4 - (has_objectness ? 1 : 0);
+            if (num_classes <= 0) {
+                return false;
+            }
+        }
+    }
+
+    resolved = true;
+    return true;
+}
+
+std::string ModelOutputDescriptor::describe() const {
+    std::ostringstream out;
+    out << (layout == OutputLayout::ChannelMajor ? "channel-major" : "anchor-major")
+        << ", " << num_classes << " classes"
+        << (has_objectness ? ", objectness" : "")
+        << ", " << (box_format == BoxFormat::CenterSize ? "cx/cy/w/h" : "x1/y1/x2/y2")
+        << (normalized ? " normalized" : " in pixels")
+        << ", input " << input_size.width << "x" << input_size.height
+        << (nms_included ? ", NMS in model" : "")
+        << (from_metadata ? " (from metadata)" : "");
+    return out.str();
+}
+
+ModelOutputDescriptor ModelOutputDescriptor::fromOnnxFile(const std::string& model_path) {
+    ModelOutputDescriptor descriptor;
+    std::map<std::string, std::string> metadata;
+    if (!readOnnxMetadata(model_path, metadata) || metadata.empty()) {
+        return descriptor;
+    }
+
+    auto names = metadata.find("names");
+    if (names != metadata.end()) {
+        descriptor.class_names = parseNames(names->second);
+        if (!descriptor.class_names.empty()) {
+            descriptor.num_classes = static_cast<int>(descriptor.class_names.size());
+            descriptor.from_metadata = true;
+        }
+    }
+
+    auto imgsz = metadata.find("imgsz");
+    if (imgsz != metadata.end()) {
+        std::vector<int> size = parseInts(imgsz->second);
+        if (size.size() == 1) {
+            descriptor.input_size = cv::Size(size[0], size[0]);
+        } else if (size.size() >= 2) {
+            descriptor.input_size = cv::Size(size[1], size[0]);  // written as [h, w]
+        }
+    }
+
+    // YOLOv10-style heads and exports with nms=True emit final boxes
+    auto end2end = metadata.find("end2end");
+    auto args = metadata.find("args");
+    if ((end2end != metadata.end() && end2end->second == "True") ||
+        (args != metadata.end() && args->second.find("'nms': True") != std::string::npos)) {
+        descriptor.nms_included = true;
+        descriptor.layout = OutputLayout::AnchorMajor;
+        descriptor.box_format = BoxFormat::Corners;
+    }
+
+    auto task = metadata.find("task");
+    if (task != metadata.end() && task->second != "detect") {
+        std::cerr << "Warning: model task is '" << task->second << "', decoding as detection" << std::endl;
+    }
+    return descriptor;
+}
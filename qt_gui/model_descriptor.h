@@ -0,0 +1,51 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// How per-anchor values are laid out in the detection output tensor
+enum class OutputLayout {
+    ChannelMajor,  // [1, values, anchors]  (YOLOv8/v11 exports)
+    AnchorMajor    // [1, anchors, values]  (YOLOv5-style exports, end-to-end heads)
+};
+
+enum class BoxFormat {
+    CenterSize,  // cx, cy, w, h
+    Corners      // x1, y1, x2, y2
+};
+
+// Explicit description of a detection model's output, so decoding does not
+// have to guess from tensor shapes. Filled from ONNX metadata where the
+// exporter wrote it (Ultralytics does), otherwise resolved from the first
+// output shape, or set by hand.
+struct ModelOutputDescriptor {
+    OutputLayout layout = OutputLayout::ChannelMajor;
+    BoxFormat box_format = BoxFormat::CenterSize;
+    int num_classes = 80;
+    bool has_objectness = false;
+    bool normalized = false;    // boxes in 0-1 rather than input pixels
+    bool nms_included = false;  // end-to-end head: rows are final [box, score, class]
+    cv::Size input_size = cv::Size(640, 640);
+    std::vector<std::string> class_names;
+
+    bool resolved = false;        // layout confirmed against a real output
+    bool from_metadata = false;
+
+    // Values per anchor row, e.g. 84 for an 80-class YOLOv8 head, 6 for end-to-end
+    int valuesPerAnchor() const;
+
+    // Fix layout and class count from an actual output tensor; false if the
+    // shape cannot be matched to this descriptor
+    bool resolveFromShape(const cv::Mat& output);
+
+    std::string describe() const;
+
+    // Descriptor from the model file's metadata (defaults where absent)
+    static ModelOutputDescriptor fromOnnxFile(const std::string& model_path);
+};
+
+// Read ModelProto.metadata_props from an ONNX file without a protobuf
+// dependency; the graph is skipped, not parsed
+bool readOnnxMetadata(const std::string& model_path, std::map<std::string, std::string>& metadata);
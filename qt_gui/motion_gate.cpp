@@ -0,0 +1,88 @@
+#include "motion_gate.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+MotionGate::MotionGate(int grid_cols, int grid_rows, int analysis_width)
+    : grid_cols_(std::max(1, grid_cols)), grid_rows_(std::max(1, grid_rows)),
+      analysis_width_(std::max(16, analysis_width)), tile_threshold_(6.0f),
+      min_changed_tiles_(1), refresh_interval_(30), background_rate_(0.05f),
+      changed_tiles_(0), frames_since_inference_(0),
+      frames_seen_(0), frames_skipped_(0), forced_refreshes_(0) {
+    tile_changes_.assign(grid_cols_ * grid_rows_, 0.0f);
+}
+
+void MotionGate::reset() {
+    background_.release();
+    std::fill(tile_changes_.begin(), tile_changes_.end(), 0.0f);
+    changed_tiles_ = 0;
+    frames_since_inference_ = 0;
+    frames_seen_ = 0;
+    frames_skipped_ = 0;
+    forced_refreshes_ = 0;
+}
+
+cv::Mat MotionGate::makeChangeImage(const cv::Mat& frame, int width) {
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+
+    cv::Mat small, gray, result;
+    cv::resize(frame, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (small.channels() == 3) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = small;
+    }
+    // Blur away sensor noise and compression flicker before differencing
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0);
+    gray.convertTo(result, CV_32F);
+    return result;
+}
+
+bool MotionGate::shouldRunInference(const cv::Mat& frame, bool has_active_tracks) {
+    frames_seen_++;
+
+    cv::Mat small = makeChangeImage(frame, analysis_width_);
+    if (background_.empty() || background_.size() != small.size()) {
+        background_ = small.clone();
+        frames_since_inference_ = 0;
+        return true;
+    }
+
+    cv::Mat diff;
+    cv::absdiff(small, background_, diff);
+
+    changed_tiles_ = 0;
+    int tile_w = std::max(1, diff.cols / grid_cols_);
+    int tile_h = std::max(1, diff.rows / grid_rows_);
+    for (int r = 0; r < grid_rows_; ++r) {
+        for (int c = 0; c < grid_cols_; ++c) {
+            // Last row/column absorb the remainder
+            int x = c * tile_w;
+            int y = r * tile_h;
+            int w = (c == grid_cols_ - 1) ? diff.cols - x : tile_w;
+            int h = (r == grid_rows_ - 1) ? diff.rows - y : tile_h;
+            float change = 0.0f;
+            if (w > 0 && h > 0) {
+                change = static_cast<float>(cv::mean(diff(cv::Rect(x, y, w, h)))[0]);
+            }
+            tile_changes_[r * grid_cols_ + c] = change;
+            if (change > tile_threshold_) {
+                changed_tiles_++;
+            }
+        }
+    }
+
+    // Slow running average so lighting drift is absorbed but vehicles are not
+    cv::accumulateWeighted(small, background_, background_rate_);
+
+    bool refresh_due = ++frames_since_inference_ >= refresh_interval_;
+    bool run = has_active_tracks || changed_tiles_ >= min_changed_tiles_ || refresh_due;
+    if (run) {
+        if (refresh_due && !has_active_tracks && changed_tiles_ < min_changed_tiles_) {
+            forced_refreshes_++;
+        }
+        frames_since_inference_ = 0;
+    } else {
+        frames_skipped_++;
+    }
+    return run;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Cheap change detector for static cameras: frames are downscaled to a small
+// grayscale image and compared per tile against a running background. When
+// no tile moved and nothing is being tracked, inference can be skipped.
+class MotionGate {
+public:
+    MotionGate(int grid_cols = 8, int grid_rows = 6, int analysis_width = 160);
+
+    // Decide whether this frame needs inference; also updates the background
+    bool shouldRunInference(const cv::Mat& frame, bool has_active_tracks);
+
+    // Per-tile mean absolute difference (0-255) from the last evaluated frame
+    const std::vector<float>& tileChanges() const { return tile_changes_; }
+    int gridCols() const { return grid_cols_; }
+    int gridRows() const { return grid_rows_; }
+
+    // Settings
+    void setTileThreshold(float threshold) { tile_threshold_ = threshold; }
+    void setMinChangedTiles(int tiles) { min_changed_tiles_ = tiles; }
+    void setRefreshInterval(int frames) { refresh_interval_ = frames; }
+    void setBackgroundRate(float rate) { background_rate_ = rate; }
+    void reset();
+
+    // Small blurred CV_32F grayscale version of a frame used for differencing
+    static cv::Mat makeChangeImage(const cv::Mat& frame, int width);
+
+    // Metrics
+    long getFramesSeen() const { return frames_seen_; }
+    long getFramesSkipped() const { return frames_skipped_; }
+    long getForcedRefreshes() const { return forced_refreshes_; }
+    double getSkipRate() const { return frames_seen_ > 0 ? static_cast<double>(frames_skipped_) / frames_seen_ : 0.0; }
+    int getChangedTiles() const { return changed_tiles_; }
+
+private:
+    int grid_cols_;
+    int grid_rows_;
+    int analysis_width_;
+    float tile_threshold_;
+    int min_changed_tiles_;
+    int refresh_interval_;
+    float background_rate_;
+
+    cv::Mat background_;
+    std::vector<float> tile_changes_;
+    int changed_tiles_;
+    int frames_since_inference_;
+
+    long frames_seen_;
+    long frames_skipped_;
+    long forced_refreshes_;
+};
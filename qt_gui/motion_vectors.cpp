@@ -0,0 +1,318 @@
+#include "motion_vectors.h"
+#include <iostream>
+
+#ifdef HAVE_FFMPEG_MOTION_VECTORS
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/motion_vector.h>
+#include <libswscale/swscale.h>
+}
+#include <cmath>
+
+namespace {
+
+// Forward gaps up to this many frames are decoded through; longer jumps seek
+const int kMaxForwardDecode = 60;
+
+} // namespace
+
+struct MotionVectorReader::Impl {
+    AVFormatContext* format = nullptr;
+    AVCodecContext* codec = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* frame = nullptr;
+    SwsContext* sws = nullptr;
+    int stream_index = -1;
+    bool flushed = false;
+    AVRational time_base{0, 1};
+    AVRational frame_rate{0, 1};
+    int64_t start_time = 0;
+
+    ~Impl() {
+        if (sws) sws_freeContext(sws);
+        if (frame) av_frame_free(&frame);
+        if (packet) av_packet_free(&packet);
+        if (codec) avcodec_free_context(&codec);
+        if (format) avformat_close_input(&format);
+    }
+
+    // Decode the next frame into frame; false at end of stream or on error
+    bool decodeNext() {
+        av_frame_unref(frame);
+        while (true) {
+            int ret = avcodec_receive_frame(codec, frame);
+            if (ret == 0) {
+                return true;
+            }
+            if (ret != AVERROR(EAGAIN)) {
+                return false;  // end of stream or decode error
+            }
+
+            if (av_read_frame(format, packet) < 0) {
+                if (flushed) {
+                    return false;
+                }
+                // Drain frames still buffered in the decoder
+                avcodec_send_packet(codec, nullptr);
+                flushed = true;
+                continue;
+            }
+            if (packet->stream_index == stream_index) {
+                avcodec_send_packet(codec, packet);
+            }
+            av_packet_unref(packet);
+        }
+    }
+
+    // Presentation index of the decoded frame from its timestamp, -1 if unknown
+    int frameIndex() const {
+        int64_t pts = frame->best_effort_timestamp;
+        if (pts == AV_NOPTS_VALUE || frame_rate.num <= 0) {
+            return -1;
+        }
+        return static_cast<int>(std::llround((pts - start_time) * av_q2d(time_base) * av_q2d(frame_rate)));
+    }
+
+    // Land on the keyframe at or before frame_index
+    bool seek(int frame_index) {
+        if (frame_rate.num <= 0) {
+            return false;
+        }
+        int64_t target = start_time + av_rescale_q(frame_index, av_inv_q(frame_rate), time_base);
+        if (av_seek_frame(format, stream_index, target, AVSEEK_FLAG_BACKWARD) < 0) {
+            return false;
+        }
+        avcodec_flush_buffers(codec);
+        flushed = false;
+        return true;
+    }
+
+    void extractVectors(std::vector<MotionVector>& vectors) const {
+        vectors.clear();
+        const AVFrameSideData* side_data = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+        if (!side_data) {
+            return;
+        }
+        const AVMotionVector* mvs = reinterpret_cast<const AVMotionVector*>(side_data->data);
+        size_t count = side_data->size / sizeof(AVMotionVector);
+        vectors.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const AVMotionVector& mv = mvs[i];
+            // The block at dst came from src in the reference frame; references
+            // in the future point the other way
+            cv::Point2f displacement(static_cast<float>(mv.dst_x - mv.src_x),
+                                     static_cast<float>(mv.dst_y - mv.src_y));
+            if (mv.source > 0) {
+                displacement = -displacement;
+            }
+            vectors.push_back({cv::Point2f(static_cast<float>(mv.dst_x), static_cast<float>(mv.dst_y)),
+                               displacement});
+        }
+    }
+
+    void convertFrame(cv::Mat& bgr) {
+        int width = frame->width;
+        int height = frame->height;
+        sws = sws_getCachedContext(sws, width, height, static_cast<AVPixelFormat>(frame->format),
+                                   width, height, AV_PIX_FMT_BGR24, SWS_BILINEAR,
+                                   nullptr, nullptr, nullptr);
+        bgr.create(height, width, CV_8UC3);
+        uint8_t* dst[4] = {bgr.data, nullptr, nullptr, nullptr};
+        int dst_stride[4] = {static_cast<int>(bgr.step), 0, 0, 0};
+        sws_scale(sws, frame->data, frame->linesize, 0, height, dst, dst_stride);
+    }
+};
+
+bool MotionVectorReader::isSupported() {
+    return true;
+}
+
+bool MotionVectorReader::open(const std::string& path) {
+    close();
+    auto impl = std::make_unique<Impl>();
+
+    if (avformat_open_input(&impl->format, path.c_str(), nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(impl->format, nullptr) < 0) {
+        std::cerr << "MotionVectorReader: could not open " << path << std::endl;
+        return false;
+    }
+
+    impl->stream_index = av_find_best_stream(impl->format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (impl->stream_index < 0) {
+        std::cerr << "MotionVectorReader: no video stream in " << path << std::endl;
+        return false;
+    }
+
+    AVStream* stream = impl->format->streams[impl->stream_index];
+    const AVCodec* decoder = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!decoder) {
+        std::cerr << "MotionVectorReader: no decoder for stream" << std::endl;
+        return false;
+    }
+
+    impl->codec = avcodec_alloc_context3(decoder);
+    if (!impl->codec || avcodec_parameters_to_context(impl->codec, stream->codecpar) < 0) {
+        return false;
+    }
+
+    // Ask the decoder to attach the motion vectors it already computed
+    AVDictionary* options = nullptr;
+    av_dict_set(&options, "flags2", "+export_mvs", 0);
+    int ret = avcodec_open2(impl->codec, decoder, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        std::cerr << "MotionVectorReader: could not open decoder" << std::endl;
+        return false;
+    }
+
+    impl->packet = av_packet_alloc();
+    impl->frame = av_frame_alloc();
+    if (!impl->packet || !impl->frame) {
+        return false;
+    }
+
+    // Frame index <-> timestamp mapping, the same one VideoCapture uses for seeking
+    impl->time_base = stream->time_base;
+    impl->frame_rate = av_guess_frame_rate(impl->format, stream, nullptr);
+    impl->start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    impl_ = std::move(impl);
+    path_ = path;
+    next_frame_index_ = 0;
+    last_frame_index_ = -1;
+    return true;
+}
+
+bool MotionVectorReader::read(std::vector<MotionVector>& vectors, cv::Mat* frame) {
+    if (!impl_ || !impl_->decodeNext()) {
+        return false;
+    }
+
+    int index = impl_->frameIndex();
+    if (index < 0) {
+        if (next_frame_index_ < 0) {
+            return false;  // position unknown after a seek
+        }
+        index = next_frame_index_;
+    }
+    last_frame_index_ = index;
+    next_frame_index_ = index + 1;
+
+    impl_->extractVectors(vectors);
+    last_vectors_ = vectors;
+    if (frame) {
+        impl_->convertFrame(*frame);
+    }
+    return true;
+}
+
+bool MotionVectorReader::decodeTo(int frame_index, cv::Mat* frame, std::vector<MotionVector>& vectors) {
+    if (!impl_ || frame_index < 0) {
+        return false;
+    }
+
+    bool backward = next_frame_index_ < 0 || frame_index < next_frame_index_;
+    if (backward || frame_index - next_frame_index_ > kMaxForwardDecode) {
+        if (impl_->seek(frame_index)) {
+            next_frame_index_ = -1;
+        } else if (backward) {
+            // No usable timestamps: the decoder can only restart from the top
+            std::string path = path_;
+            if (!open(path)) {
+                return false;
+            }
+        }
+    }
+
+    // Decode without extracting or converting until the target comes up
+    while (true) {
+        if (!impl_->decodeNext()) {
+            return false;
+        }
+        int index = impl_->frameIndex();
+        if (index < 0) {
+            if (next_frame_index_ < 0) {
+                return false;
+            }
+            index = next_frame_index_;
+        }
+        last_frame_index_ = -1;
+        next_frame_index_ = index + 1;
+        if (index >= frame_index) {
+            if (index != frame_index) {
+                return false;  // overshot: the seek landed past the target
+            }
+            break;
+        }
+    }
+
+    impl_->extractVectors(vectors);
+    last_vectors_ = vectors;
+    last_frame_index_ = frame_index;
+    if (frame) {
+        impl_->convertFrame(*frame);
+    }
+    return true;
+}
+
+#else
+
+struct MotionVectorReader::Impl {};
+
+bool MotionVectorReader::isSupported() {
+    return false;
+}
+
+bool MotionVectorReader::open(const std::string& path) {
+    (void)path;
+    std::cerr << "MotionVectorReader: built without FFmpeg, motion vectors unavailable" << std::endl;
+    return false;
+}
+
+bool MotionVectorReader::read(std::vector<MotionVector>& vectors, cv::Mat* frame) {
+    (void)vectors;
+    (void)frame;
+    return false;
+}
+
+bool MotionVectorReader::decodeTo(int frame_index, cv::Mat* frame, std::vector<MotionVector>& vectors) {
+    (void)frame_index;
+    (void)frame;
+    (void)vectors;
+    return false;
+}
+
+#endif
+
+MotionVectorReader::MotionVectorReader() : next_frame_index_(0), last_frame_index_(-1) {
+}
+
+MotionVectorReader::~MotionVectorReader() {
+}
+
+void MotionVectorReader::close() {
+    impl_.reset();
+    next_frame_index_ = 0;
+    last_frame_index_ = -1;
+    last_vectors_.clear();
+}
+
+bool MotionVectorReader::isOpened() const {
+    return impl_ != nullptr;
+}
+
+bool MotionVectorReader::motionVectorsFor(int frame_index, std::vector<MotionVector>& vectors) {
+    if (!impl_ || frame_index < 0) {
+        return false;
+    }
+    if (frame_index == last_frame_index_) {
+        vectors = last_vectors_;
+        return true;
+    }
+    return decodeTo(frame_index, nullptr, vectors);
+}
+
+bool MotionVectorReader::frameAt(int frame_index, cv::Mat& frame, std::vector<MotionVector>& vectors) {
+    return decodeTo(frame_index, &frame, vectors);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Codec motion vector of one block: where the block sits in the current
+// frame and how far it moved since the previous frame
+struct MotionVector {
+    cv::Point2f position;
+    cv::Point2f motion;
+};
+
+// Reads the H.264/H.265 motion vectors the decoder already computes (FFmpeg
+// export_mvs side data). Decoding is sequential; backward requests and long
+// forward jumps seek to the keyframe before the target. frameAt returns the
+// pixels from the same decode, so the player needs no second decoder. Only
+// available when built with FFmpeg (HAVE_FFMPEG_MOTION_VECTORS).
+class MotionVectorReader {
+public:
+    MotionVectorReader();
+    ~MotionVectorReader();
+
+    static bool isSupported();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpened() const;
+
+    // Motion vectors of frame_index (0-based, presentation order); the last
+    // decoded frame's vectors are answered without decoding again
+    bool motionVectorsFor(int frame_index, std::vector<MotionVector>& vectors);
+
+    // BGR pixels and motion vectors of frame_index from one decode; false if
+    // the frame could not be located exactly (fall back to another decoder)
+    bool frameAt(int frame_index, cv::Mat& frame, std::vector<MotionVector>& vectors);
+
+    // Decode the next frame; frame (optional) receives BGR pixels so callers
+    // can use this as their only decoder
+    bool read(std::vector<MotionVector>& vectors, cv::Mat* frame = nullptr);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    // Decode up to frame_index, seeking when that is cheaper than decoding through
+    bool decodeTo(int frame_index, cv::Mat* frame, std::vector<MotionVector>& vectors);
+
+    std::string path_;
+    int next_frame_index_;   // -1 right after a seek, until a frame is decoded
+    int last_frame_index_;   // frame last_vectors_ belong to
+    std::vector<MotionVector> last_vectors_;
+};
@@ -0,0 +1,150 @@
+#include "overload_controller.h"
+#include "detection_tracker.h"
+#include "MetricsRegistry.hpp"
+#include <iostream>
+
+namespace {
+
+// Smaller input used by ReducedInput: three quarters of native, on the
+// 32-pixel grid YOLO strides need, never below 320
+cv::Size reducedInputSize(const cv::Size& native) {
+    auto reduce = [](int side) { return std::max(320, side * 3 / 4 / 32 * 32); };
+    return cv::Size(std::min(native.width, reduce(native.width)), std::min(native.height, reduce(native.height)));
+}
+
+}  // namespace
+
+OverloadController::OverloadController()
+    : tracker_(nullptr), baseline_{cv::Size(640, 640), 1}, small_model_active_(false),
+      budget_ms_(33.3), sparse_interval_(3), down_frames_(10), up_frames_(90), settle_frames_(30),
+      level_(Full), latency_ewma_(0.0), overloaded_run_(0), headroom_run_(0), since_change_(0),
+      transitions_(0) {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    level_gauge_ = &registry.gauge("overload_level", "Quality level shed by the overload controller (0 = full)");
+    steps_down_ = &registry.counter("overload_transitions_total{direction=\"down\"}", "Overload controller level changes");
+    steps_up_ = &registry.counter("overload_transitions_total{direction=\"up\"}", "Overload controller level changes");
+}
+
+const char* OverloadController::levelName(int level) {
+    switch (level) {
+        case Full: return "full quality";
+        case ReducedInput: return "reduced input size";
+        case SparseDetection: return "sparse detection";
+        case NoSecondaryStages: return "secondary stages off";
+        case SmallModel: return "small model";
+        default: return "unknown";
+    }
+}
+
+void OverloadController::attach(DetectionTracker* tracker) {
+    tracker_ = tracker;
+    level_ = Full;
+    small_model_active_ = false;
+    latency_ewma_ = 0.0;
+    overloaded_run_ = 0;
+    headroom_run_ = 0;
+    since_change_ = 0;
+    level_gauge_->set(0.0);
+    if (tracker_) {
+        captureBaseline();
+    }
+}
+
+void OverloadController::setHysteresis(int down_frames, int up_frames, int settle_frames) {
+    down_frames_ = std::max(1, down_frames);
+    up_frames_ = std::max(down_frames_, up_frames);
+    settle_frames_ = std::max(0, settle_frames);
+}
+
+void OverloadController::captureBaseline() {
+    baseline_.input_size = tracker_->getInputSize();
+    baseline_.detection_interval = tracker_->getDetectionInterval();
+}
+
+bool OverloadController::update(double latency_ms, int backlog_frames) {
+    if (!tracker_) {
+        return false;
+    }
+
+    latency_ewma_ = latency_ewma_ > 0.0 ? 0.8 * latency_ewma_ + 0.2 * latency_ms : latency_ms;
+    since_change_++;
+
+    // Falling behind the clock is overload even if single frames look fast
+    bool overloaded = latency_ewma_ > budget_ms_ || backlog_frames > 1;
+    bool headroom = latency_ewma_ < 0.6 * budget_ms_ && backlog_frames == 0;
+    overloaded_run_ = overloaded ? overloaded_run_ + 1 : 0;
+    headroom_run_ = headroom ? headroom_run_ + 1 : 0;
+
+    if (since_change_ < settle_frames_) {
+        return false;
+    }
+
+    int next = level_;
+    if (overloaded_run_ >= down_frames_ && level_ < maxLevel()) {
+        next = level_ + 1;
+    } else if (headroom_run_ >= up_frames_ && level_ > Full) {
+        next = level_ - 1;
+    }
+    if (next == level_) {
+        return false;
+    }
+
+    // Settings changed by the user at full quality become the new baseline
+    if (level_ == Full) {
+        captureBaseline();
+    }
+    int previous = level_;
+    if (!apply(next)) {
+        return false;
+    }
+    std::cout << "Overload control: " << levelName(previous) << " -> " << levelName(next)
+              << " (latency " << latency_ewma_ << " ms, budget " << budget_ms_
+              << " ms, backlog " << backlog_frames << ")" << std::endl;
+    (next > previous ? steps_down_ : steps_up_)->add();
+    transitions_++;
+    overloaded_run_ = 0;
+    headroom_run_ = 0;
+    since_change_ = 0;
+    return true;
+}
+
+void OverloadController::reset() {
+    if (tracker_ && level_ != Full) {
+        apply(Full);
+    }
+    level_ = Full;
+    latency_ewma_ = 0.0;
+    overloaded_run_ = 0;
+    headroom_run_ = 0;
+    since_change_ = 0;
+    level_gauge_->set(0.0);
+}
+
+bool OverloadController::apply(int level) {
+    bool want_small = level >= SmallModel;
+    cv::Size input_size = level >= ReducedInput ? reducedInputSize(baseline_.input_size) : baseline_.input_size;
+    bool switching = false;
+    if (want_small != small_model_active_ && model_switch_) {
+        // The fallback model runs at its own native size; the main model
+        // comes back at the size this level wants
+        if (model_switch_(want_small, want_small ? cv::Size() : input_size)) {
+            small_model_active_ = want_small;
+            switching = true;
+        } else if (want_small) {
+            // Another swap is still loading; stay here and retry later
+            return false;
+        }
+    }
+
+    if (!small_model_active_ && !switching) {
+        tracker_->setInputSize(input_size);
+    }
+    tracker_->setDetectionInterval(level >= SparseDetection ?
+                                   std::max(baseline_.detection_interval, sparse_interval_) :
+                                   baseline_.detection_interval);
+    tracker_->suspendSecondaryStages(level >= NoSecondaryStages);
+
+    level_ = level;
+    level_gauge_->set(static_cast<double>(level_));
+    return true;
+}
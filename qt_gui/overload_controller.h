@@ -0,0 +1,86 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <functional>
+
+class DetectionTracker;
+class Counter;
+class Gauge;
+
+// Closed-loop quality control for live playback. Each displayed frame
+// reports its latency and how many frames playback is behind; sustained
+// overload steps the detector down one quality level, sustained headroom
+// steps it back up. Stepping up needs a much longer quiet period than
+// stepping down, and every change is followed by a settling period, so the
+// level does not oscillate around the budget.
+class OverloadController {
+public:
+    enum Level {
+        Full = 0,
+        ReducedInput,       // smaller network input
+        SparseDetection,    // detect every N frames, track in between
+        NoSecondaryStages,  // attributes and cascade suspended
+        SmallModel,         // fallback model, if one is available
+        LevelCount
+    };
+
+    // Switches the detector to the fallback model (true) or back (false) at
+    // the given input size (empty for native); returns false if the switch
+    // could not be started
+    using ModelSwitch = std::function<bool(bool, const cv::Size&)>;
+
+    OverloadController();
+
+    // Controls tracker from now on; its current settings are the full-quality level
+    void attach(DetectionTracker* tracker);
+    void setModelSwitch(ModelSwitch model_switch) { model_switch_ = std::move(model_switch); }
+
+    // Budget per frame (the frame period times the pipeline depth)
+    void setFrameBudget(double ms) { budget_ms_ = ms; }
+    void setSparseInterval(int frames) { sparse_interval_ = std::max(2, frames); }
+    void setHysteresis(int down_frames, int up_frames, int settle_frames);
+
+    // Feed one frame; returns true if the level changed
+    bool update(double latency_ms, int backlog_frames);
+
+    // Back to full quality with the baseline settings restored
+    void reset();
+
+    int level() const { return level_; }
+    int maxLevel() const { return model_switch_ ? SmallModel : NoSecondaryStages; }
+    static const char* levelName(int level);
+    double smoothedLatency() const { return latency_ewma_; }
+    long transitions() const { return transitions_; }
+
+private:
+    struct Baseline {
+        cv::Size input_size;
+        int detection_interval;
+    };
+
+    void captureBaseline();
+    bool apply(int level);
+
+    DetectionTracker* tracker_;
+    ModelSwitch model_switch_;
+    Baseline baseline_;
+    bool small_model_active_;
+
+    double budget_ms_;
+    int sparse_interval_;
+    int down_frames_;
+    int up_frames_;
+    int settle_frames_;
+
+    int level_;
+    double latency_ewma_;
+    int overloaded_run_;
+    int headroom_run_;
+    int since_change_;
+    long transitions_;
+
+    Gauge* level_gauge_;
+    Counter* steps_down_;
+    Counter* steps_up_;
+};
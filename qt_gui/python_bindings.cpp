@@ -0,0 +1,201 @@
+// Python extension exposing DetectionTracker to the Python tools.
+//
+//   import fsd_core
+//   tracker = fsd_core.DetectionTracker("models/yolov8n.onnx", "models/coco.names")
+//   tracks = tracker.process_frame(frame)   # frame: HxWx3 uint8 numpy array (BGR)
+//   tracks["track_id"], tracks["x"], ...     # structured numpy array, one row per track
+//
+// Frames are wrapped as cv::Mat without copying and processed with the GIL
+// released, so a Python capture/display loop keeps running while the network
+// does. One tracker is not re-entrant; calls on the same instance serialize.
+
+#include "detection_tracker.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+// Row of the structured array returned per frame; box in pixels (x, y, w, h)
+struct TrackRecord {
+    int32_t track_id;
+    float x;
+    float y;
+    float w;
+    float h;
+    float confidence;
+    int32_t class_id;
+    int32_t age;
+    int32_t hits;
+    int32_t time_since_update;
+};
+
+// View a numpy array as a cv::Mat sharing its memory. Rows may be padded
+// (e.g. a crop of a larger frame), but pixels within a row must be packed.
+cv::Mat wrapFrame(const py::buffer_info& info) {
+    if (info.format != py::format_descriptor<uint8_t>::format() || info.itemsize != 1) {
+        throw py::value_error("frame must be a uint8 array");
+    }
+    if (info.ndim != 2 && info.ndim != 3) {
+        throw py::value_error("frame must have shape (H, W) or (H, W, C)");
+    }
+    int channels = info.ndim == 3 ? static_cast<int>(info.shape[2]) : 1;
+    if (channels != 1 && channels != 3 && channels != 4) {
+        throw py::value_error("frame must have 1, 3 or 4 channels");
+    }
+    bool packed = (info.ndim == 2 || info.strides[2] == 1) && info.strides[1] == channels &&
+                  info.strides[0] >= info.shape[1] * channels;
+    if (!packed) {
+        throw py::value_error("frame pixels must be contiguous; pass np.ascontiguousarray(frame)");
+    }
+    return cv::Mat(static_cast<int>(info.shape[0]), static_cast<int>(info.shape[1]), CV_8UC(channels),
+                   info.ptr, static_cast<size_t>(info.strides[0]));
+}
+
+// The detector expects BGR; this is the only conversion that copies
+cv::Mat toBGR(const cv::Mat& frame) {
+    if (frame.channels() == 3) {
+        return frame;
+    }
+    cv::Mat bgr;
+    cv::cvtColor(frame, bgr, frame.channels() == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR);
+    return bgr;
+}
+
+class PyDetectionTracker {
+public:
+    PyDetectionTracker(const std::string& model_path, const std::string& classes_path,
+                       float conf_threshold, float nms_threshold) {
+        bool ok;
+        {
+            py::gil_scoped_release release;
+            ok = tracker_.initialize(model_path, "", classes_path, conf_threshold, nms_threshold);
+        }
+        if (!ok) {
+            throw std::runtime_error("failed to load model " + model_path);
+        }
+    }
+
+    py::array_t<TrackRecord> processFrame(py::buffer frame, int frame_index) {
+        py::buffer_info info = frame.request();
+        cv::Mat mat = toBGR(wrapFrame(info));
+
+        std::vector<TrackedObject> objects;
+        {
+            // info keeps the array alive; nothing here touches Python objects
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            objects = tracker_.processFrame(mat, frame_index);
+        }
+
+        py::array_t<TrackRecord> records(static_cast<py::ssize_t>(objects.size()));
+        auto rows = records.mutable_unchecked<1>();
+        for (size_t i = 0; i < objects.size(); ++i) {
+            const TrackedObject& obj = objects[i];
+            rows(i) = TrackRecord{obj.track_id,
+                                  static_cast<float>(obj.bbox.x), static_cast<float>(obj.bbox.y),
+                                  static_cast<float>(obj.bbox.width), static_cast<float>(obj.bbox.height),
+                                  obj.confidence, obj.class_id, obj.age, obj.total_hits,
+                                  obj.time_since_update};
+        }
+        return records;
+    }
+
+    // Detector output without tracking, as rows with track_id -1
+    py::array_t<TrackRecord> detect(py::buffer frame) {
+        py::buffer_info info = frame.request();
+        cv::Mat mat = toBGR(wrapFrame(info));
+
+        std::vector<Detection> detections;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            detections = tracker_.detectFrame(mat);
+        }
+
+        py::array_t<TrackRecord> records(static_cast<py::ssize_t>(detections.size()));
+        auto rows = records.mutable_unchecked<1>();
+        for (size_t i = 0; i < detections.size(); ++i) {
+            const Detection& det = detections[i];
+            rows(i) = TrackRecord{-1,
+                                  static_cast<float>(det.bbox.x), static_cast<float>(det.bbox.y),
+                                  static_cast<float>(det.bbox.width), static_cast<float>(det.bbox.height),
+                                  det.confidence, det.class_id, 0, 0, 0};
+        }
+        return records;
+    }
+
+    // Settings go through the same lock so they never race a frame in flight
+    template <typename Fn>
+    auto locked(Fn fn) {
+        py::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return fn(tracker_);
+    }
+
+    DetectionTracker tracker_;
+    std::mutex mutex_;
+};
+
+}  // namespace
+
+PYBIND11_MODULE(fsd_core, m) {
+    m.doc() = "Native detection and tracking core of the vehicle video analysis tools";
+
+    PYBIND11_NUMPY_DTYPE(TrackRecord, track_id, x, y, w, h, confidence, class_id, age, hits, time_since_update);
+    m.attr("track_dtype") = py::dtype::of<TrackRecord>();
+
+    py::class_<PyDetectionTracker>(m, "DetectionTracker")
+        .def(py::init<const std::string&, const std::string&, float, float>(),
+             py::arg("model_path"), py::arg("classes_path") = "models/coco.names",
+             py::arg("conf_threshold") = 0.5f, py::arg("nms_threshold") = 0.4f)
+        .def("process_frame", &PyDetectionTracker::processFrame,
+             py::arg("frame"), py::arg("frame_index") = -1,
+             "Detect and track objects in a BGR uint8 frame (not copied); returns a track_dtype array")
+        .def("detect", &PyDetectionTracker::detect, py::arg("frame"),
+             "Detector output for a BGR uint8 frame without tracking; track_id is -1")
+        .def("set_confidence_threshold", [](PyDetectionTracker& self, float threshold) {
+            self.locked([&](DetectionTracker& t) { t.setConfidenceThreshold(threshold); });
+        })
+        .def("set_nms_threshold", [](PyDetectionTracker& self, float threshold) {
+            self.locked([&](DetectionTracker& t) { t.setNMSThreshold(threshold); });
+        })
+        .def("set_class_filter", [](PyDetectionTracker& self, const std::vector<int>& class_ids) {
+            self.locked([&](DetectionTracker& t) { t.setClassFilter(class_ids); });
+        }, py::arg("class_ids"))
+        .def("set_detection_interval", [](PyDetectionTracker& self, int frames) {
+            self.locked([&](DetectionTracker& t) { t.setDetectionInterval(frames); });
+        })
+        .def("enable_motion_gating", [](PyDetectionTracker& self, bool enable) {
+            self.locked([&](DetectionTracker& t) { t.enableMotionGating(enable); });
+        }, py::arg("enable") = true)
+        .def("set_thread_count", [](PyDetectionTracker& self, int threads) {
+            self.locked([&](DetectionTracker& t) { t.setThreadCount(threads); });
+        })
+        .def("set_input_size", [](PyDetectionTracker& self, int width, int height) {
+            self.locked([&](DetectionTracker& t) { t.setInputSize(cv::Size(width, height)); });
+        })
+        .def("reset_tracks", [](PyDetectionTracker& self) {
+            self.locked([](DetectionTracker& t) { t.resetTracks(); });
+        })
+        .def("swap_model", [](PyDetectionTracker& self, const std::string& model_path) {
+            return self.locked([&](DetectionTracker& t) { return t.swapModel(model_path); });
+        }, py::arg("model_path"), "Load another model in the background and switch at the next frame")
+        .def_property_readonly("class_names", [](PyDetectionTracker& self) {
+            return self.locked([](DetectionTracker& t) { return t.getClassNames(); });
+        })
+        .def_property_readonly("fps", [](PyDetectionTracker& self) {
+            return self.locked([](DetectionTracker& t) { return t.getFPS(); });
+        })
+        .def_property_readonly("detection_time_ms", [](PyDetectionTracker& self) {
+            return self.locked([](DetectionTracker& t) { return t.getDetectionTime(); });
+        })
+        .def_property_readonly("tracking_time_ms", [](PyDetectionTracker& self) {
+            return self.locked([](DetectionTracker& t) { return t.getTrackingTime(); });
+        });
+}
@@ -0,0 +1,101 @@
+// Live detection viewer on GLFW + Dear ImGui, without Qt.
+//
+//   realtime_viewer --model models/yolov8n.onnx [--classes models/coco.names] [--source video.mp4|0]
+//
+// A Pipeline worker decodes the source and runs the tracker on every frame;
+// GUIModule draws the newest result and the pipeline statistics.
+
+#include "detection_tracker.h"
+#include "Pipeline.hpp"
+#include "GUIModule.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: realtime_viewer --model MODEL.onnx [--classes coco.names] [--source VIDEO|CAMERA]\n"
+              << "         [--conf 0.3] [--width 1280] [--height 720]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string model_path;
+    std::string classes_path = "models/coco.names";
+    std::string source = "0";
+    float conf = 0.3f;
+    int width = 1280;
+    int height = 720;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value" << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--model") {
+            model_path = next();
+        } else if (arg == "--classes") {
+            classes_path = next();
+        } else if (arg == "--source") {
+            source = next();
+        } else if (arg == "--conf") {
+            conf = std::stof(next());
+        } else if (arg == "--width") {
+            width = std::stoi(next());
+        } else if (arg == "--height") {
+            height = std::stoi(next());
+        } else {
+            printUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    if (model_path.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Only the pipeline worker touches the tracker
+    auto tracker = std::make_shared<DetectionTracker>();
+    if (!tracker->initialize(model_path, "", classes_path, conf)) {
+        std::cerr << "Failed to load " << model_path << std::endl;
+        return 1;
+    }
+    tracker->setMetricsScope("viewer");
+
+    auto pipeline = std::make_shared<Pipeline>(source);
+    PipelineConfig config;
+    config.confidenceThreshold = conf;
+    pipeline->updateConfig(config);
+    pipeline->setDetector([tracker](const cv::Mat& frame, const PipelineConfig& config) {
+        tracker->setConfidenceThreshold(config.confidenceThreshold);
+        tracker->setNMSThreshold(config.nmsThreshold);
+        std::vector<FrameDetection> detections;
+        for (const auto& obj : tracker->processFrame(frame)) {
+            detections.push_back(FrameDetection{obj.bbox, obj.confidence, obj.class_id, obj.class_name, obj.track_id});
+        }
+        return detections;
+    });
+
+    GUIModule gui(pipeline);
+    pipeline->setResultCallback([&gui](std::shared_ptr<const ProcessedFrame> result) {
+        auto captureTime = result->captureTime;
+        gui.publishResult(std::move(result), captureTime);
+    });
+
+    if (!gui.initialize(width, height, "Real-time Vehicle Detection")) {
+        std::cerr << "Viewer: " << gui.getLastError() << std::endl;
+        return 1;
+    }
+    if (!pipeline->start()) {
+        std::cerr << "Viewer: " << pipeline->getLastError() << std::endl;
+        return 1;
+    }
+    gui.run();
+    pipeline->stop();
+    return 0;
+}
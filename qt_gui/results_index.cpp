@@ -0,0 +1,460 @@
+#include "results_index.h"
+#include "MetricsRegistry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const uint32_t kIndexMagic = 0x58444952; // "RIDX"
+const uint32_t kIndexVersion = 1;
+
+template <typename T>
+void writePod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+int16_t clampInt16(int value) {
+    return static_cast<int16_t>(std::max(-32768, std::min(32767, value)));
+}
+
+// Unlike cv::Rect::operator|, keeps zero-area boxes in the union
+void unite(cv::Rect& bounds, const cv::Rect& box) {
+    int x2 = std::max(bounds.x + bounds.width, box.x + box.width);
+    int y2 = std::max(bounds.y + bounds.height, box.y + box.height);
+    bounds.x = std::min(bounds.x, box.x);
+    bounds.y = std::min(bounds.y, box.y);
+    bounds.width = x2 - bounds.x;
+    bounds.height = y2 - bounds.y;
+}
+
+// A box centre lies within the box (edges included), so no box inside
+// bounds can have its centre in zone unless the two touch
+bool mayHaveCentreIn(const cv::Rect& bounds, const cv::Rect& zone) {
+    return bounds.x < zone.x + zone.width && zone.x <= bounds.x + bounds.width &&
+           bounds.y < zone.y + zone.height && zone.y <= bounds.y + bounds.height;
+}
+
+} // namespace
+
+ResultsIndex::ResultsIndex(int segment_frames)
+    : segment_frames_(std::max(1, std::min(65535, segment_frames))),
+      last_frame_(-1),
+      observations_(0) {
+    query_ms_ = &MetricsRegistry::global().histogram("results_query_ms", "Time to answer one results index query");
+}
+
+bool ResultsIndex::append(int frame_index, double timestamp_ms, const std::vector<TrackedObject>& objects) {
+    if (frame_index <= last_frame_) {
+        return false;
+    }
+
+    // Keep the time index sorted even if the source timestamps jitter
+    if (!segments_.empty()) {
+        timestamp_ms = std::max(timestamp_ms, segments_.back().frame_ms.back());
+    }
+    if (segments_.empty() || frame_index - segments_.back().begin_frame >= segment_frames_) {
+        if (!segments_.empty()) {
+            seal(segments_.back());
+        }
+        Segment segment;
+        segment.begin_frame = frame_index;
+        segment.last_frame = frame_index;
+        segments_.push_back(std::move(segment));
+    }
+
+    Segment& segment = segments_.back();
+    uint16_t offset = static_cast<uint16_t>(frame_index - segment.begin_frame);
+    segment.frame_offsets.push_back(offset);
+    segment.frame_ms.push_back(timestamp_ms);
+    segment.last_frame = frame_index;
+
+    for (const auto& object : objects) {
+        Observation observation;
+        observation.frame_offset = offset;
+        observation.x = clampInt16(object.bbox.x);
+        observation.y = clampInt16(object.bbox.y);
+        observation.w = clampInt16(std::max(0, object.bbox.width));
+        observation.h = clampInt16(std::max(0, object.bbox.height));
+        observation.track_id = object.track_id;
+        cv::Rect box(observation.x, observation.y, observation.w, observation.h);
+
+        Posting& posting = segment.postings[object.class_id];
+        if (posting.observations.empty()) {
+            posting.bounds = box;
+        } else {
+            unite(posting.bounds, box);
+        }
+        if (posting.observations.size() % kBlockSize == 0) {
+            posting.block_bounds.push_back(box);
+        } else {
+            unite(posting.block_bounds.back(), box);
+        }
+        posting.observations.push_back(observation);
+
+        std::string& name = class_names_[object.class_id];
+        if (name.empty()) {
+            name = object.class_name;
+        }
+
+        auto track = tracks_.find(object.track_id);
+        if (track == tracks_.end()) {
+            tracks_.emplace(object.track_id,
+                            TrackSummary{object.track_id, object.class_id, frame_index, frame_index, 1, box});
+        } else {
+            track->second.class_id = object.class_id;
+            track->second.last_frame = frame_index;
+            track->second.observations++;
+            unite(track->second.bounds, box);
+        }
+        observations_++;
+    }
+
+    last_frame_ = frame_index;
+    return true;
+}
+
+// A full segment never grows again; drop the vectors' spare capacity
+void ResultsIndex::seal(Segment& segment) {
+    segment.frame_offsets.shrink_to_fit();
+    segment.frame_ms.shrink_to_fit();
+    for (auto& entry : segment.postings) {
+        entry.second.observations.shrink_to_fit();
+        entry.second.block_bounds.shrink_to_fit();
+    }
+}
+
+void ResultsIndex::clear() {
+    segments_.clear();
+    tracks_.clear();
+    class_names_.clear();
+    last_frame_ = -1;
+    observations_ = 0;
+}
+
+bool ResultsIndex::findTrack(int track_id, TrackSummary& summary) const {
+    auto it = tracks_.find(track_id);
+    if (it == tracks_.end()) {
+        return false;
+    }
+    summary = it->second;
+    return true;
+}
+
+bool ResultsIndex::offsetWindow(const Segment& segment, int begin_frame, int end_frame,
+                                const ResultsQuery& query, int& first, int& last) const {
+    first = std::max(0, begin_frame - segment.begin_frame);
+    last = static_cast<int>(std::min<long>(static_cast<long>(end_frame) - segment.begin_frame,
+                                           static_cast<long>(segment.frame_offsets.back()) + 1));
+
+    if (query.end_ms > query.begin_ms) {
+        auto begin = std::lower_bound(segment.frame_ms.begin(), segment.frame_ms.end(), query.begin_ms);
+        auto end = std::lower_bound(begin, segment.frame_ms.end(), query.end_ms);
+        if (begin == end) {
+            return false;
+        }
+        first = std::max(first, static_cast<int>(segment.frame_offsets[begin - segment.frame_ms.begin()]));
+        last = std::min(last, static_cast<int>(segment.frame_offsets[end - segment.frame_ms.begin() - 1]) + 1);
+    }
+    return first < last;
+}
+
+ResultsQueryResult ResultsIndex::query(const ResultsQuery& query) const {
+    auto start = std::chrono::steady_clock::now();
+    ResultsQueryResult result;
+
+    std::vector<int> track_ids = query.track_ids;
+    std::sort(track_ids.begin(), track_ids.end());
+    track_ids.erase(std::unique(track_ids.begin(), track_ids.end()), track_ids.end());
+
+    // Track queries only need the frames those tracks were alive
+    int begin_frame = query.begin_frame;
+    int end_frame = query.end_frame;
+    if (!track_ids.empty()) {
+        int alive_begin = std::numeric_limits<int>::max();
+        int alive_end = std::numeric_limits<int>::min();
+        for (int id : track_ids) {
+            auto it = tracks_.find(id);
+            if (it != tracks_.end()) {
+                alive_begin = std::min(alive_begin, it->second.first_frame);
+                alive_end = std::max(alive_end, it->second.last_frame + 1);
+            }
+        }
+        begin_frame = std::max(begin_frame, alive_begin);
+        end_frame = std::min(end_frame, alive_end);
+    }
+
+    bool timed = query.end_ms > query.begin_ms;
+    auto segment = std::partition_point(segments_.begin(), segments_.end(),
+                                        [&](const Segment& s) { return s.last_frame < begin_frame; });
+    if (timed) {
+        segment = std::partition_point(segment, segments_.end(),
+                                       [&](const Segment& s) { return s.frame_ms.back() < query.begin_ms; });
+    }
+
+    // Open hit per (track, class); a track's frames arrive in increasing order
+    std::map<std::pair<int, int>, ResultsHit> open;
+    auto record = [&](int track_id, int class_id, int frame) {
+        auto key = std::make_pair(track_id, class_id);
+        auto it = open.find(key);
+        if (it != open.end() && frame - it->second.frames.end - 1 <= query.max_gap) {
+            it->second.frames.end = frame;
+            it->second.observations++;
+            return;
+        }
+        if (it != open.end()) {
+            result.hits.push_back(it->second);
+            it->second = ResultsHit{track_id, class_id, {frame, frame}, 1};
+        } else {
+            open.emplace(key, ResultsHit{track_id, class_id, {frame, frame}, 1});
+        }
+    };
+
+    bool zoned = query.zone.width > 0 && query.zone.height > 0;
+    for (; segment != segments_.end() && segment->begin_frame < end_frame; ++segment) {
+        if (timed && segment->frame_ms.front() >= query.end_ms) {
+            break;
+        }
+        int first = 0, last = 0;
+        if (!offsetWindow(*segment, begin_frame, end_frame, query, first, last)) {
+            continue;
+        }
+        result.segments_scanned++;
+
+        for (const auto& entry : segment->postings) {
+            int class_id = entry.first;
+            const Posting& posting = entry.second;
+            if (!query.class_ids.empty() &&
+                std::find(query.class_ids.begin(), query.class_ids.end(), class_id) == query.class_ids.end()) {
+                continue;
+            }
+            if (zoned && !mayHaveCentreIn(posting.bounds, query.zone)) {
+                continue;
+            }
+
+            const auto& observations = posting.observations;
+            auto from = std::lower_bound(observations.begin(), observations.end(), first,
+                                         [](const Observation& o, int offset) { return o.frame_offset < offset; });
+            for (size_t block = (from - observations.begin()) / kBlockSize; block < posting.block_bounds.size(); ++block) {
+                size_t block_begin = block * kBlockSize;
+                size_t block_end = std::min(block_begin + kBlockSize, observations.size());
+                if (observations[block_begin].frame_offset >= last) {
+                    break;
+                }
+                if (zoned && !mayHaveCentreIn(posting.block_bounds[block], query.zone)) {
+                    continue;
+                }
+                result.blocks_scanned++;
+
+                for (size_t i = block_begin; i < block_end; ++i) {
+                    const Observation& o = observations[i];
+                    if (o.frame_offset < first || o.frame_offset >= last) {
+                        continue;
+                    }
+                    result.observations_scanned++;
+                    if (!track_ids.empty() && !std::binary_search(track_ids.begin(), track_ids.end(), o.track_id)) {
+                        continue;
+                    }
+                    if (zoned && !query.zone.contains(cv::Point(o.x + o.w / 2, o.y + o.h / 2))) {
+                        continue;
+                    }
+                    record(o.track_id, class_id, segment->begin_frame + o.frame_offset);
+                }
+            }
+        }
+    }
+
+    for (const auto& entry : open) {
+        result.hits.push_back(entry.second);
+    }
+    std::sort(result.hits.begin(), result.hits.end(), [](const ResultsHit& a, const ResultsHit& b) {
+        return a.frames.begin != b.frames.begin ? a.frames.begin < b.frames.begin : a.track_id < b.track_id;
+    });
+
+    for (const auto& hit : result.hits) {
+        if (!result.ranges.empty() && hit.frames.begin - result.ranges.back().end - 1 <= query.max_gap) {
+            result.ranges.back().end = std::max(result.ranges.back().end, hit.frames.end);
+        } else {
+            result.ranges.push_back(hit.frames);
+        }
+        result.track_ids.push_back(hit.track_id);
+    }
+    std::sort(result.track_ids.begin(), result.track_ids.end());
+    result.track_ids.erase(std::unique(result.track_ids.begin(), result.track_ids.end()), result.track_ids.end());
+
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    query_ms_->observe(result.elapsed_ms);
+    return result;
+}
+
+size_t ResultsIndex::memoryBytes() const {
+    size_t bytes = segments_.capacity() * sizeof(Segment);
+    for (const auto& segment : segments_) {
+        bytes += segment.frame_offsets.capacity() * sizeof(uint16_t);
+        bytes += segment.frame_ms.capacity() * sizeof(double);
+        for (const auto& entry : segment.postings) {
+            bytes += sizeof(entry) + 32;  // map node overhead
+            bytes += entry.second.observations.capacity() * sizeof(Observation);
+            bytes += entry.second.block_bounds.capacity() * sizeof(cv::Rect);
+        }
+    }
+    bytes += tracks_.size() * (sizeof(TrackSummary) + 32);
+    return bytes;
+}
+
+// Postings are stored as raw observations; bounds, blocks and track
+// summaries are rebuilt on load
+bool ResultsIndex::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write results index " << path << std::endl;
+        return false;
+    }
+
+    writePod(out, kIndexMagic);
+    writePod(out, kIndexVersion);
+    writePod(out, static_cast<int32_t>(segment_frames_));
+    writePod(out, static_cast<int32_t>(last_frame_));
+
+    writePod(out, static_cast<uint32_t>(class_names_.size()));
+    for (const auto& entry : class_names_) {
+        writePod(out, static_cast<int32_t>(entry.first));
+        writePod(out, static_cast<uint32_t>(entry.second.size()));
+        out.write(entry.second.data(), entry.second.size());
+    }
+
+    writePod(out, static_cast<uint32_t>(segments_.size()));
+    for (const auto& segment : segments_) {
+        writePod(out, static_cast<int32_t>(segment.begin_frame));
+        writePod(out, static_cast<uint32_t>(segment.frame_offsets.size()));
+        for (size_t i = 0; i < segment.frame_offsets.size(); ++i) {
+            writePod(out, segment.frame_offsets[i]);
+            writePod(out, segment.frame_ms[i]);
+        }
+        writePod(out, static_cast<uint32_t>(segment.postings.size()));
+        for (const auto& entry : segment.postings) {
+            writePod(out, static_cast<int32_t>(entry.first));
+            writePod(out, static_cast<uint32_t>(entry.second.observations.size()));
+            for (const auto& o : entry.second.observations) {
+                writePod(out, o.frame_offset);
+                writePod(out, o.x);
+                writePod(out, o.y);
+                writePod(out, o.w);
+                writePod(out, o.h);
+                writePod(out, o.track_id);
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+bool ResultsIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open results index " << path << std::endl;
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0, class_count = 0, segment_count = 0;
+    int32_t segment_frames = 0, last_frame = 0;
+    if (!readPod(in, magic) || magic != kIndexMagic || !readPod(in, version) || version != kIndexVersion ||
+        !readPod(in, segment_frames) || !readPod(in, last_frame) || !readPod(in, class_count)) {
+        std::cerr << "Not a results index: " << path << std::endl;
+        return false;
+    }
+
+    // Rebuild into a fresh index so a truncated file leaves this one untouched
+    ResultsIndex loaded(segment_frames);
+    for (uint32_t i = 0; i < class_count; ++i) {
+        int32_t class_id = 0;
+        uint32_t length = 0;
+        if (!readPod(in, class_id) || !readPod(in, length) || length > 4096) {
+            return false;
+        }
+        std::string name(length, '\0');
+        if (!in.read(&name[0], length)) {
+            return false;
+        }
+        loaded.class_names_[class_id] = name;
+    }
+
+    if (!readPod(in, segment_count)) {
+        return false;
+    }
+    loaded.segments_.reserve(segment_count);
+    for (uint32_t s = 0; s < segment_count; ++s) {
+        Segment segment;
+        uint32_t frame_count = 0, posting_count = 0;
+        if (!readPod(in, segment.begin_frame) || !readPod(in, frame_count) || frame_count == 0 ||
+            frame_count > 65536) {
+            return false;
+        }
+        segment.frame_offsets.resize(frame_count);
+        segment.frame_ms.resize(frame_count);
+        for (uint32_t i = 0; i < frame_count; ++i) {
+            if (!readPod(in, segment.frame_offsets[i]) || !readPod(in, segment.frame_ms[i])) {
+                return false;
+            }
+        }
+        segment.last_frame = segment.begin_frame + segment.frame_offsets.back();
+
+        if (!readPod(in, posting_count)) {
+            return false;
+        }
+        for (uint32_t p = 0; p < posting_count; ++p) {
+            int32_t class_id = 0;
+            uint32_t count = 0;
+            if (!readPod(in, class_id) || !readPod(in, count)) {
+                return false;
+            }
+            Posting& posting = segment.postings[class_id];
+            posting.observations.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                Observation o;
+                if (!readPod(in, o.frame_offset) || !readPod(in, o.x) || !readPod(in, o.y) ||
+                    !readPod(in, o.w) || !readPod(in, o.h) || !readPod(in, o.track_id)) {
+                    return false;
+                }
+                cv::Rect box(o.x, o.y, o.w, o.h);
+                if (i == 0) {
+                    posting.bounds = box;
+                } else {
+                    unite(posting.bounds, box);
+                }
+                if (i % kBlockSize == 0) {
+                    posting.block_bounds.push_back(box);
+                } else {
+                    unite(posting.block_bounds.back(), box);
+                }
+                posting.observations.push_back(o);
+
+                int frame = segment.begin_frame + o.frame_offset;
+                auto track = loaded.tracks_.find(o.track_id);
+                if (track == loaded.tracks_.end()) {
+                    loaded.tracks_.emplace(o.track_id, TrackSummary{o.track_id, class_id, frame, frame, 1, box});
+                } else {
+                    TrackSummary& summary = track->second;
+                    if (frame >= summary.last_frame) {
+                        summary.class_id = class_id;
+                    }
+                    summary.first_frame = std::min(summary.first_frame, frame);
+                    summary.last_frame = std::max(summary.last_frame, frame);
+                    summary.observations++;
+                    unite(summary.bounds, box);
+                }
+            }
+            loaded.observations_ += count;
+        }
+        loaded.segments_.push_back(std::move(segment));
+    }
+    loaded.last_frame_ = last_frame;
+
+    *this = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "detection_tracker.h"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Histogram;
+
+// Spatio-temporal query over the indexed track log. Every condition is
+// optional: empty class/track lists and an empty zone match everything.
+struct ResultsQuery {
+    int begin_frame = 0;
+    int end_frame = std::numeric_limits<int>::max();  // exclusive
+    double begin_ms = 0.0;                             // time range, used when end_ms > begin_ms
+    double end_ms = 0.0;                               // exclusive
+    std::vector<int> class_ids;
+    std::vector<int> track_ids;
+    cv::Rect zone;      // box centre must lie inside
+    int max_gap = 15;   // frames a track may go unmatched before its hit is split
+};
+
+struct FrameRange {
+    int begin;  // first frame
+    int end;    // last frame, inclusive
+};
+
+// One track matching the query over a contiguous stretch of frames
+struct ResultsHit {
+    int track_id;
+    int class_id;
+    FrameRange frames;
+    int observations;  // matching boxes within the range
+};
+
+struct ResultsQueryResult {
+    std::vector<ResultsHit> hits;      // ordered by first frame
+    std::vector<FrameRange> ranges;    // union of the hit ranges
+    std::vector<int> track_ids;        // distinct matching tracks, sorted
+    size_t segments_scanned = 0;
+    size_t blocks_scanned = 0;
+    size_t observations_scanned = 0;
+    double elapsed_ms = 0.0;
+};
+
+struct TrackSummary {
+    int track_id;
+    int class_id;
+    int first_frame;
+    int last_frame;
+    int observations;
+    cv::Rect bounds;  // union of every box of the track
+};
+
+// In-memory index over the per-frame tracking results. The log is cut into
+// segments of N frames; each segment keeps the timestamps of its frames
+// (time index) and one posting list per class, so a query only touches the
+// segments inside its time window and the classes it asks for. Postings
+// carry a bounding-box summary for the whole list and for every block of
+// 128 boxes, which prunes most of the data for zone queries without an
+// R-tree. Boxes are stored in 16 bytes each.
+//
+// Not thread-safe: append and query from the same thread.
+class ResultsIndex {
+public:
+    explicit ResultsIndex(int segment_frames = 300);
+
+    // Frames must arrive in increasing order; earlier or repeated frames are
+    // ignored and false is returned (e.g. after seeking back in live playback).
+    // Timestamps are clamped to be non-decreasing.
+    bool append(int frame_index, double timestamp_ms, const std::vector<TrackedObject>& objects);
+    void clear();
+
+    ResultsQueryResult query(const ResultsQuery& query) const;
+
+    // Lifetime of one track; false if the id was never seen
+    bool findTrack(int track_id, TrackSummary& summary) const;
+
+    // Binary index file, reloaded without the original results
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    bool empty() const { return segments_.empty(); }
+    int lastFrame() const { return last_frame_; }
+    size_t segmentCount() const { return segments_.size(); }
+    size_t observationCount() const { return observations_; }
+    size_t trackCount() const { return tracks_.size(); }
+    size_t memoryBytes() const;
+
+    // Classes seen so far, by id
+    const std::map<int, std::string>& classNames() const { return class_names_; }
+
+private:
+    struct Observation {
+        uint16_t frame_offset;  // from the segment's first frame
+        int16_t x;
+        int16_t y;
+        int16_t w;
+        int16_t h;
+        int32_t track_id;
+    };
+
+    struct Posting {
+        cv::Rect bounds;                        // union of every box
+        std::vector<Observation> observations;  // frame order
+        std::vector<cv::Rect> block_bounds;     // one per kBlockSize observations
+    };
+
+    struct Segment {
+        int begin_frame;
+        int last_frame;
+        std::vector<uint16_t> frame_offsets;  // frames appended to this segment
+        std::vector<double> frame_ms;         // their timestamps
+        std::map<int, Posting> postings;      // by class id
+    };
+
+    static const size_t kBlockSize = 128;
+
+    static void seal(Segment& segment);
+
+    // Frame offsets [first, last) of the segment that fall inside the query's frame and time window
+    bool offsetWindow(const Segment& segment, int begin_frame, int end_frame,
+                      const ResultsQuery& query, int& first, int& last) const;
+
+    int segment_frames_;
+    int last_frame_;
+    size_t observations_;
+    std::vector<Segment> segments_;
+    std::unordered_map<int, TrackSummary> tracks_;
+    std::map<int, std::string> class_names_;
+    Histogram* query_ms_;
+};
@@ -0,0 +1,138 @@
+#include "tracker_checkpoints.h"
+#include <cstring>
+
+namespace {
+
+const uint32_t kSnapshotMagic = 0x534B5254; // "TRKS"
+const uint32_t kSnapshotVersion = 1;
+
+template <typename T>
+void appendPod(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool readPod(const std::vector<uint8_t>& in, size_t& offset, T& value) {
+    if (offset + sizeof(T) > in.size()) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> TrackerSnapshot::serialize() const {
+    std::vector<uint8_t> out;
+    out.reserve(16 + tracks.size() * 52);
+
+    appendPod(out, kSnapshotMagic);
+    appendPod(out, kSnapshotVersion);
+    appendPod(out, static_cast<int32_t>(frame_index));
+    appendPod(out, static_cast<int32_t>(next_track_id));
+    appendPod(out, static_cast<uint32_t>(tracks.size()));
+
+    for (const auto& track : tracks) {
+        appendPod(out, static_cast<int32_t>(track.track_id));
+        appendPod(out, static_cast<int32_t>(track.class_id));
+        appendPod(out, track.confidence);
+        appendPod(out, static_cast<int32_t>(track.bbox.x));
+        appendPod(out, static_cast<int32_t>(track.bbox.y));
+        appendPod(out, static_cast<int32_t>(track.bbox.width));
+        appendPod(out, static_cast<int32_t>(track.bbox.height));
+        appendPod(out, static_cast<int32_t>(track.age));
+        appendPod(out, static_cast<int32_t>(track.total_hits));
+        appendPod(out, static_cast<int32_t>(track.time_since_update));
+        appendPod(out, track.position.x);
+        appendPod(out, track.position.y);
+        appendPod(out, track.velocity.x);
+        appendPod(out, track.velocity.y);
+    }
+    return out;
+}
+
+bool TrackerSnapshot::deserialize(const std::vector<uint8_t>& data, TrackerSnapshot& snapshot) {
+    size_t offset = 0;
+    uint32_t magic = 0, version = 0, count = 0;
+    int32_t frame_index = 0, next_track_id = 0;
+
+    if (!readPod(data, offset, magic) || magic != kSnapshotMagic ||
+        !readPod(data, offset, version) || version != kSnapshotVersion ||
+        !readPod(data, offset, frame_index) || !readPod(data, offset, next_track_id) ||
+        !readPod(data, offset, count)) {
+        return false;
+    }
+
+    std::vector<TrackState> tracks;
+    tracks.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t track_id, class_id, x, y, w, h, age, hits, since_update;
+        TrackState state;
+        if (!readPod(data, offset, track_id) || !readPod(data, offset, class_id) ||
+            !readPod(data, offset, state.confidence) ||
+            !readPod(data, offset, x) || !readPod(data, offset, y) ||
+            !readPod(data, offset, w) || !readPod(data, offset, h) ||
+            !readPod(data, offset, age) || !readPod(data, offset, hits) ||
+            !readPod(data, offset, since_update) ||
+            !readPod(data, offset, state.position.x) || !readPod(data, offset, state.position.y) ||
+            !readPod(data, offset, state.velocity.x) || !readPod(data, offset, state.velocity.y)) {
+            return false;
+        }
+        state.track_id = track_id;
+        state.class_id = class_id;
+        state.bbox = cv::Rect(x, y, w, h);
+        state.age = age;
+        state.total_hits = hits;
+        state.time_since_update = since_update;
+        tracks.push_back(state);
+    }
+
+    snapshot.frame_index = frame_index;
+    snapshot.next_track_id = next_track_id;
+    snapshot.tracks = std::move(tracks);
+    return true;
+}
+
+TrackerCheckpointStore::TrackerCheckpointStore(int interval, size_t max_checkpoints)
+    : interval_(std::max(1, interval)), max_checkpoints_(max_checkpoints), bytes_(0) {
+}
+
+void TrackerCheckpointStore::store(const TrackerSnapshot& snapshot) {
+    if (snapshot.frame_index < 0) {
+        return;
+    }
+
+    std::vector<uint8_t> data = snapshot.serialize();
+    auto it = checkpoints_.find(snapshot.frame_index);
+    if (it != checkpoints_.end()) {
+        bytes_ -= it->second.size();
+        bytes_ += data.size();
+        it->second = std::move(data);
+        return;
+    }
+
+    // Thin out by dropping the earliest checkpoint when full
+    if (checkpoints_.size() >= max_checkpoints_ && !checkpoints_.empty()) {
+        bytes_ -= checkpoints_.begin()->second.size();
+        checkpoints_.erase(checkpoints_.begin());
+    }
+
+    bytes_ += data.size();
+    checkpoints_.emplace(snapshot.frame_index, std::move(data));
+}
+
+bool TrackerCheckpointStore::findAtOrBefore(int frame_index, TrackerSnapshot& snapshot) const {
+    auto it = checkpoints_.upper_bound(frame_index);
+    if (it == checkpoints_.begin()) {
+        return false;
+    }
+    --it;
+    return TrackerSnapshot::deserialize(it->second, snapshot);
+}
+
+void TrackerCheckpointStore::clear() {
+    checkpoints_.clear();
+    bytes_ = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Serializable state of one track; position and velocity are the filter state
+struct TrackState {
+    int track_id;
+    int class_id;
+    float confidence;
+    cv::Rect bbox;
+    int age;
+    int total_hits;
+    int time_since_update;
+    cv::Point2f position;
+    cv::Point2f velocity;
+};
+
+// Full tracker state after a given frame, enough to resume tracking from there
+struct TrackerSnapshot {
+    int frame_index = -1;
+    int next_track_id = 0;
+    std::vector<TrackState> tracks;
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const std::vector<uint8_t>& data, TrackerSnapshot& snapshot);
+};
+
+// Serialized tracker snapshots taken every N frames, used to make random
+// seeking consistent: restore the nearest earlier checkpoint and replay
+class TrackerCheckpointStore {
+public:
+    explicit TrackerCheckpointStore(int interval = 30, size_t max_checkpoints = 10000);
+
+    void setInterval(int interval) { interval_ = std::max(1, interval); }
+    int getInterval() const { return interval_; }
+
+    bool isDue(int frame_index) const { return frame_index >= 0 && frame_index % interval_ == 0; }
+    void store(const TrackerSnapshot& snapshot);
+
+    // Latest checkpoint taken at or before frame_index
+    bool findAtOrBefore(int frame_index, TrackerSnapshot& snapshot) const;
+
+    void clear();
+    size_t count() const { return checkpoints_.size(); }
+    size_t memoryBytes() const { return bytes_; }
+
+private:
+    std::map<int, std::vector<uint8_t>> checkpoints_;
+    int interval_;
+    size_t max_checkpoints_;
+    size_t bytes_;
+};
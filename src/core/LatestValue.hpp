@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Single-producer/single-consumer "latest value" channel built on a triple
+// buffer. The producer publishes without ever blocking or waiting on the
+// consumer; the consumer picks up the newest published value (intermediate
+// ones are dropped) and keeps reading it until it asks for a newer one.
+//
+// Slots are only ever touched by one side at a time: the producer owns the
+// back slot, the consumer owns the front slot, and the middle slot is handed
+// between them with a single atomic exchange.
+template <typename T>
+class LatestValue {
+public:
+    LatestValue() : back_(0), middle_(1), front_(2), published_(0) {}
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    // Producer side
+    void publish(T value) {
+        slots_[back_] = std::move(value);
+        unsigned previous = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = previous & kIndex;
+        published_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer side: move to the newest value; false if nothing new arrived
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        unsigned previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndex;
+        return true;
+    }
+
+    // Consumer side: value picked up by the last successful update()
+    const T& current() const { return slots_[front_]; }
+
+    // Either side: number of values published so far
+    uint64_t publishedCount() const { return published_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned kIndex = 0x3;
+    static constexpr unsigned kFresh = 0x4;
+
+    T slots_[3];
+    unsigned back_;                 // producer only
+    std::atomic<unsigned> middle_;  // index | kFresh when unread
+    unsigned front_;                // consumer only
+    std::atomic<uint64_t> published_;
+};
@@ -0,0 +1,205 @@
+#include "MetricsHttpServer.hpp"
+#include "ResourceSampler.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS: SIGPIPE is not raised for sockets closed by the scraper here
+#endif
+
+namespace {
+
+std::string baseName(const std::string& name) {
+    return name.substr(0, name.find('{'));
+}
+
+std::string typeName(MetricType type) {
+    switch (type) {
+        case MetricType::Counter:
+            return "counter";
+        case MetricType::Histogram:
+            return "histogram";
+        case MetricType::Gauge:
+        default:
+            return "gauge";
+    }
+}
+
+std::string formatValue(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    std::ostringstream out;
+    out.precision(12);
+    out << value;
+    return out.str();
+}
+
+}  // namespace
+
+std::string formatPrometheus(const std::vector<MetricSnapshot>& metrics) {
+    std::ostringstream out;
+    std::string lastBase;
+    for (const auto& metric : metrics) {
+        std::string base = baseName(metric.name);
+        if (base != lastBase) {
+            if (!metric.help.empty()) {
+                out << "# HELP " << base << " " << metric.help << "\n";
+            }
+            out << "# TYPE " << base << " " << typeName(metric.type) << "\n";
+            lastBase = base;
+        }
+
+        if (metric.type != MetricType::Histogram) {
+            out << metric.name << " " << formatValue(metric.value) << "\n";
+            continue;
+        }
+
+        // Buckets are cumulative in the exposition format
+        const HistogramSnapshot& histogram = metric.histogram;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < histogram.counts.size(); ++i) {
+            cumulative += histogram.counts[i];
+            std::string le = i < histogram.bounds.size() ? formatValue(histogram.bounds[i]) : "+Inf";
+            out << base << "_bucket{le=\"" << le << "\"} " << cumulative << "\n";
+        }
+        out << base << "_sum " << formatValue(histogram.sum) << "\n";
+        out << base << "_count " << histogram.count << "\n";
+    }
+    return out.str();
+}
+
+MetricsHttpServer::MetricsHttpServer()
+    : listenSocket_(-1), port_(0), running_(false), scrapes_(0) {
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+bool MetricsHttpServer::start(int port, const std::string& bind_address) {
+    if (running_.load()) {
+        return true;
+    }
+
+    listenSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket_ < 0) {
+        std::cerr << "Metrics endpoint: socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenSocket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1 ||
+        bind(listenSocket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenSocket_, 8) < 0) {
+        std::cerr << "Metrics endpoint: cannot listen on " << bind_address << ":" << port
+                  << ": " << std::strerror(errno) << std::endl;
+        close(listenSocket_);
+        listenSocket_ = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(listenSocket_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    running_ = true;
+    thread_ = std::thread(&MetricsHttpServer::serve, this);
+    std::cout << "Metrics endpoint: http://" << bind_address << ":" << port_ << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(listenSocket_);
+    listenSocket_ = -1;
+}
+
+void MetricsHttpServer::serve() {
+    setCurrentThreadName("metrics-http");
+    pollfd listener{listenSocket_, POLLIN, 0};
+    while (running_.load()) {
+        // Wake up regularly to notice stop()
+        if (poll(&listener, 1, 200) <= 0 || !(listener.revents & POLLIN)) {
+            continue;
+        }
+        int client = accept(listenSocket_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        handleConnection(client);
+        close(client);
+    }
+}
+
+void MetricsHttpServer::handleConnection(int client) {
+    // A stalled client must not hold up the next scrape for long
+    timeval timeout{1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string status = "200 OK";
+    std::string contentType = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0) {
+        body = formatPrometheus(MetricsRegistry::global().snapshot());
+        scrapes_++;
+    } else if (request.compare(0, 4, "GET ") == 0) {
+        status = "404 Not Found";
+        contentType = "text/plain";
+        body = "Metrics are served at /metrics\n";
+    } else {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain";
+        body = "Only GET is supported\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << contentType << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string data = response.str();
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "MetricsRegistry.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Render metrics in the Prometheus text exposition format (version 0.0.4).
+// Names may carry labels ("x{thread=\"a\"}"); HELP/TYPE are written once
+// per base name.
+std::string formatPrometheus(const std::vector<MetricSnapshot>& metrics);
+
+// Minimal embedded HTTP endpoint serving GET /metrics from the global
+// registry, for headless units scraped by Prometheus. Plain blocking
+// sockets on one thread; a scrape copies atomics through
+// MetricsRegistry::snapshot() and never takes a lock the frame path holds.
+class MetricsHttpServer {
+public:
+    MetricsHttpServer();
+    ~MetricsHttpServer();
+
+    // Listen on port (0 picks a free one, see port()); false if the socket
+    // cannot be bound
+    bool start(int port, const std::string& bind_address = "0.0.0.0");
+    void stop();
+    bool isRunning() const { return running_.load(); }
+    int port() const { return port_; }
+
+    uint64_t getScrapes() const { return scrapes_.load(); }
+
+private:
+    void serve();
+    void handleConnection(int client);
+
+    int listenSocket_;
+    int port_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> scrapes_;
+    std::thread thread_;
+};
@@ -0,0 +1,298 @@
+#include "MetricsRegistry.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+double HistogramSnapshot::quantile(double q) const {
+    if (count == 0 || counts.empty()) {
+        return 0.0;
+    }
+    double target = std::clamp(q, 0.0, 1.0) * count;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0 || seen + counts[i] < target) {
+            seen += counts[i];
+            continue;
+        }
+        double lower = i == 0 ? 0.0 : bounds[i - 1];
+        if (i >= bounds.size()) {
+            return lower;  // +Inf bucket: the best we can say is its lower edge
+        }
+        double fraction = (target - seen) / counts[i];
+        return lower + (bounds[i] - lower) * fraction;
+    }
+    return bounds.empty() ? 0.0 : bounds.back();
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      counts_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.bounds = bounds_;
+    snapshot.counts.resize(bounds_.size() + 1);
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        // Count from the buckets themselves, so it always matches them even
+        // when observations land while we read
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+std::vector<double> Histogram::latencyBoundsMs() {
+    return {0.5, 1, 2, 5, 10, 20, 33, 50, 100, 200, 500, 1000, 2000};
+}
+
+SampleRing::SampleRing(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)),
+      slots_(new std::atomic<float>[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+void SampleRing::push(float value) {
+    uint64_t written = written_.load(std::memory_order_relaxed);
+    slots_[written % capacity_].store(value, std::memory_order_relaxed);
+    written_.store(written + 1, std::memory_order_release);
+}
+
+std::vector<float> SampleRing::values() const {
+    uint64_t end = written_.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+
+    std::vector<float> values;
+    values.reserve(end - begin);
+    for (uint64_t i = begin; i < end; ++i) {
+        values.push_back(slots_[i % capacity_].load(std::memory_order_relaxed));
+    }
+
+    // Drop whatever the writer overwrote while we were copying
+    uint64_t now = written_.load(std::memory_order_acquire);
+    if (now > begin + capacity_) {
+        size_t overwritten = static_cast<size_t>(std::min<uint64_t>(now - capacity_ - begin, values.size()));
+        values.erase(values.begin(), values.begin() + overwritten);
+    }
+    return values;
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    stopSampler();
+}
+
+MetricsRegistry::Entry& MetricsRegistry::entry(const std::string& name, const std::string& help, MetricType type,
+                                                std::vector<double> bounds) {
+    // The metric object is created under the same lock that publishes the
+    // entry, so the sampler never sees an entry without one
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = entries_[name];
+    if (!slot) {
+        slot.reset(new Entry());
+        slot->name = name;
+        slot->help = help;
+        slot->type = type;
+        switch (type) {
+            case MetricType::Counter:
+                slot->counter.reset(new Counter());
+                break;
+            case MetricType::Gauge:
+                slot->gauge.reset(new Gauge());
+                break;
+            case MetricType::Histogram:
+                slot->histogram.reset(new Histogram(std::move(bounds)));
+                break;
+        }
+    } else if (slot->type != type) {
+        std::cerr << "Metric '" << name << "' already registered with another type" << std::endl;
+    }
+    return *slot;
+}
+
+const MetricsRegistry::Entry* MetricsRegistry::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    return it != entries_.end() ? it->second.get() : nullptr;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+    static Counter mismatched;
+    Entry& e = entry(name, help, MetricType::Counter);
+    return e.counter ? *e.counter : mismatched;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+    static Gauge mismatched;
+    Entry& e = entry(name, help, MetricType::Gauge);
+    return e.gauge ? *e.gauge : mismatched;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, std::vector<double> bounds) {
+    static Histogram mismatched(Histogram::latencyBoundsMs());
+    Entry& e = entry(name, help, MetricType::Histogram, std::move(bounds));
+    return e.histogram ? *e.histogram : mismatched;
+}
+
+namespace {
+
+MetricSnapshot snapshotOf(const std::string& name, const std::string& help, MetricType type,
+                          const Counter* counter, const Gauge* gauge, const Histogram* histogram) {
+    MetricSnapshot metric{name, help, type, 0.0, {}};
+    if (type == MetricType::Counter && counter) {
+        metric.value = static_cast<double>(counter->value());
+    } else if (type == MetricType::Gauge && gauge) {
+        metric.value = gauge->value();
+    } else if (type == MetricType::Histogram && histogram) {
+        metric.histogram = histogram->snapshot();
+        metric.value = metric.histogram.mean();
+    }
+    return metric;
+}
+
+}  // namespace
+
+std::vector<MetricSnapshot> MetricsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MetricSnapshot> metrics;
+    metrics.reserve(entries_.size());
+    for (const auto& item : entries_) {
+        const Entry& e = *item.second;
+        metrics.push_back(snapshotOf(e.name, e.help, e.type, e.counter.get(), e.gauge.get(), e.histogram.get()));
+    }
+    return metrics;
+}
+
+bool MetricsRegistry::read(const std::string& name, MetricSnapshot& metric) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        return false;
+    }
+    const Entry& e = *it->second;
+    metric = snapshotOf(e.name, e.help, e.type, e.counter.get(), e.gauge.get(), e.histogram.get());
+    return true;
+}
+
+double MetricsRegistry::value(const std::string& name) const {
+    MetricSnapshot metric;
+    return read(name, metric) ? metric.value : 0.0;
+}
+
+std::vector<float> MetricsRegistry::history(const std::string& name, Resolution resolution) const {
+    // Entries are never removed, so the ring outlives the lookup lock
+    const Entry* e = find(name);
+    if (!e) {
+        return {};
+    }
+    switch (resolution) {
+        case Resolution::Minute:
+            return e->minutes.values();
+        case Resolution::Hour:
+            return e->hours.values();
+        case Resolution::Second:
+        default:
+            return e->seconds.values();
+    }
+}
+
+void MetricsRegistry::sample() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = lastSample_.time_since_epoch().count() == 0
+                         ? 1.0
+                         : std::chrono::duration<double>(now - lastSample_).count();
+    lastSample_ = now;
+    elapsed = std::max(elapsed, 1e-3);
+
+    std::vector<Entry*> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries.reserve(entries_.size());
+        for (auto& item : entries_) {
+            entries.push_back(item.second.get());
+        }
+    }
+
+    for (Entry* e : entries) {
+        double value = 0.0;
+        if (e->type == MetricType::Counter && e->counter) {
+            double total = static_cast<double>(e->counter->value());
+            value = (total - e->lastTotal) / elapsed;
+            e->lastTotal = total;
+        } else if (e->type == MetricType::Gauge && e->gauge) {
+            value = e->gauge->value();
+        } else if (e->type == MetricType::Histogram && e->histogram) {
+            HistogramSnapshot snapshot = e->histogram->snapshot();
+            uint64_t observed = snapshot.count - e->lastCount;
+            value = observed > 0 ? (snapshot.sum - e->lastTotal) / observed : 0.0;
+            e->lastTotal = snapshot.sum;
+            e->lastCount = snapshot.count;
+        } else {
+            continue;
+        }
+
+        // Each coarser ring holds the average of 60 samples of the finer one
+        e->seconds.push(static_cast<float>(value));
+        e->minuteSum += value;
+        if (++e->minuteSamples == 60) {
+            double minute = e->minuteSum / 60.0;
+            e->minutes.push(static_cast<float>(minute));
+            e->minuteSum = 0.0;
+            e->minuteSamples = 0;
+
+            e->hourSum += minute;
+            if (++e->hourSamples == 60) {
+                e->hours.push(static_cast<float>(e->hourSum / 60.0));
+                e->hourSum = 0.0;
+                e->hourSamples = 0;
+            }
+        }
+    }
+}
+
+void MetricsRegistry::startSampler(std::chrono::milliseconds period) {
+    std::lock_guard<std::mutex> lock(samplerMutex_);
+    if (samplerRunning_.exchange(true)) {
+        return;  // already running; both UIs call this
+    }
+    samplerThread_ = std::thread([this, period]() {
+        auto next = std::chrono::steady_clock::now() + period;
+        while (samplerRunning_.load()) {
+            std::this_thread::sleep_until(next);
+            next += period;
+            if (samplerRunning_.load()) {
+                sample();
+            }
+        }
+    });
+}
+
+void MetricsRegistry::stopSampler() {
+    std::lock_guard<std::mutex> lock(samplerMutex_);
+    if (!samplerRunning_.exchange(false)) {
+        return;
+    }
+    if (samplerThread_.joinable()) {
+        samplerThread_.join();
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Monotonic count (frames, drops, errors). Safe to bump from any thread.
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Last-written value (FPS, queue depth, active tracks)
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+struct HistogramSnapshot {
+    std::vector<double> bounds;    // upper bound of each bucket; the last bucket is +Inf
+    std::vector<uint64_t> counts;  // per bucket (not cumulative), bounds.size() + 1 entries
+    double sum = 0.0;
+    uint64_t count = 0;
+
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+    // Estimated by linear interpolation inside the bucket holding the quantile
+    double quantile(double q) const;
+};
+
+// Fixed-bucket distribution (latencies). observe() is a few relaxed atomics.
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+    HistogramSnapshot snapshot() const;
+
+    // Default buckets for millisecond latencies
+    static std::vector<double> latencyBoundsMs();
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<double> sum_{0.0};
+};
+
+// Fixed-capacity ring of samples with one writer (the registry sampler) and
+// any number of lock-free readers. A reader racing the writer may miss the
+// newest sample but never sees a torn or out-of-range one.
+class SampleRing {
+public:
+    explicit SampleRing(size_t capacity);
+
+    void push(float value);
+    // Oldest first, at most capacity samples
+    std::vector<float> values() const;
+    size_t capacity() const { return capacity_; }
+
+private:
+    size_t capacity_;
+    std::unique_ptr<std::atomic<float>[]> slots_;
+    std::atomic<uint64_t> written_{0};
+};
+
+enum class MetricType { Counter, Gauge, Histogram };
+
+// History resolutions: one sample per second / minute / hour
+enum class Resolution { Second, Minute, Hour };
+
+struct MetricSnapshot {
+    std::string name;
+    std::string help;
+    MetricType type;
+    double value;                 // counter total or gauge value
+    HistogramSnapshot histogram;  // histograms only
+};
+
+// Process-wide registry of named metrics. Registration takes a lock and
+// returns a reference that stays valid for the life of the process; hot
+// paths keep the reference and only touch atomics. A background sampler
+// turns every metric into 1 s / 1 min / 1 h histories of bounded size:
+// gauges record their value, counters their rate per second and
+// histograms the mean of what was observed in the interval.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& global();
+
+    Counter& counter(const std::string& name, const std::string& help = "");
+    Gauge& gauge(const std::string& name, const std::string& help = "");
+    Histogram& histogram(const std::string& name, const std::string& help = "",
+                         std::vector<double> bounds = Histogram::latencyBoundsMs());
+
+    // Readers (UIs, exporters)
+    std::vector<MetricSnapshot> snapshot() const;
+    bool read(const std::string& name, MetricSnapshot& metric) const;
+    double value(const std::string& name) const;
+    std::vector<float> history(const std::string& name, Resolution resolution) const;
+
+    // Record one sample of every metric; normally driven by the sampler thread
+    void sample();
+    void startSampler(std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+    void stopSampler();
+
+    ~MetricsRegistry();
+
+private:
+    MetricsRegistry() = default;
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        MetricType type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+
+        // Histories and the sampler's private downsampling state
+        SampleRing seconds{600};  // 10 minutes
+        SampleRing minutes{720};  // 12 hours
+        SampleRing hours{720};    // 30 days
+        double lastTotal = 0.0;
+        uint64_t lastCount = 0;
+        double minuteSum = 0.0;
+        int minuteSamples = 0;
+        double hourSum = 0.0;
+        int hourSamples = 0;
+    };
+
+    Entry& entry(const std::string& name, const std::string& help, MetricType type,
+                 std::vector<double> bounds = {});
+    const Entry* find(const std::string& name) const;
+
+    mutable std::mutex mutex_;  // guards the map, not the metrics
+    std::map<std::string, std::unique_ptr<Entry>> entries_;
+
+    std::thread samplerThread_;
+    std::mutex samplerMutex_;
+    std::atomic<bool> samplerRunning_{false};
+    std::chrono::steady_clock::time_point lastSample_;
+};
@@ -0,0 +1,176 @@
+#include "Pipeline.hpp"
+#include "ResourceSampler.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+Pipeline::Pipeline(std::string source)
+    : source_(std::move(source)), running_(false) {
+}
+
+Pipeline::~Pipeline() {
+    stop();
+}
+
+bool Pipeline::start() {
+    if (running_.load()) {
+        return true;
+    }
+    // A previous run may have ended on its own (camera unplugged)
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    bool camera = !source_.empty() && std::all_of(source_.begin(), source_.end(),
+                                                  [](unsigned char c) { return std::isdigit(c) != 0; });
+    bool opened = camera ? capture_.open(std::stoi(source_)) : capture_.open(source_);
+    if (!opened) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = "Cannot open " + source_;
+        return false;
+    }
+
+    running_ = true;
+    worker_ = std::thread(&Pipeline::run, this);
+    return true;
+}
+
+void Pipeline::stop() {
+    running_ = false;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    capture_.release();
+}
+
+std::shared_ptr<const ProcessedFrame> Pipeline::getLatestResult() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+PipelineStats Pipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+PipelineConfig Pipeline::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+void Pipeline::updateConfig(const PipelineConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+std::string Pipeline::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+void Pipeline::run() {
+    using Clock = std::chrono::steady_clock;
+    setCurrentThreadName("pipeline");
+
+    // Files are paced to their own frame rate; cameras pace themselves
+    const bool file = capture_.get(cv::CAP_PROP_FRAME_COUNT) > 0;
+    const double sourceFps = capture_.get(cv::CAP_PROP_FPS);
+    const auto frameInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(file && sourceFps > 0.0 ? 1.0 / sourceFps : 0.0));
+    auto nextDue = Clock::now();
+
+    // Stats are averaged over one-second windows
+    auto windowStart = Clock::now();
+    int windowFrames = 0;
+    double latencySum = 0.0;
+    double detectSum = 0.0;
+    double decodeSum = 0.0;
+    size_t detectionSum = 0;
+
+    uint64_t frameIndex = 0;
+    bool rewound = false;
+    while (running_.load()) {
+        auto captureTime = Clock::now();
+        cv::Mat frame;
+        {
+            TraceSpan span("capture", static_cast<int>(frameIndex));
+            capture_ >> frame;
+        }
+        if (frame.empty()) {
+            // Loop files; an empty read right after rewinding means nothing is decodable
+            if (file && !rewound && capture_.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                rewound = true;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            lastError_ = "Source ended: " + source_;
+            break;
+        }
+        rewound = false;
+        auto decoded = Clock::now();
+
+        PipelineConfig config = getConfig();
+        auto result = std::make_shared<ProcessedFrame>();
+        result->frameIndex = frameIndex;
+        result->captureTime = captureTime;
+        result->frame = frame;
+        if (detector_) {
+            TraceSpan span("detect", static_cast<int>(frameIndex));
+            result->detections = detector_(frame, config);
+            if (config.maxDetections > 0 && static_cast<int>(result->detections.size()) > config.maxDetections) {
+                std::sort(result->detections.begin(), result->detections.end(),
+                          [](const FrameDetection& a, const FrameDetection& b) { return a.confidence > b.confidence; });
+                result->detections.resize(config.maxDetections);
+            }
+        }
+        auto done = Clock::now();
+        frameIndex++;
+
+        std::shared_ptr<const ProcessedFrame> published = std::move(result);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            latest_ = published;
+            stats_.totalFrames++;
+        }
+        if (callback_) {
+            callback_(published);
+        }
+
+        windowFrames++;
+        latencySum += std::chrono::duration<double, std::micro>(done - captureTime).count();
+        detectSum += std::chrono::duration<double, std::micro>(done - decoded).count();
+        decodeSum += std::chrono::duration<double, std::micro>(decoded - captureTime).count();
+        detectionSum += published->detections.size();
+        double windowSeconds = std::chrono::duration<double>(done - windowStart).count();
+        if (windowSeconds >= 1.0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.currentFPS = static_cast<float>(windowFrames / windowSeconds);
+            stats_.averageLatency = static_cast<float>(latencySum / windowFrames);
+            stats_.detectionStats.averageDetectionTime = static_cast<float>(detectSum / windowFrames);
+            stats_.detectionStats.averageDetectionsPerFrame = static_cast<float>(detectionSum) / windowFrames;
+            stats_.preprocessingStats.averageProcessingTime = static_cast<float>(decodeSum / windowFrames);
+            if (ResourceSampler::isSupported()) {
+                ResourceUsage usage = ResourceSampler::global().latest();
+                stats_.performanceStats.cpuUsage = static_cast<float>(usage.cpuPercent);
+                stats_.performanceStats.memoryUsage = static_cast<float>(usage.rssBytes);
+            }
+            windowStart = done;
+            windowFrames = 0;
+            latencySum = detectSum = decodeSum = 0.0;
+            detectionSum = 0;
+        }
+
+        if (frameInterval.count() > 0) {
+            nextDue += frameInterval;
+            auto now = Clock::now();
+            if (nextDue < now) {
+                nextDue = now;  // behind: do not try to catch up
+            } else {
+                std::this_thread::sleep_until(nextDue);
+            }
+        }
+    }
+    running_ = false;
+}
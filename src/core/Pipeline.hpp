@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Types.hpp"
+#include <opencv2/videoio.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal capture -> detect pipeline for the real-time viewer. One worker
+// thread decodes the source and runs the detector on every frame; the newest
+// result is kept for getLatestResult and handed to the result callback (the
+// viewer's publishResult). Video files are paced to their frame rate and
+// loop; cameras run as fast as they deliver.
+class Pipeline {
+public:
+    // Runs on the worker thread; returns the objects found in a BGR frame
+    using Detector = std::function<std::vector<FrameDetection>(const cv::Mat& frame, const PipelineConfig& config)>;
+    using ResultCallback = std::function<void(std::shared_ptr<const ProcessedFrame> result)>;
+
+    // source: video file path, or a camera index as digits
+    explicit Pipeline(std::string source);
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Set before start(); without a detector frames pass through unannotated
+    void setDetector(Detector detector) { detector_ = std::move(detector); }
+    void setResultCallback(ResultCallback callback) { callback_ = std::move(callback); }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    std::shared_ptr<const ProcessedFrame> getLatestResult() const;
+    PipelineStats getStats() const;
+
+    // Read by the worker before each frame
+    PipelineConfig getConfig() const;
+    void updateConfig(const PipelineConfig& config);
+
+    std::string getLastError() const;
+
+private:
+    void run();
+
+    std::string source_;
+    cv::VideoCapture capture_;
+    Detector detector_;
+    ResultCallback callback_;
+
+    std::thread worker_;
+    std::atomic<bool> running_;
+
+    mutable std::mutex mutex_;  // guards everything below
+    std::shared_ptr<const ProcessedFrame> latest_;
+    PipelineConfig config_;
+    PipelineStats stats_;
+    std::string lastError_;
+};
@@ -0,0 +1,246 @@
+#include "ResourceSampler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+void setCurrentThreadName(const std::string& name) {
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+#else
+    (void)name;
+#endif
+}
+
+namespace {
+
+// Fields of /proc/<pid>/stat after "pid (comm)". comm may itself contain
+// spaces and parentheses, so it is taken up to the last ')'.
+bool parseStat(const std::string& line, std::string& comm, std::vector<std::string>& fields) {
+    size_t open = line.find('(');
+    size_t close = line.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        return false;
+    }
+    comm = line.substr(open + 1, close - open - 1);
+    fields.clear();
+    std::istringstream rest(line.substr(close + 1));
+    std::string field;
+    while (rest >> field) {
+        fields.push_back(field);
+    }
+    // fields[0] is state (stat field 3); utime/stime are stat fields 14/15
+    return fields.size() > 12;
+}
+
+std::string readLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+}  // namespace
+
+ResourceSampler& ResourceSampler::global() {
+    static ResourceSampler sampler;
+    return sampler;
+}
+
+bool ResourceSampler::isSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+ResourceSampler::ResourceSampler()
+    : ticksPerSecond_(100), pageSize_(4096), lastProcessTicks_(0),
+      lastMinorFaults_(0), lastMajorFaults_(0), running_(false) {
+#ifdef __linux__
+    ticksPerSecond_ = sysconf(_SC_CLK_TCK);
+    pageSize_ = sysconf(_SC_PAGESIZE);
+#endif
+}
+
+ResourceSampler::~ResourceSampler() {
+    stop();
+}
+
+bool ResourceSampler::readTasks(std::map<int, ThreadTimes>& tasks) const {
+#ifdef __linux__
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return false;
+    }
+    std::string comm;
+    std::vector<std::string> fields;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        // Threads can exit between readdir and the read; skip those
+        std::string line = readLine(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        if (!parseStat(line, comm, fields)) {
+            continue;
+        }
+        tasks[std::atoi(entry->d_name)] = {comm, std::stoull(fields[11]) + std::stoull(fields[12])};
+    }
+    closedir(dir);
+    return true;
+#else
+    (void)tasks;
+    return false;
+#endif
+}
+
+bool ResourceSampler::sample() {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(sampleMutex_);
+
+    std::string comm;
+    std::vector<std::string> fields;
+    if (!parseStat(readLine("/proc/self/stat"), comm, fields)) {
+        return false;
+    }
+    // minflt/majflt are stat fields 10/12, num_threads field 20
+    uint64_t minorFaults = std::stoull(fields[7]);
+    uint64_t majorFaults = std::stoull(fields[9]);
+    uint64_t processTicks = std::stoull(fields[11]) + std::stoull(fields[12]);
+
+    std::map<int, ThreadTimes> tasks;
+    readTasks(tasks);
+
+    auto now = std::chrono::steady_clock::now();
+    bool first = lastSample_.time_since_epoch().count() == 0;
+    double elapsedTicks = first ? 0.0
+                                : std::chrono::duration<double>(now - lastSample_).count() * ticksPerSecond_;
+
+    ResourceUsage usage;
+    usage.threadCount = static_cast<int>(tasks.size());
+    usage.minorFaults = minorFaults;
+    usage.majorFaults = majorFaults;
+    if (elapsedTicks > 0.0) {
+        usage.cpuPercent = 100.0 * (processTicks - lastProcessTicks_) / elapsedTicks;
+
+        // Threads that started since the last sample count from zero
+        std::map<std::string, ThreadUsage> byName;
+        for (const auto& task : tasks) {
+            auto previous = lastTasks_.find(task.first);
+            uint64_t before = previous != lastTasks_.end() ? previous->second.ticks : 0;
+            ThreadUsage& named = byName[task.second.name];
+            named.name = task.second.name;
+            named.threads++;
+            named.cpuPercent += 100.0 * (task.second.ticks - std::min(before, task.second.ticks)) / elapsedTicks;
+        }
+        for (auto& named : byName) {
+            usage.threads.push_back(named.second);
+        }
+        std::sort(usage.threads.begin(), usage.threads.end(),
+                  [](const ThreadUsage& a, const ThreadUsage& b) { return a.cpuPercent > b.cpuPercent; });
+    }
+
+    // statm: size resident shared text lib data dt, in pages
+    std::istringstream statm(readLine("/proc/self/statm"));
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    usage.rssBytes = static_cast<double>(resident) * pageSize_;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 heap = mallinfo2();
+    usage.heapInUseBytes = static_cast<double>(heap.uordblks);
+    usage.heapMappedBytes = static_cast<double>(heap.hblkhd);
+#endif
+
+    publish(usage, first ? minorFaults : minorFaults - lastMinorFaults_,
+            first ? majorFaults : majorFaults - lastMajorFaults_);
+
+    lastTasks_ = std::move(tasks);
+    lastProcessTicks_ = processTicks;
+    lastMinorFaults_ = minorFaults;
+    lastMajorFaults_ = majorFaults;
+    lastSample_ = now;
+
+    std::lock_guard<std::mutex> latestLock(latestMutex_);
+    latest_ = std::move(usage);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ResourceSampler::publish(const ResourceUsage& usage, uint64_t minorDelta, uint64_t majorDelta) {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static Gauge& cpu = registry.gauge("process_cpu_percent", "Process CPU usage, 100 = one core");
+    static Gauge& rss = registry.gauge("process_rss_bytes", "Resident set size");
+    static Gauge& heap = registry.gauge("process_heap_in_use_bytes", "Heap bytes allocated and not freed");
+    static Gauge& mapped = registry.gauge("process_heap_mapped_bytes", "Heap bytes served by mmap");
+    static Gauge& threads = registry.gauge("process_threads", "Live threads");
+    static Counter& minor = registry.counter("process_minor_faults_total", "Minor page faults");
+    static Counter& major = registry.counter("process_major_faults_total", "Major page faults");
+
+    cpu.set(usage.cpuPercent);
+    rss.set(usage.rssBytes);
+    heap.set(usage.heapInUseBytes);
+    mapped.set(usage.heapMappedBytes);
+    threads.set(usage.threadCount);
+    minor.add(minorDelta);
+    major.add(majorDelta);
+
+    // Names that disappear keep their gauge; it reads 0 once they are gone
+    for (auto& gauge : threadGauges_) {
+        gauge.second->set(0.0);
+    }
+    for (const auto& thread : usage.threads) {
+        Gauge*& gauge = threadGauges_[thread.name];
+        if (!gauge) {
+            gauge = &registry.gauge("process_thread_cpu_percent{thread=\"" + thread.name + "\"}",
+                                    "CPU usage per thread name, 100 = one core");
+        }
+        gauge->set(thread.cpuPercent);
+    }
+}
+
+ResourceUsage ResourceSampler::latest() const {
+    std::lock_guard<std::mutex> lock(latestMutex_);
+    return latest_;
+}
+
+void ResourceSampler::start(std::chrono::milliseconds period) {
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (!isSupported() || running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread([this, period]() {
+        setCurrentThreadName("res-sampler");
+        auto next = std::chrono::steady_clock::now();
+        while (running_.load()) {
+            sample();
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+}
+
+void ResourceSampler::stop() {
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MetricsRegistry.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Name the calling thread so the resource sampler (and top -H, perf, gdb)
+// can attribute its CPU time. Linux keeps at most 15 characters.
+void setCurrentThreadName(const std::string& name);
+
+struct ThreadUsage {
+    std::string name;
+    int threads;          // live threads sharing the name
+    double cpuPercent;    // 100 = one full core
+};
+
+struct ResourceUsage {
+    double cpuPercent = 0.0;       // whole process, 100 = one full core
+    double rssBytes = 0.0;
+    double heapInUseBytes = 0.0;   // malloc'd and not yet freed (glibc)
+    double heapMappedBytes = 0.0;  // large allocations served by mmap (glibc)
+    uint64_t minorFaults = 0;
+    uint64_t majorFaults = 0;
+    int threadCount = 0;
+    std::vector<ThreadUsage> threads;  // busiest first
+};
+
+// Low-rate sampler of the process's own resource usage on Linux, read from
+// /proc/self/stat, /proc/self/task/*/stat and /proc/self/statm. CPU time is
+// summed per thread name, so a pipeline stage that sits near 100% is the
+// one saturating its core. Each sample is also published to the metrics
+// registry as process_* gauges/counters and
+// process_thread_cpu_percent{thread="<name>"}.
+class ResourceSampler {
+public:
+    static ResourceSampler& global();
+    static bool isSupported();
+
+    // Read /proc now; false where it is not available
+    bool sample();
+    ResourceUsage latest() const;
+
+    void start(std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+    void stop();
+
+    ~ResourceSampler();
+
+private:
+    ResourceSampler();
+
+    struct ThreadTimes {
+        std::string name;
+        uint64_t ticks;
+    };
+    bool readTasks(std::map<int, ThreadTimes>& tasks) const;
+    void publish(const ResourceUsage& usage, uint64_t minorDelta, uint64_t majorDelta);
+
+    long ticksPerSecond_;
+    long pageSize_;
+
+    // Sampler-side state; a sample runs on one thread at a time
+    std::mutex sampleMutex_;
+    std::map<int, ThreadTimes> lastTasks_;
+    uint64_t lastProcessTicks_;
+    uint64_t lastMinorFaults_;
+    uint64_t lastMajorFaults_;
+    std::chrono::steady_clock::time_point lastSample_;
+    std::map<std::string, Gauge*> threadGauges_;
+
+    mutable std::mutex latestMutex_;
+    ResourceUsage latest_;
+
+    std::thread thread_;
+    std::mutex threadMutex_;
+    std::atomic<bool> running_;
+};
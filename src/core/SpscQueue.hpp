@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded single-producer/single-consumer FIFO on a ring buffer. Unlike
+// LatestValue nothing is dropped silently: the producer gets false when the
+// ring is full and decides what to do with the value. Neither side ever
+// blocks or takes a lock.
+//
+// head_ is written only by the consumer and tail_ only by the producer; each
+// side caches the other's index and only reloads it when the ring looks
+// full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue {
+public:
+    // Holds up to capacity values
+    explicit SpscQueue(size_t capacity)
+        : slots_(capacity + 1), head_(0), tail_(0), cached_head_(0), cached_tail_(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side; value is left untouched when the queue is full
+    bool tryPush(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t next = increment(tail);
+        if (next == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (next == cached_head_) {
+                return false;
+            }
+        }
+        slots_[tail] = std::move(value);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool tryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head]);
+        slots_[head] = T();  // release what the slot held now, not a lap later
+        head_.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    // Either side; exact only when the other side is idle
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + slots_.size() - head;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return slots_.size() - 1; }
+
+private:
+    size_t increment(size_t index) const { return index + 1 == slots_.size() ? 0 : index + 1; }
+
+    std::vector<T> slots_;
+    alignas(64) std::atomic<size_t> head_;  // next slot to pop, consumer-owned
+    alignas(64) std::atomic<size_t> tail_;  // next slot to push, producer-owned
+    alignas(64) size_t cached_head_;        // producer's view of head_
+    alignas(64) size_t cached_tail_;        // consumer's view of tail_
+};
@@ -0,0 +1,178 @@
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+// Owned by each recording thread; marks its buffer retired on thread exit
+// so the next start() can drop it
+struct ThreadBufferHandle {
+    std::shared_ptr<TraceRecorder::ThreadBuffer> buffer;
+
+    ~ThreadBufferHandle() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->retired = true;
+        }
+    }
+};
+
+namespace {
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+}  // namespace
+
+TraceRecorder& TraceRecorder::global() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+    : recording_(false), capacity_(1 << 16), nextThreadId_(1) {
+}
+
+uint64_t TraceRecorder::nowMicros() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    // Offset by one so 0 can mean "not recording" in TraceSpan
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - epoch).count()) + 1;
+}
+
+std::string TraceRecorder::currentThreadName() {
+#if defined(__linux__) || defined(__APPLE__)
+    char name[64] = {0};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0] != '\0') {
+        return name;
+    }
+#endif
+    return "thread";
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer() {
+    thread_local ThreadBufferHandle handle;
+    if (!handle.buffer) {
+        handle.buffer = std::make_shared<ThreadBuffer>();
+        handle.buffer->threadName = currentThreadName();
+        handle.buffer->events.resize(capacity_.load());
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        handle.buffer->id = nextThreadId_++;
+        buffers_.push_back(handle.buffer);
+    }
+    return *handle.buffer;
+}
+
+void TraceRecorder::start(size_t eventsPerThread) {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    capacity_ = std::max<size_t>(1, eventsPerThread);
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                  [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                                      return buffer->retired;
+                                  }),
+                   buffers_.end());
+    for (auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.assign(capacity_.load(), Event{nullptr, 0, 0, -1});
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+    recording_ = true;
+}
+
+void TraceRecorder::stop() {
+    recording_ = false;
+}
+
+void TraceRecorder::record(const char* name, uint64_t startUs, uint64_t endUs, int frame) {
+    if (!isRecording()) {
+        return;
+    }
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.next] = Event{name, startUs, endUs > startUs ? endUs - startUs : 0, frame};
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+size_t TraceRecorder::eventCount() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    size_t count = 0;
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->wrapped ? buffer->events.size() : buffer->next;
+    }
+    return count;
+}
+
+bool TraceRecorder::writeChromeTrace(const std::string& path, std::chrono::milliseconds lastWindow) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "TraceRecorder: cannot write " << path << std::endl;
+        return false;
+    }
+
+    uint64_t now = nowMicros();
+    uint64_t windowUs = static_cast<uint64_t>(lastWindow.count()) * 1000;
+    uint64_t from = windowUs > 0 && now > windowUs ? now - windowUs : 0;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    size_t written = 0;
+
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        // Copy under the buffer lock, format without it
+        std::vector<Event> events;
+        std::string threadName;
+        int id = 0;
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            if (buffer->wrapped) {
+                events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+            }
+            events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+            threadName = buffer->threadName;
+            id = buffer->id;
+        }
+
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id
+            << ",\"args\":{\"name\":\"" << escapeJson(threadName) << "\"}}";
+        first = false;
+
+        for (const auto& event : events) {
+            if (!event.name || event.start < from) {
+                continue;
+            }
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << id
+                << ",\"ts\":" << event.start << ",\"dur\":" << event.duration;
+            if (event.frame >= 0) {
+                out << ",\"args\":{\"frame\":" << event.frame << "}";
+            }
+            out << "}";
+            written++;
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "TraceRecorder: wrote " << written << " spans to " << path << std::endl;
+    return static_cast<bool>(out);
+}
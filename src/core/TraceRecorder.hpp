@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-frame span recorder for pipeline profiling. Spans go into a ring
+// buffer owned by the recording thread, so threads never contend with each
+// other; the only shared cost is one relaxed load when recording is off.
+// The result is written as Chrome trace JSON, which chrome://tracing and
+// ui.perfetto.dev both open, with one track per named thread.
+class TraceRecorder {
+public:
+    static TraceRecorder& global();
+
+    // Clear previous spans and start recording. Each thread keeps its most
+    // recent eventsPerThread spans, so a long run can be dumped as "the last
+    // N seconds" at any point.
+    void start(size_t eventsPerThread = 1 << 16);
+    void stop();
+    bool isRecording() const { return recording_.load(std::memory_order_relaxed); }
+
+    // Microseconds on the recorder's steady clock
+    static uint64_t nowMicros();
+
+    // Record a finished interval on the calling thread; name must outlive the
+    // recorder (a string literal)
+    void record(const char* name, uint64_t startUs, uint64_t endUs, int frame = -1);
+
+    // Write spans (only those that started within lastWindow, if given)
+    bool writeChromeTrace(const std::string& path,
+                          std::chrono::milliseconds lastWindow = std::chrono::milliseconds(0)) const;
+    size_t eventCount() const;
+
+private:
+    TraceRecorder();
+
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+        int frame;
+    };
+
+    struct ThreadBuffer {
+        int id;
+        std::string threadName;
+        std::mutex mutex;  // uncontended except while a trace is written
+        std::vector<Event> events;
+        size_t next = 0;
+        bool wrapped = false;
+        bool retired = false;  // owning thread has exited
+    };
+
+    ThreadBuffer& localBuffer();
+    static std::string currentThreadName();
+
+    mutable std::mutex buffersMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::atomic<bool> recording_;
+    std::atomic<size_t> capacity_;
+    int nextThreadId_;
+
+    friend struct ThreadBufferHandle;
+};
+
+// Scoped span: records [construction, destruction) when a trace is running
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, int frame = -1)
+        : name_(name), frame_(frame),
+          start_(TraceRecorder::global().isRecording() ? TraceRecorder::nowMicros() : 0) {}
+
+    ~TraceSpan() {
+        if (start_ != 0) {
+            TraceRecorder::global().record(name_, start_, TraceRecorder::nowMicros(), frame_);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int frame_;
+    uint64_t start_;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One detected (and possibly tracked) object, in source frame pixels
+struct FrameDetection {
+    cv::Rect bbox;
+    float confidence = 0.0f;
+    int classId = -1;
+    std::string className;
+    int trackId = -1;  // -1 when the detector does not track
+};
+
+// Immutable result of one pipeline step; shared between the pipeline and
+// the viewer, so nothing in it may change after it is published
+struct ProcessedFrame {
+    uint64_t frameIndex = 0;
+    std::chrono::steady_clock::time_point captureTime;
+    cv::Mat frame;  // BGR
+    std::vector<FrameDetection> detections;
+};
+
+struct PipelineConfig {
+    float confidenceThreshold = 0.3f;
+    float nmsThreshold = 0.4f;
+    int maxDetections = 100;
+};
+
+// Times are in microseconds, averaged over the last second of frames
+struct PipelineStats {
+    float currentFPS = 0.0f;
+    float averageLatency = 0.0f;  // capture to result
+    unsigned long long totalFrames = 0;
+
+    struct {
+        float cpuUsage = 0.0f;     // percent
+        float memoryUsage = 0.0f;  // bytes
+        float gpuUsage = 0.0f;     // percent, 0 when unknown
+    } performanceStats;
+
+    struct {
+        float averageDetectionsPerFrame = 0.0f;
+        float averageDetectionTime = 0.0f;
+    } detectionStats;
+
+    struct {
+        float averageProcessingTime = 0.0f;  // capture and decode
+    } preprocessingStats;
+};
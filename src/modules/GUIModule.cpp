@@ -1,16 +1,50 @@
 #include "GUIModule.hpp"
-#include <iostream>
+#ifdef GUI_BACKEND_METAL
+#include <imgui_impl_metal.h>
+#include <opencv2/imgproc.hpp>
+#else
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+#endif
 #include <chrono>
 #include <algorithm>
+#include <cstring>
+
+namespace {
+// Wait timeouts of the render loop: polling a pipeline that does not publish,
+// refreshing the performance overlay, and fully idle
+constexpr double kPollIntervalSeconds = 1.0 / 60.0;
+constexpr double kStatsIntervalSeconds = 0.25;
+constexpr double kIdleIntervalSeconds = 1.0;
+}
 
 GUIModule::GUIModule(std::shared_ptr<Pipeline> pipeline)
     : pipeline_(pipeline)
     , window_(nullptr)
+#ifdef GUI_BACKEND_METAL
     , device_(nullptr)
     , commandQueue_(nullptr)
     , videoTexture_(nullptr)
     , renderPassDescriptor_(nullptr)
+#else
+    , videoTexture_(0)
+    , uploadBuffers_{0, 0}
+    , uploadPointers_{nullptr, nullptr}
+    , uploadFences_{nullptr, nullptr}
+    , uploadIndex_(0)
+    , persistentMapping_(false)
+    , uploadBufferSize_(0)
+#endif
+    , textureWidth_(0)
+    , textureHeight_(0)
+    , skippedUploads_(0)
+    , videoOrigin_(0.0f, 0.0f)
     , imguiContext_(nullptr)
+    , redrawRequested_(true)
+    , pendingRedraws_(0)
+    , renderedFrames_(0)
+    , skippedRedraws_(0)
+    , presentLatencyMs_(0.0f)
     , windowWidth_(1280)
     , windowHeight_(720)
     , fullscreen_(false)
@@ -18,6 +52,12 @@ GUIModule::GUIModule(std::shared_ptr<Pipeline> pipeline)
     , showDetectionOverlay_(true)
     , running_(false)
     , shouldStop_(false)
+    , fpsGauge_(MetricsRegistry::global().gauge("pipeline_fps", "Pipeline output frames per second"))
+    , latencyGauge_(MetricsRegistry::global().gauge("pipeline_latency_ms", "Pipeline average frame latency"))
+    , cpuGauge_(MetricsRegistry::global().gauge("pipeline_cpu_percent", "CPU usage reported by the pipeline"))
+    , gpuGauge_(MetricsRegistry::global().gauge("pipeline_gpu_percent", "GPU usage reported by the pipeline"))
+    , presentLatency_(MetricsRegistry::global().histogram("gui_present_latency_ms", "Capture to on-screen latency"))
+    , historyResolution_(Resolution::Second)
     , showControls_(true)
     , showStats_(true)
     , showConfig_(false)
@@ -32,14 +72,22 @@ GUIModule::~GUIModule() {
 bool GUIModule::initialize(int width, int height, const std::string& title) {
     windowWidth_ = width;
     windowHeight_ = height;
+    MetricsRegistry::global().startSampler();
+    ResourceSampler::global().start();
     
     if (!setupGLFW()) {
         return false;
     }
     
+#ifdef GUI_BACKEND_METAL
     if (!setupMetal()) {
         return false;
     }
+#else
+    if (!setupOpenGL()) {
+        return false;
+    }
+#endif
     
     if (!setupImGui()) {
         return false;
@@ -59,8 +107,15 @@ bool GUIModule::setupGLFW() {
         return false;
     }
     
+#ifdef GUI_BACKEND_METAL
     // Configure GLFW for Metal
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+#else
+    // OpenGL 3.3 core is what Mesa's llvmpipe offers without a GPU
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     
     window_ = glfwCreateWindow(windowWidth_, windowHeight_, "Real-time Car Vision", nullptr, nullptr);
@@ -69,6 +124,11 @@ bool GUIModule::setupGLFW() {
         return false;
     }
     
+#ifndef GUI_BACKEND_METAL
+    glfwMakeContextCurrent(window_);
+    glfwSwapInterval(1);  // present on vblank; run() sleeps until there is something to draw
+#endif
+    
     // Set up callbacks
     glfwSetWindowUserPointer(window_, this);
     
@@ -87,9 +147,27 @@ bool GUIModule::setupGLFW() {
         gui->handleMouseButton(button, action);
     });
     
+    // Any other input or window change also needs a redraw
+    glfwSetScrollCallback(window_, [](GLFWwindow* window, double x, double y) {
+        static_cast<GUIModule*>(glfwGetWindowUserPointer(window))->requestRedraw();
+    });
+    glfwSetCharCallback(window_, [](GLFWwindow* window, unsigned int codepoint) {
+        static_cast<GUIModule*>(glfwGetWindowUserPointer(window))->requestRedraw();
+    });
+    glfwSetFramebufferSizeCallback(window_, [](GLFWwindow* window, int width, int height) {
+        static_cast<GUIModule*>(glfwGetWindowUserPointer(window))->requestRedraw();
+    });
+    glfwSetWindowRefreshCallback(window_, [](GLFWwindow* window) {
+        static_cast<GUIModule*>(glfwGetWindowUserPointer(window))->requestRedraw();
+    });
+    glfwSetWindowFocusCallback(window_, [](GLFWwindow* window, int focused) {
+        static_cast<GUIModule*>(glfwGetWindowUserPointer(window))->requestRedraw();
+    });
+    
     return true;
 }
 
+#ifdef GUI_BACKEND_METAL
 bool GUIModule::setupMetal() {
     device_ = MTLCreateSystemDefaultDevice();
     if (!device_) {
@@ -105,6 +183,87 @@ bool GUIModule::setupMetal() {
     
     return true;
 }
+#else
+bool GUIModule::setupOpenGL() {
+    if (!glGetString(GL_VERSION)) {
+        lastError_ = "No current OpenGL context";
+        return false;
+    }
+    
+    // Persistent mapping avoids a map/unmap per frame; without it buffers are orphaned instead
+    persistentMapping_ = glfwExtensionSupported("GL_ARB_buffer_storage") == GLFW_TRUE;
+    
+    glGenTextures(1, &videoTexture_);
+    glGenBuffers(2, uploadBuffers_);
+    return videoTexture_ != 0;
+}
+
+bool GUIModule::resizeVideoTexture(int width, int height) {
+    // Buffers still in flight are about to be destroyed
+    for (int i = 0; i < 2; ++i) {
+        if (uploadFences_[i]) {
+            glClientWaitSync(uploadFences_[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(uploadFences_[i]);
+            uploadFences_[i] = nullptr;
+        }
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, videoTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // Buffer storage is immutable, so a new size needs new buffers
+    glDeleteBuffers(2, uploadBuffers_);
+    glGenBuffers(2, uploadBuffers_);
+    uploadBufferSize_ = static_cast<size_t>(width) * height * 3;
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers_[i]);
+        if (persistentMapping_) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, uploadBufferSize_, nullptr, flags);
+            uploadPointers_[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, uploadBufferSize_, flags);
+            if (!uploadPointers_[i]) {
+                lastError_ = "Failed to map pixel upload buffer";
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                return false;
+            }
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBufferSize_, nullptr, GL_STREAM_DRAW);
+            uploadPointers_[i] = nullptr;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    
+    textureWidth_ = width;
+    textureHeight_ = height;
+    uploadIndex_ = 0;
+    return true;
+}
+
+void GUIModule::destroyOpenGL() {
+    for (int i = 0; i < 2; ++i) {
+        if (uploadFences_[i]) {
+            glDeleteSync(uploadFences_[i]);
+            uploadFences_[i] = nullptr;
+        }
+        if (uploadPointers_[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers_[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            uploadPointers_[i] = nullptr;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(2, uploadBuffers_);
+    glDeleteTextures(1, &videoTexture_);
+    videoTexture_ = 0;
+    textureWidth_ = 0;
+    textureHeight_ = 0;
+}
+#endif
 
 bool GUIModule::setupImGui() {
     IMGUI_CHECKVERSION();
@@ -116,8 +275,6 @@ bool GUIModule::setupImGui() {
     
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
     
     // Set up ImGui style
     ImGui::StyleColorsDark();
@@ -126,14 +283,26 @@ bool GUIModule::setupImGui() {
     style.FrameRounding = 3.0f;
     style.GrabRounding = 3.0f;
     
+#ifdef GUI_BACKEND_METAL
     // Initialize ImGui for Metal
     // Note: This is a simplified implementation
     // Full implementation would require Metal-specific ImGui backend
+#else
+    // Installs GLFW callbacks that chain to the ones set in setupGLFW
+    if (!ImGui_ImplGlfw_InitForOpenGL(window_, true) || !ImGui_ImplOpenGL3_Init("#version 330 core")) {
+        lastError_ = "Failed to initialize ImGui OpenGL backend";
+        return false;
+    }
+#endif
     
     return true;
 }
 
 bool GUIModule::createRenderTargets() {
+#ifndef GUI_BACKEND_METAL
+    // The video texture and its upload buffers are sized on the first frame
+    return true;
+#else
     // Create video texture
     MTLTextureDescriptor* textureDesc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA8Unorm
                                                                                            width:windowWidth_
@@ -153,30 +322,89 @@ bool GUIModule::createRenderTargets() {
     }
     
     return true;
+#endif
 }
 
 void GUIModule::run() {
+    auto lastStatsRefresh = std::chrono::steady_clock::now();
+    
     while (!shouldStop_.load() && !glfwWindowShouldClose(window_)) {
-        glfwPollEvents();
+        // Sleep until input, a published result (publishResult posts an empty
+        // event) or the next overlay refresh. A pipeline that does not publish
+        // has to be polled instead.
+        if (pendingRedraws_ > 0) {
+            glfwPollEvents();
+        } else {
+            double timeout = (results_.publishedCount() == 0 && pipeline_->isRunning()) ? kPollIntervalSeconds :
+                             showPerformanceOverlay_ ? kStatsIntervalSeconds : kIdleIntervalSeconds;
+            glfwWaitEventsTimeout(timeout);
+        }
+        
+        bool newResult = acquireLatestResult();
+        if (redrawRequested_.exchange(false)) {
+            // ImGui needs a second frame to settle hover/active state after input
+            pendingRedraws_ = std::max(pendingRedraws_, 2);
+        }
+        auto now = std::chrono::steady_clock::now();
+        bool statsDue = showPerformanceOverlay_ &&
+                        std::chrono::duration<double>(now - lastStatsRefresh).count() >= kStatsIntervalSeconds;
+        
+        // Nothing changed on screen: do not redraw
+        if (!newResult && pendingRedraws_ == 0 && !statsDue) {
+            skippedRedraws_++;
+            continue;
+        }
+        if (pendingRedraws_ > 0) {
+            pendingRedraws_--;
+        }
+        if (statsDue) {
+            lastStatsRefresh = now;
+            updatePerformanceHistory();
+        }
         
         // Start ImGui frame
+#ifdef GUI_BACKEND_METAL
         ImGui_ImplMetal_NewFrame(renderPassDescriptor_);
+#else
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+#endif
         ImGui::NewFrame();
         
         // Render GUI
-        renderFrame();
+        {
+            TraceSpan span("draw");
+            renderFrame();
+        }
         
         // Render ImGui
         ImGui::Render();
         
         // Present frame
+#ifdef GUI_BACKEND_METAL
         // Note: This is simplified - full implementation would use Metal rendering
+#else
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        glfwGetFramebufferSize(window_, &framebufferWidth, &framebufferHeight);
+        glViewport(0, 0, framebufferWidth, framebufferHeight);
+        glClearColor(colors_.background.x, colors_.background.y, colors_.background.z, colors_.background.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            TraceSpan span("present");
+            glfwSwapBuffers(window_);
+        }
+#endif
+        renderedFrames_++;
         
-        // Update performance history
-        updatePerformanceHistory();
-        
-        // Small delay to prevent excessive CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+        // Capture to present, measured once per new result after the swap
+        if (newResult && frameCaptureTime_.time_since_epoch().count() != 0) {
+            float latency = std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - frameCaptureTime_).count();
+            presentLatencyMs_ = presentLatencyMs_ == 0.0f ? latency : 0.9f * presentLatencyMs_ + 0.1f * latency;
+            presentLatency_.observe(latency);
+        }
     }
 }
 
@@ -192,8 +420,21 @@ void GUIModule::stop() {
     }
     
     // Cleanup
+#ifndef GUI_BACKEND_METAL
+    if (window_) {
+        glfwMakeContextCurrent(window_);
+        destroyOpenGL();
+        if (imguiContext_) {
+            ImGui_ImplOpenGL3_Shutdown();
+            ImGui_ImplGlfw_Shutdown();
+        }
+    }
+#endif
+    uploadedFrame_.reset();
+    frameResult_.reset();
     if (imguiContext_) {
         ImGui::DestroyContext(imguiContext_);
+        imguiContext_ = nullptr;
     }
     
     if (window_) {
@@ -205,6 +446,32 @@ void GUIModule::stop() {
     running_ = false;
 }
 
+void GUIModule::publishResult(std::shared_ptr<const ProcessedFrame> result,
+                              std::chrono::steady_clock::time_point captureTime) {
+    results_.publish({std::move(result), captureTime});
+    // Thread-safe; wakes glfwWaitEventsTimeout in run()
+    glfwPostEmptyEvent();
+}
+
+bool GUIModule::acquireLatestResult() {
+    // Video and overlays of one frame are drawn from this single snapshot
+    if (results_.update()) {
+        frameResult_ = results_.current().result;
+        frameCaptureTime_ = results_.current().captureTime;
+        return true;
+    }
+    if (results_.publishedCount() == 0) {
+        // Nothing is publishing to us: poll the pipeline, once per loop
+        auto latest = pipeline_->getLatestResult();
+        if (latest != frameResult_) {
+            frameResult_ = latest;
+            frameCaptureTime_ = std::chrono::steady_clock::time_point();
+            return true;
+        }
+    }
+    return false;
+}
+
 void GUIModule::renderFrame() {
     // Main window
     ImGui::SetNextWindowPos(ImVec2(0, 0));
@@ -236,15 +503,19 @@ void GUIModule::renderFrame() {
 }
 
 void GUIModule::renderVideoFrame() {
-    // Get latest frame from pipeline
-    auto latestResult = pipeline_->getLatestResult();
-    if (latestResult && !latestResult->detections.empty()) {
-        // Update texture with latest frame
-        // This is a simplified implementation
-        // In a full implementation, you would copy frame data to Metal texture
-        
-        // Display the texture
-        ImGui::Image((void*)videoTexture_, ImVec2(windowWidth_ * 0.8f, windowHeight_ * 0.8f));
+    if (frameResult_) {
+        updateTexture(frameResult_);
+    }
+    
+    if (textureWidth_ > 0 && textureHeight_ > 0) {
+        // Shown at source resolution times zoom so overlays can use frame coordinates
+        videoOrigin_ = ImGui::GetCursorScreenPos();
+        ImVec2 size(textureWidth_ * zoomLevel_, textureHeight_ * zoomLevel_);
+#ifdef GUI_BACKEND_METAL
+        ImGui::Image((void*)videoTexture_, size);
+#else
+        ImGui::Image(static_cast<ImTextureID>(static_cast<intptr_t>(videoTexture_)), size);
+#endif
     } else {
         // Show placeholder
         ImGui::TextColored(colors_.text, "No video frame available");
@@ -252,16 +523,17 @@ void GUIModule::renderVideoFrame() {
 }
 
 void GUIModule::renderDetections() {
-    auto latestResult = pipeline_->getLatestResult();
-    if (!latestResult) {
+    // Boxes of the snapshot whose pixels are in the texture, which lags
+    // frameResult_ while an upload is being retried
+    if (!uploadedFrame_) {
         return;
     }
     
     ImDrawList* drawList = ImGui::GetWindowDrawList();
     
-    for (const auto& detection : latestResult->detections) {
+    for (const auto& detection : uploadedFrame_->detections) {
         // Convert detection bbox to screen coordinates
-        ImVec2 screenPos = ImGui::GetCursorScreenPos();
+        ImVec2 screenPos = videoOrigin_;
         ImVec2 bboxMin(screenPos.x + detection.bbox.x * zoomLevel_ + panOffset_.x,
                       screenPos.y + detection.bbox.y * zoomLevel_ + panOffset_.y);
         ImVec2 bboxMax(screenPos.x + (detection.bbox.x + detection.bbox.width) * zoomLevel_ + panOffset_.x,
@@ -282,6 +554,105 @@ void GUIModule::renderDetections() {
     }
 }
 
+void GUIModule::updateTexture(const std::shared_ptr<const ProcessedFrame>& frame) {
+    // Same result as last render: the texture already holds it
+    if (!frame || frame == uploadedFrame_) {
+        return;
+    }
+    TraceSpan span("upload");
+    if (!uploadPixels(frame->frame)) {
+        // The texture still shows uploadedFrame_; try again next loop even if
+        // no new result arrives (paused or stopped source)
+        if (!frame->frame.empty()) {
+            pendingRedraws_ = std::max(pendingRedraws_, 1);
+        }
+        return;
+    }
+    uploadedFrame_ = frame;
+}
+
+#ifdef GUI_BACKEND_METAL
+bool GUIModule::uploadPixels(const cv::Mat& bgr) {
+    if (bgr.empty() || bgr.type() != CV_8UC3) {
+        return false;
+    }
+    cv::Mat rgba;
+    cv::cvtColor(bgr, rgba, cv::COLOR_BGR2RGBA);
+    
+    if (rgba.cols != textureWidth_ || rgba.rows != textureHeight_) {
+        MTLTextureDescriptor* textureDesc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA8Unorm
+                                                                                               width:rgba.cols
+                                                                                              height:rgba.rows
+                                                                                           mipmapped:NO];
+        videoTexture_ = [device_ newTextureWithDescriptor:textureDesc];
+        textureWidth_ = rgba.cols;
+        textureHeight_ = rgba.rows;
+    }
+    [videoTexture_ replaceRegion:MTLRegionMake2D(0, 0, rgba.cols, rgba.rows)
+                     mipmapLevel:0
+                       withBytes:rgba.data
+                     bytesPerRow:rgba.step];
+    return true;
+}
+#else
+bool GUIModule::uploadPixels(const cv::Mat& bgr) {
+    if (bgr.empty() || bgr.type() != CV_8UC3) {
+        return false;
+    }
+    if ((bgr.cols != textureWidth_ || bgr.rows != textureHeight_) &&
+        !resizeVideoTexture(bgr.cols, bgr.rows)) {
+        return false;
+    }
+    
+    // The buffer's previous copy (two frames ago) may still be running on the
+    // GPU; dropping this upload is better than stalling the render loop
+    const int index = uploadIndex_;
+    if (uploadFences_[index]) {
+        if (glClientWaitSync(uploadFences_[index], 0, 0) == GL_TIMEOUT_EXPIRED) {
+            skippedUploads_++;
+            return false;
+        }
+        glDeleteSync(uploadFences_[index]);
+        uploadFences_[index] = nullptr;
+    }
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers_[index]);
+    uint8_t* destination = nullptr;
+    if (persistentMapping_) {
+        destination = static_cast<uint8_t*>(uploadPointers_[index]);
+    } else {
+        // Orphan the old storage so the driver never waits on it
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBufferSize_, nullptr, GL_STREAM_DRAW);
+        destination = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, uploadBufferSize_,
+                                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    }
+    
+    if (destination) {
+        const size_t rowBytes = static_cast<size_t>(bgr.cols) * 3;
+        if (bgr.isContinuous()) {
+            std::memcpy(destination, bgr.data, rowBytes * bgr.rows);
+        } else {
+            for (int y = 0; y < bgr.rows; ++y) {
+                std::memcpy(destination + y * rowBytes, bgr.ptr(y), rowBytes);
+            }
+        }
+        if (!persistentMapping_) {
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        
+        // Copy from the buffer happens asynchronously on the GPU
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, videoTexture_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bgr.cols, bgr.rows, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        uploadFences_[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    uploadIndex_ = 1 - index;
+    return destination != nullptr;
+}
+#endif
+
 void GUIModule::renderPerformanceOverlay() {
     ImGui::SetNextWindowPos(ImVec2(10, 10));
     ImGui::SetNextWindowSize(ImVec2(300, 200));
@@ -297,20 +668,55 @@ void GUIModule::renderPerformanceOverlay() {
     // Display latency
     ImGui::TextColored(colors_.text, "Latency: %.2f ms", stats.averageLatency / 1000.0f);
     
-    // Display CPU/GPU usage
-    ImGui::TextColored(colors_.text, "CPU: %.1f%%", stats.performanceStats.cpuUsage);
+    // CPU and memory as measured from /proc where we can, else as the pipeline reports them
+    if (ResourceSampler::isSupported()) {
+        ResourceUsage usage = ResourceSampler::global().latest();
+        ImGui::TextColored(colors_.text, "CPU: %.1f%% (%d threads)", usage.cpuPercent, usage.threadCount);
+        ImGui::TextColored(colors_.text, "Memory: %.1f MB RSS, %.1f MB heap",
+                           usage.rssBytes / 1024.0 / 1024.0, usage.heapInUseBytes / 1024.0 / 1024.0);
+        for (size_t i = 0; i < usage.threads.size() && i < 3; ++i) {
+            ImGui::TextColored(usage.threads[i].cpuPercent > 90.0 ? colors_.warning : colors_.text,
+                               "  %s: %.0f%%", usage.threads[i].name.c_str(), usage.threads[i].cpuPercent);
+        }
+    } else {
+        ImGui::TextColored(colors_.text, "CPU: %.1f%%", stats.performanceStats.cpuUsage);
+        ImGui::TextColored(colors_.text, "Memory: %.1f MB", stats.performanceStats.memoryUsage / 1024.0f / 1024.0f);
+    }
     ImGui::TextColored(colors_.text, "GPU: %.1f%%", stats.performanceStats.gpuUsage);
     
-    // Display memory usage
-    ImGui::TextColored(colors_.text, "Memory: %.1f MB", stats.performanceStats.memoryUsage / 1024.0f / 1024.0f);
+    // Capture-to-present latency of published results
+    if (presentLatencyMs_ > 0.0f) {
+        ImGui::TextColored(colors_.text, "Present latency: %.1f ms", presentLatencyMs_);
+    }
+    ImGui::TextColored(colors_.text, "Redraws: %llu drawn, %llu skipped",
+                       static_cast<unsigned long long>(renderedFrames_),
+                       static_cast<unsigned long long>(skippedRedraws_));
+    
+    // Uploads dropped because the GPU was still busy with the buffer
+    if (skippedUploads_ > 0) {
+        ImGui::TextColored(colors_.warning, "Skipped uploads: %llu", static_cast<unsigned long long>(skippedUploads_));
+    }
+    
+    // Performance graphs, at the chosen history resolution
+    int resolution = static_cast<int>(historyResolution_);
+    if (ImGui::Combo("History", &resolution, "Seconds\0Minutes\0Hours\0")) {
+        historyResolution_ = static_cast<Resolution>(resolution);
+    }
     
-    // Performance graphs
-    if (!fpsHistory_.empty()) {
-        ImGui::PlotLines("FPS History", fpsHistory_.data(), fpsHistory_.size(), 0, nullptr, 0.0f, 100.0f, ImVec2(280, 60));
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    std::vector<float> fpsHistory = metrics.history("pipeline_fps", historyResolution_);
+    if (!fpsHistory.empty()) {
+        ImGui::PlotLines("FPS History", fpsHistory.data(), fpsHistory.size(), 0, nullptr, 0.0f, 100.0f, ImVec2(280, 60));
     }
     
-    if (!latencyHistory_.empty()) {
-        ImGui::PlotLines("Latency History", latencyHistory_.data(), latencyHistory_.size(), 0, nullptr, 0.0f, 50.0f, ImVec2(280, 60));
+    std::vector<float> latencyHistory = metrics.history("pipeline_latency_ms", historyResolution_);
+    if (!latencyHistory.empty()) {
+        ImGui::PlotLines("Latency History", latencyHistory.data(), latencyHistory.size(), 0, nullptr, 0.0f, 50.0f, ImVec2(280, 60));
+    }
+    
+    std::vector<float> presentHistory = metrics.history("gui_present_latency_ms", historyResolution_);
+    if (!presentHistory.empty()) {
+        ImGui::PlotLines("Present Latency", presentHistory.data(), presentHistory.size(), 0, nullptr, 0.0f, 100.0f, ImVec2(280, 60));
     }
     
     ImGui::End();
@@ -391,6 +797,7 @@ void GUIModule::renderControls() {
 }
 
 void GUIModule::handleKeyPress(int key, int action) {
+    requestRedraw();
     if (action == GLFW_PRESS) {
         switch (key) {
             case GLFW_KEY_ESCAPE:
@@ -420,11 +827,13 @@ void GUIModule::handleKeyPress(int key, int action) {
 }
 
 void GUIModule::handleMouseMove(double x, double y) {
+    requestRedraw();
     // Handle mouse movement for panning
     // Implementation depends on specific requirements
 }
 
 void GUIModule::handleMouseButton(int button, int action) {
+    requestRedraw();
     // Handle mouse button events
     // Implementation depends on specific requirements
 }
@@ -432,28 +841,11 @@ void GUIModule::handleMouseButton(int button, int action) {
 void GUIModule::updatePerformanceHistory() {
     auto stats = pipeline_->getStats();
     
-    // Update FPS history
-    fpsHistory_.push_back(stats.currentFPS);
-    if (fpsHistory_.size() > 100) {
-        fpsHistory_.erase(fpsHistory_.begin());
-    }
-    
-    // Update latency history
-    latencyHistory_.push_back(stats.averageLatency / 1000.0f);
-    if (latencyHistory_.size() > 100) {
-        latencyHistory_.erase(latencyHistory_.begin());
-    }
-    
-    // Update CPU/GPU history
-    cpuHistory_.push_back(stats.performanceStats.cpuUsage);
-    if (cpuHistory_.size() > 100) {
-        cpuHistory_.erase(cpuHistory_.begin());
-    }
-    
-    gpuHistory_.push_back(stats.performanceStats.gpuUsage);
-    if (gpuHistory_.size() > 100) {
-        gpuHistory_.erase(gpuHistory_.begin());
-    }
+    // The registry sampler turns these into bounded histories
+    fpsGauge_.set(stats.currentFPS);
+    latencyGauge_.set(stats.averageLatency / 1000.0f);
+    cpuGauge_.set(stats.performanceStats.cpuUsage);
+    gpuGauge_.set(stats.performanceStats.gpuUsage);
 }
 
 void GUIModule::setWindowSize(int width, int height) {
@@ -2,10 +2,24 @@
 
 #include "../core/Types.hpp"
 #include "../core/Pipeline.hpp"
+#include "../core/LatestValue.hpp"
+#include "../core/MetricsRegistry.hpp"
+#include "../core/ResourceSampler.hpp"
+#include "../core/TraceRecorder.hpp"
+
+// Rendering backend: OpenGL 3.3 by default (Linux, including Mesa software
+// rendering); define GUI_BACKEND_METAL on macOS for the Metal path
+#ifdef GUI_BACKEND_METAL
 #include <GLFW/glfw3.h>
-#include <imgui.h>
 #include <Metal/Metal.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#define GLFW_INCLUDE_GLEXT
+#include <GLFW/glfw3.h>
+#endif
+#include <imgui.h>
 #include <memory>
+#include <chrono>
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -15,7 +29,7 @@ public:
     explicit GUIModule(std::shared_ptr<Pipeline> pipeline);
     ~GUIModule();
 
-    // Initialize GUI with Metal rendering
+    // Initialize GUI with the compiled-in rendering backend
     bool initialize(int width, int height, const std::string& title);
     
     // Main GUI loop
@@ -30,6 +44,12 @@ public:
     void setShowPerformanceOverlay(bool show);
     void setShowDetectionOverlay(bool show);
     
+    // Producer side (pipeline result callback / inference thread): hand over an
+    // immutable frame+detections snapshot. Never blocks on the render loop;
+    // wakes it if it is waiting. captureTime is used for present latency.
+    void publishResult(std::shared_ptr<const ProcessedFrame> result,
+                       std::chrono::steady_clock::time_point captureTime = std::chrono::steady_clock::now());
+    
     // Status
     bool isRunning() const { return running_.load(); }
     
@@ -40,10 +60,18 @@ private:
     // GUI setup
     bool setupGLFW();
     bool setupImGui();
+#ifdef GUI_BACKEND_METAL
     bool setupMetal();
+#else
+    bool setupOpenGL();
+    void destroyOpenGL();
+    bool resizeVideoTexture(int width, int height);
+#endif
     bool createRenderTargets();
     
     // Rendering
+    bool acquireLatestResult();
+    void requestRedraw() { redrawRequested_ = true; }
     void renderFrame();
     void renderVideoFrame();
     void renderDetections();
@@ -57,19 +85,36 @@ private:
     void handleMouseButton(int button, int action);
     
     // Utility functions
-    void updateTexture(const std::shared_ptr<ProcessedFrame>& frame);
-    void drawBoundingBox(const Detection& detection);
-    void drawTrajectory(const Track& track);
+    void updateTexture(const std::shared_ptr<const ProcessedFrame>& frame);
+    bool uploadPixels(const cv::Mat& bgr);  // false if the texture was left unchanged
+    void updatePerformanceHistory();
     void drawPerformanceGraph(const std::vector<float>& data, const std::string& label);
     
     // GLFW objects
     GLFWwindow* window_;
     
+#ifdef GUI_BACKEND_METAL
     // Metal objects
     id<MTLDevice> device_;
     id<MTLCommandQueue> commandQueue_;
     id<MTLTexture> videoTexture_;
     id<MTLRenderPassDescriptor> renderPassDescriptor_;
+#else
+    // OpenGL objects. Frames are streamed through two pixel unpack buffers:
+    // the CPU fills one while the GPU copies the other into the texture.
+    GLuint videoTexture_;
+    GLuint uploadBuffers_[2];
+    void* uploadPointers_[2];      // persistent mappings (ARB_buffer_storage)
+    GLsync uploadFences_[2];
+    int uploadIndex_;
+    bool persistentMapping_;
+    size_t uploadBufferSize_;
+#endif
+    int textureWidth_;
+    int textureHeight_;
+    std::shared_ptr<const ProcessedFrame> uploadedFrame_;  // frame whose pixels are in the texture
+    uint64_t skippedUploads_;
+    ImVec2 videoOrigin_;  // screen position of the video image, for overlays
     
     // ImGui context
     ImGuiContext* imguiContext_;
@@ -77,6 +122,23 @@ private:
     // Pipeline reference
     std::shared_ptr<Pipeline> pipeline_;
     
+    // Results handed over by the producer, and the one snapshot every part
+    // of the current frame is drawn from
+    struct PublishedResult {
+        std::shared_ptr<const ProcessedFrame> result;
+        std::chrono::steady_clock::time_point captureTime;
+    };
+    LatestValue<PublishedResult> results_;
+    std::shared_ptr<const ProcessedFrame> frameResult_;
+    std::chrono::steady_clock::time_point frameCaptureTime_;
+    
+    // Event-driven redraw state
+    std::atomic<bool> redrawRequested_;
+    int pendingRedraws_;
+    uint64_t renderedFrames_;
+    uint64_t skippedRedraws_;
+    float presentLatencyMs_;
+    
     // Configuration
     int windowWidth_;
     int windowHeight_;
@@ -87,13 +149,15 @@ private:
     // State
     std::atomic<bool> running_;
     std::atomic<bool> shouldStop_;
-    std::mutex renderMutex_;
     
-    // Performance tracking
-    std::vector<float> fpsHistory_;
-    std::vector<float> latencyHistory_;
-    std::vector<float> cpuHistory_;
-    std::vector<float> gpuHistory_;
+    // Performance tracking: pipeline stats are mirrored into the shared
+    // registry, which keeps the bounded 1 s / 1 min / 1 h histories we plot
+    Gauge& fpsGauge_;
+    Gauge& latencyGauge_;
+    Gauge& cpuGauge_;
+    Gauge& gpuGauge_;
+    Histogram& presentLatency_;
+    Resolution historyResolution_;
     
     // Error handling
     mutable std::mutex errorMutex_;
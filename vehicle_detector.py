@@ -11,17 +11,52 @@ import argparse
 import sys
 from pathlib import Path
 from typing import List, Tuple, Optional
-import torch
 
-# Import YOLOv8 and Supervision
+# Import Supervision (both backends) and YOLOv8 (ultralytics backend only)
 try:
-    from ultralytics import YOLO
     import supervision as sv
 except ImportError as e:
     print(f"❌ Missing dependencies: {e}")
-    print("Please install: pip install ultralytics supervision")
+    print("Please install: pip install supervision")
     sys.exit(1)
 
+try:
+    from ultralytics import YOLO
+except ImportError:
+    YOLO = None
+
+# Native detector/tracker from qt_gui (cmake -DBUILD_PYTHON_MODULE=ON)
+try:
+    import fsd_core
+except ImportError:
+    sys.path.insert(0, str(Path(__file__).resolve().parent / "qt_gui" / "build"))
+    try:
+        import fsd_core
+    except ImportError:
+        fsd_core = None
+
+
+# Class IDs kept by both backends (COCO format) - expanded for better detection
+TRACKED_CLASSES = {
+    0: "person", 1: "bicycle", 2: "car", 3: "motorcycle", 
+    5: "bus", 7: "truck", 4: "airplane", 6: "train",
+    9: "traffic_light", 10: "fire_hydrant", 11: "stop_sign",
+    13: "bench", 14: "bird", 15: "cat", 16: "dog", 17: "horse",
+    18: "sheep", 19: "cow", 20: "elephant", 21: "bear", 22: "zebra",
+    23: "giraffe", 24: "backpack", 25: "umbrella", 27: "handbag",
+    28: "suitcase", 31: "sports_ball", 32: "kite", 33: "baseball_bat",
+    34: "baseball_glove", 35: "skateboard", 36: "surfboard",
+    37: "tennis_racket", 38: "bottle", 39: "wine_glass", 40: "cup",
+    41: "fork", 42: "knife", 43: "spoon", 44: "bowl", 46: "banana",
+    47: "apple", 48: "sandwich", 49: "orange", 50: "broccoli",
+    51: "carrot", 52: "hot_dog", 53: "pizza", 54: "donut", 55: "cake",
+    56: "chair", 57: "couch", 58: "potted_plant", 59: "bed",
+    60: "dining_table", 61: "toilet", 62: "tv", 63: "laptop",
+    64: "mouse", 65: "remote", 66: "keyboard", 67: "cell_phone",
+    68: "microwave", 69: "oven", 70: "toaster", 71: "sink",
+    72: "refrigerator", 73: "book", 74: "clock", 75: "vase",
+    76: "scissors", 77: "teddy_bear", 78: "hair_drier", 79: "toothbrush"
+}
 
 
 class VehicleDetector:
@@ -34,26 +69,7 @@ class VehicleDetector:
         self.model_version = "unknown"
         
         # Vehicle class IDs (COCO format) - expanded for better detection
-        self.vehicle_classes = {
-            0: "person", 1: "bicycle", 2: "car", 3: "motorcycle", 
-            5: "bus", 7: "truck", 4: "airplane", 6: "train",
-            9: "traffic_light", 10: "fire_hydrant", 11: "stop_sign",
-            13: "bench", 14: "bird", 15: "cat", 16: "dog", 17: "horse",
-            18: "sheep", 19: "cow", 20: "elephant", 21: "bear", 22: "zebra",
-            23: "giraffe", 24: "backpack", 25: "umbrella", 27: "handbag",
-            28: "suitcase", 31: "sports_ball", 32: "kite", 33: "baseball_bat",
-            34: "baseball_glove", 35: "skateboard", 36: "surfboard",
-            37: "tennis_racket", 38: "bottle", 39: "wine_glass", 40: "cup",
-            41: "fork", 42: "knife", 43: "spoon", 44: "bowl", 46: "banana",
-            47: "apple", 48: "sandwich", 49: "orange", 50: "broccoli",
-            51: "carrot", 52: "hot_dog", 53: "pizza", 54: "donut", 55: "cake",
-            56: "chair", 57: "couch", 58: "potted_plant", 59: "bed",
-            60: "dining_table", 61: "toilet", 62: "tv", 63: "laptop",
-            64: "mouse", 65: "remote", 66: "keyboard", 67: "cell_phone",
-            68: "microwave", 69: "oven", 70: "toaster", 71: "sink",
-            72: "refrigerator", 73: "book", 74: "clock", 75: "vase",
-            76: "scissors", 77: "teddy_bear", 78: "hair_drier", 79: "toothbrush"
-        }
+        self.vehicle_classes = dict(TRACKED_CLASSES)
         
         # Initialize YOLOv8 model
         self.model = None
@@ -71,6 +87,10 @@ class VehicleDetector:
         
     def load_model(self):
         """Load YOLOv8 model for optimal real-time performance"""
+        if YOLO is None:
+            print("❌ ultralytics is not installed")
+            print("Please install: pip install ultralytics, or use --backend cpp")
+            sys.exit(1)
         try:
             print(f"🚀 Loading YOLOv8{self.model_size}...")
             self.model = YOLO(f"yolov8{self.model_size}.pt")
@@ -103,22 +123,25 @@ class VehicleDetector:
         
         return filtered_detections
     
-    def process_frame(self, frame: np.ndarray) -> Tuple[np.ndarray, sv.Detections]:
-        """Process a single frame and return annotated frame with detections"""
-        self.frame_count += 1
-        
+    def detect(self, frame: np.ndarray, **predict_args) -> sv.Detections:
+        """Run the detector on one frame: downsample, infer, scale back, keep vehicle classes.
+
+        This is the reference the native backend is checked against (parity_check.py);
+        predict_args are passed on to the model call (e.g. conf, iou).
+        """
         # Downsample frame to 480p for maximum performance
         height, width = frame.shape[:2]
         target_height = 480
         target_width = int(width * target_height / height)
+        self.last_processed_size = (target_width, target_height)
         
         # Resize frame for processing
         processed_frame = cv2.resize(frame, (target_width, target_height))
         
         # Run YOLO inference on downsampled frame
         start_time = time.time()
-        results = self.model(processed_frame, verbose=False)[0]
-        inference_time = time.time() - start_time
+        results = self.model(processed_frame, verbose=False, **predict_args)[0]
+        self.last_inference_time = time.time() - start_time
         
         # Convert to supervision detections
         detections = sv.Detections.from_ultralytics(results)
@@ -142,7 +165,15 @@ class VehicleDetector:
             )
         
         # Filter for vehicles only
-        vehicle_detections = self.filter_vehicles(detections)
+        return self.filter_vehicles(detections)
+    
+    def process_frame(self, frame: np.ndarray) -> Tuple[np.ndarray, sv.Detections]:
+        """Process a single frame and return annotated frame with detections"""
+        self.frame_count += 1
+        
+        vehicle_detections = self.detect(frame)
+        inference_time = self.last_inference_time
+        target_width, target_height = self.last_processed_size
         
         # Track vehicles
         if len(vehicle_detections) > 0:
@@ -211,6 +242,108 @@ class VehicleDetector:
             "max_fps": max(self.fps_history)
         }
 
+class CppVehicleDetector:
+    """Same interface as VehicleDetector, backed by the native DetectionTracker.
+
+    Frames go to C++ without a copy and the GIL is released while the network
+    runs, so there is no need to pin OpenCV to one thread or downsample.
+    """
+
+    def __init__(self, model_size: str = "n", conf_threshold: float = 0.3,
+                 model_path: Optional[str] = None, classes_path: str = "models/coco.names",
+                 threads: int = 0):
+        if fsd_core is None:
+            raise ImportError("fsd_core is not built; configure qt_gui with -DBUILD_PYTHON_MODULE=ON")
+
+        self.model_size = model_size
+        self.conf_threshold = conf_threshold
+        self.frame_count = 0
+        self.model_version = "v8 (native)"
+        self.model_path = model_path or f"models/yolov8{model_size}.onnx"
+
+        print(f"🚀 Loading {self.model_path} into the native tracker...")
+        self.tracker = fsd_core.DetectionTracker(self.model_path, classes_path, conf_threshold)
+        if threads > 0:
+            self.tracker.set_thread_count(threads)
+        self.class_names = list(self.tracker.class_names)
+
+        # Same classes as the ultralytics path, filtered before tracking in C++
+        self.vehicle_classes = dict(TRACKED_CLASSES)
+        self.tracker.set_class_filter(list(self.vehicle_classes))
+
+        self.box_annotator = sv.BoxAnnotator()
+        self.fps_history = []
+
+    def set_conf_threshold(self, conf: float):
+        self.conf_threshold = conf
+        self.tracker.set_confidence_threshold(conf)
+
+    def to_detections(self, tracks: np.ndarray) -> sv.Detections:
+        """Convert a fsd_core.track_dtype array to supervision detections"""
+        if len(tracks) == 0:
+            return sv.Detections.empty()
+        xyxy = np.stack([tracks["x"], tracks["y"],
+                         tracks["x"] + tracks["w"], tracks["y"] + tracks["h"]], axis=1)
+        return sv.Detections(xyxy=xyxy.astype(np.float32),
+                             confidence=tracks["confidence"].astype(np.float32),
+                             class_id=tracks["class_id"].astype(int),
+                             tracker_id=tracks["track_id"].astype(int))
+
+    def class_name(self, class_id: int) -> str:
+        if 0 <= class_id < len(self.class_names):
+            return self.class_names[class_id]
+        return f"class_{class_id}"
+
+    def process_frame(self, frame: np.ndarray) -> Tuple[np.ndarray, sv.Detections]:
+        """Process a single frame and return annotated frame with detections"""
+        self.frame_count += 1
+
+        start_time = time.time()
+        tracks = self.tracker.process_frame(frame, self.frame_count)
+        inference_time = time.time() - start_time
+
+        vehicle_detections = self.to_detections(tracks)
+        annotated_frame = self.box_annotator.annotate(scene=frame.copy(), detections=vehicle_detections)
+        for record in tracks:
+            label = f"ID:{record['track_id']} {self.class_name(int(record['class_id']))} {record['confidence']:.2f}"
+            cv2.putText(annotated_frame, label, (int(record["x"]), int(record["y"]) - 10),
+                        cv2.FONT_HERSHEY_SIMPLEX, 0.6, (255, 255, 255), 2)
+
+        fps = 1.0 / inference_time if inference_time > 0 else 0
+        self.fps_history.append(fps)
+        if len(self.fps_history) > 30:
+            self.fps_history.pop(0)
+        avg_fps = sum(self.fps_history) / len(self.fps_history)
+
+        height, width = frame.shape[:2]
+        info_text = f"Vehicles: {len(vehicle_detections)} | FPS: {avg_fps:.1f} | Frame: {self.frame_count}"
+        cv2.putText(annotated_frame, info_text, (10, 30),
+                    cv2.FONT_HERSHEY_SIMPLEX, 1, (255, 255, 255), 2)
+        cv2.putText(annotated_frame, f"Inference: {inference_time*1000:.1f}ms | Processed: {width}x{height}", (10, 70),
+                    cv2.FONT_HERSHEY_SIMPLEX, 1, (255, 255, 255), 2)
+
+        return annotated_frame, vehicle_detections
+
+    def get_performance_stats(self) -> dict:
+        """Get performance statistics"""
+        if not self.fps_history:
+            return {"avg_fps": 0, "total_frames": self.frame_count, "min_fps": 0, "max_fps": 0}
+
+        return {
+            "avg_fps": sum(self.fps_history) / len(self.fps_history),
+            "total_frames": self.frame_count,
+            "min_fps": min(self.fps_history),
+            "max_fps": max(self.fps_history)
+        }
+
+def create_detector(backend: str = "ultralytics", **kwargs):
+    """Build a detector for the given backend ("ultralytics" or "cpp")"""
+    if backend == "cpp":
+        return CppVehicleDetector(**kwargs)
+    kwargs.pop("model_path", None)
+    kwargs.pop("threads", None)
+    return VehicleDetector(**kwargs)
+
 def main():
     parser = argparse.ArgumentParser(description="Real-time Vehicle Detection with YOLOv12")
     parser.add_argument("--source", type=str, default="0", 
@@ -222,11 +355,17 @@ def main():
                        help="Confidence threshold")
     parser.add_argument("--save", action="store_true",
                        help="Save output video")
+    parser.add_argument("--backend", type=str, default="ultralytics",
+                       choices=["ultralytics", "cpp"],
+                       help="Inference backend (cpp = native fsd_core module)")
+    parser.add_argument("--onnx", type=str, default=None,
+                       help="ONNX model for the cpp backend (default models/yolov8<size>.onnx)")
 
     args = parser.parse_args()
     
     # Initialize detector
-    detector = VehicleDetector(model_size=args.model, conf_threshold=args.conf)
+    detector = create_detector(args.backend, model_size=args.model, conf_threshold=args.conf,
+                               model_path=args.onnx)
     
     # Open video source
     if args.source.isdigit():